@@ -1,37 +1,98 @@
 // BattleshipGame.h
 #pragma once
 #include "Player.h"       
+#include "ComputerPlayer.h"
+#include "GameSnapshot.h"
 #include <string>
 #include <vector>
 #include <memory>
 
-enum class GameMode { PLAYER_VS_PLAYER };
+enum class GameMode { PLAYER_VS_PLAYER, PLAYER_VS_COMPUTER, COMPUTER_VS_COMPUTER };
 enum class GameTurn { PLAYER1, PLAYER2, GAME_OVER_P1_WINS, GAME_OVER_P2_WINS, SETUP };
 
-class BattleshipGameLogic {
+// The classic fleet, in ship-index order, as SHIP_TYPES ids. Both players get it, so a ship index
+// alone (as in AttackEvent or a GAME_DELTA) is enough for a peer to name the ship.
+const ShipTypeId DEFAULT_FLEET[] = { CARRIER, BATTLESHIP, CRUISER, SUBMARINE, DESTROYER };
+const int DEFAULT_FLEET_COUNT = sizeof(DEFAULT_FLEET) / sizeof(DEFAULT_FLEET[0]);
+
+// What one MakeAttack did, in a form that can be sent or stored without the message text.
+// Rejected moves carry outcome INVALID or ALREADY_TARGETED and leave the turn unchanged.
+struct AttackEvent {
+    int attackerId = 0; // 1 or 2; 0 if no attack has been made yet
+    int row = -1;
+    int col = -1;
+    AttackOutcome outcome = AttackOutcome::INVALID;
+    int sunkShipIndex = NO_SHIP_INDEX; // The defender's getShip() index when outcome is SUNK
+    GameTurn nextTurn = GameTurn::SETUP;
+    bool gameOver = false;
+
+    bool isAccepted() const { return outcome == AttackOutcome::MISS || outcome == AttackOutcome::HIT || outcome == AttackOutcome::SUNK; }
+};
+
+// Writes the status line for 'event' into 'out' (reusing its buffer), e.g.
+// "Alice attacked (3,4): SUNK! Sunk their Cruiser! Now Bob's turn.". Ships sunk on player 1's
+// side read "your", player 2's "their". An event with attackerId 0 announces the first turn.
+// 'sunkShipName' is only read when the outcome is SUNK.
+void FormatAttackEvent(const AttackEvent& event, const std::string& player1Name, const std::string& player2Name,
+    const char* sunkShipName, std::string& out);
+
+// Game rules for two players on an N x N board. Instantiated for the same sizes as
+// BasicPlayer (see BattleshipGame.cpp); 'BattleshipGameLogic' is the classic 10x10 game.
+template <int N>
+class BasicBattleshipGameLogic {
+public:
+    typedef BasicPlayer<N> PlayerType;
+    static constexpr int BOARD_SIZE = N;
+
 private:
-    std::unique_ptr<Player> player1;
-    std::unique_ptr<Player> player2;
+    std::unique_ptr<PlayerType> player1;
+    std::unique_ptr<PlayerType> player2;
     GameMode activeMode;
     GameTurn currentTurnState;
-    std::vector<std::pair<std::string, int>> defaultShipConfig = {
-        {"Carrier", 5}, {"Battleship", 4}, {"Cruiser", 3},
-        {"Submarine", 3}, {"Destroyer", 2}
-    };
-    std::string lastActionMessage;
+    AttackEvent lastAttack;      // Last accepted attack
+    AttackEvent lastActionEvent; // Last attack attempt, accepted or not, or the game-start event
+    mutable std::string lastActionMessage; // Formatted from lastActionEvent on demand
+    mutable bool lastActionMessageStale;
+    GameRandom random; // Ship placement and AI tie-breaks for the current game
+    uint64_t gameSeed;  // What 'random' was seeded with at StartNewGame
+    bool player1IsComputer; // Kind of the object in player1/player2, reused by the next StartNewGame when it fits
+    bool player2IsComputer;
+    ComputerStrategy computerStrategies[2]; // Given to the computer player 1 / 2 of each new game
+    void PreparePlayer(std::unique_ptr<PlayerType>& slot, bool& slotIsComputer, bool computer, ComputerStrategy strategy, const std::string& name);
 public:
-    BattleshipGameLogic();
+    BasicBattleshipGameLogic();
+    // Starts a game from a fresh seed (makeGameSeed); GetSeed() reports it for replaying the game.
     void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode = GameMode::PLAYER_VS_PLAYER);
-    bool MakeAttack(int r, int c);
+    // Same, with placement and AI choices drawn from 'seed' so the game can be reproduced.
+    void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed);
+    uint64_t GetSeed() const { return gameSeed; }
+    // How the computer in seat 'playerId' (1 or 2) picks its shots, from the next StartNewGame on.
+    // Both default to PROBABILITY_DENSITY; seats held by a human ignore it.
+    void SetComputerStrategy(int playerId, ComputerStrategy strategy);
+    ComputerStrategy GetComputerStrategy(int playerId) const { return computerStrategies[playerId == 2 ? 1 : 0]; }
+    // Writes the whole game (both fleets and boards, turn, random and AI state) into 'out'; see
+    // GameSnapshot.h. False if no game has been started.
+    bool SaveSnapshot(GameSnapshot& out) const;
+    // Replaces the current game with a saved one, under the given player names. False if the
+    // snapshot is malformed or from another board size, leaving the logic in SETUP.
+    bool RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name);
+    // Attacks (r, c) for the player to move. The result says whether the move was accepted; no
+    // message text is built until GetLastActionMessage() asks for it.
+    AttackEvent MakeAttack(int r, int c);
+    bool IsComputerTurn() const; // The player to move is computer-controlled (by GameMode)
+    AttackEvent MakeComputerMove(); // Lets the computer player to move pick a cell and attack it
     GameTurn GetCurrentTurnState() const { return currentTurnState; }
     GameMode GetActiveMode() const { return activeMode; }
-    const std::string& GetLastActionMessage() const { return lastActionMessage; }
-    const Player* GetPlayer1() const { return player1.get(); }
-    const Player* GetPlayer2() const { return player2.get(); }
-    Player* GetPlayer1ForUpdate() { return player1.get(); }
-    Player* GetPlayer2ForUpdate() { return player2.get(); }
-    const Player* GetPlayerById(int playerId) const;
-    Player* GetPlayerByIdForUpdate(int playerId);
+    const std::string& GetLastActionMessage() const;
+    const AttackEvent& GetLastAttack() const { return lastAttack; }
+    const PlayerType* GetPlayer1() const { return player1.get(); }
+    const PlayerType* GetPlayer2() const { return player2.get(); }
+    PlayerType* GetPlayer1ForUpdate() { return player1.get(); }
+    PlayerType* GetPlayer2ForUpdate() { return player2.get(); }
+    const PlayerType* GetPlayerById(int playerId) const;
+    PlayerType* GetPlayerByIdForUpdate(int playerId);
     bool IsGameOver() const;
     std::string GetWinnerString() const;
-};
\ No newline at end of file
+};
+
+typedef BasicBattleshipGameLogic<BOARD_SIZE_CONST> BattleshipGameLogic;
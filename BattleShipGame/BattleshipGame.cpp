@@ -1,71 +1,155 @@
 // BattleshipGame.cpp
-#include "BattleshipGame.h"
+#include "BattleShipGame.h"
 #include "Player.h" 
-#include <cstdlib>   
-#include <ctime>     
+#include "ComputerPlayer.h"
 #include <sstream>   
 #include <stdexcept> 
 
-BattleshipGameLogic::BattleshipGameLogic() {
-    currentTurnState = GameTurn::SETUP; activeMode = GameMode::PLAYER_VS_PLAYER;
-    lastActionMessage = "Game not started. Waiting for PvP setup.";
-}
-void BattleshipGameLogic::StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode) {
-    activeMode = GameMode::PLAYER_VS_PLAYER;
-    player1 = std::make_unique<Player>(p1Name.empty() ? "Player 1" : p1Name);
-    player2 = std::make_unique<Player>(p2Name.empty() ? "Player 2" : p2Name);
-    for (const auto& conf : defaultShipConfig) {
-        if (player1) player1->addShipDefinition(conf.first, conf.second);
-        if (player2) player2->addShipDefinition(conf.first, conf.second);
+void FormatAttackEvent(const AttackEvent& event, const std::string& player1Name, const std::string& player2Name,
+    const char* sunkShipName, std::string& out) {
+    if (event.attackerId == 0) { out.assign(player1Name).append("'s turn to attack."); return; }
+    out.assign(event.attackerId == 2 ? player2Name : player1Name);
+    out.append(event.isAccepted() ? " attacked (" : " made an invalid move at (");
+    out.append(std::to_string(event.row)).append(",").append(std::to_string(event.col)).append(")");
+    if (!event.isAccepted()) { out.append(". Cell already targeted or out of bounds. Try again."); return; }
+    if (event.outcome == AttackOutcome::SUNK) {
+        out.append(": SUNK!").append(event.attackerId == 2 ? " Sunk your " : " Sunk their ");
+        out.append(sunkShipName ? sunkShipName : "ship").append("!");
     }
-    if (player1) { player1->resetPlayer(); player1->placeShipsRandomly(); }
-    if (player2) { player2->resetPlayer(); player2->placeShipsRandomly(); }
+    else out.append(event.outcome == AttackOutcome::HIT ? ": HIT!" : ": MISS!");
+    bool player1Next = event.nextTurn == GameTurn::PLAYER1 || event.nextTurn == GameTurn::GAME_OVER_P1_WINS;
+    const std::string& next = player1Next ? player1Name : player2Name;
+    if (event.gameOver) out.append(" ").append(next).append(" wins!");
+    else out.append(" Now ").append(next).append("'s turn.");
+}
+
+template <int N>
+BasicBattleshipGameLogic<N>::BasicBattleshipGameLogic() {
+    currentTurnState = GameTurn::SETUP; activeMode = GameMode::PLAYER_VS_PLAYER; gameSeed = 0;
+    player1IsComputer = false; player2IsComputer = false;
+    computerStrategies[0] = computerStrategies[1] = ComputerStrategy::PROBABILITY_DENSITY;
+    lastActionMessage = "Game not started. Waiting for PvP setup."; lastActionMessageStale = false;
+}
+template <int N>
+void BasicBattleshipGameLogic<N>::StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode) {
+    StartNewGame(p1Name, p2Name, mode, makeGameSeed());
+}
+template <int N>
+void BasicBattleshipGameLogic<N>::StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed) {
+    activeMode = mode;
+    gameSeed = seed;
+    random.reseed(seed);
+    bool p1Computer = mode == GameMode::COMPUTER_VS_COMPUTER;
+    bool p2Computer = mode != GameMode::PLAYER_VS_PLAYER;
+    PreparePlayer(player1, player1IsComputer, p1Computer, computerStrategies[0], p1Name.empty() ? (p1Computer ? "Computer 1" : "Player 1") : p1Name);
+    player1->placeShipsRandomly(random);
+    PreparePlayer(player2, player2IsComputer, p2Computer, computerStrategies[1], p2Name.empty() ? (p2Computer ? "Computer" : "Player 2") : p2Name);
+    player2->placeShipsRandomly(random);
     currentTurnState = GameTurn::PLAYER1;
-    if (player1) lastActionMessage = player1->getName() + "'s turn to attack.";
-    else lastActionMessage = "Error: Player 1 not initialized.";
+    lastAttack = AttackEvent();
+    lastActionEvent = AttackEvent(); lastActionEvent.nextTurn = currentTurnState; // Formats as "<player 1>'s turn to attack."
+    lastActionMessageStale = true;
 }
-bool BattleshipGameLogic::MakeAttack(int r, int c) {
-    if (IsGameOver()) { lastActionMessage = "Game is over. " + GetWinnerString(); return false; }
-    Player* attacker = nullptr; Player* defender = nullptr; GameTurn nextTurnStateAfterAttack = GameTurn::SETUP;
-    if (currentTurnState == GameTurn::PLAYER1) {
-        attacker = player1.get(); defender = player2.get(); nextTurnStateAfterAttack = GameTurn::PLAYER2;
+template <int N>
+void BasicBattleshipGameLogic<N>::SetComputerStrategy(int playerId, ComputerStrategy strategy) {
+    if (playerId == 1 || playerId == 2) computerStrategies[playerId - 1] = strategy;
+}
+// Gives 'slot' a player of the right kind for the new game, with the classic fleet defined but not placed.
+// The previous game's player object is reused when its kind still fits, so restarting does not allocate.
+template <int N>
+void BasicBattleshipGameLogic<N>::PreparePlayer(std::unique_ptr<PlayerType>& slot, bool& slotIsComputer, bool computer, ComputerStrategy strategy, const std::string& name) {
+    if (!slot || slotIsComputer != computer) {
+        if (computer) slot = std::make_unique<BasicComputerPlayer<N>>(name);
+        else slot = std::make_unique<PlayerType>(name);
+        slotIsComputer = computer;
     }
-    else if (currentTurnState == GameTurn::PLAYER2) {
-        attacker = player2.get(); defender = player1.get(); nextTurnStateAfterAttack = GameTurn::PLAYER1;
+    else {
+        slot->setName(name);
+        if (computer) static_cast<BasicComputerPlayer<N>&>(*slot).resetComputerLogic();
     }
-    else { lastActionMessage = "Invalid game state or not a player's turn for attack."; return false; }
-    if (!attacker || !defender) { lastActionMessage = "Attacker or defender is missing."; return false; }
-    if (r < 0 || r >= BOARD_SIZE_CONST || c < 0 || c >= BOARD_SIZE_CONST || attacker->getTrackingBoardCell(r, c) != HIDDEN_CHAR) {
-        lastActionMessage = attacker->getName() + " made an invalid move at (" + std::to_string(r) + "," + std::to_string(c) + "). Cell already targeted or out of bounds. Try again."; return false;
+    if (computer) static_cast<BasicComputerPlayer<N>&>(*slot).setStrategy(strategy);
+    slot->clearShipDefinitions();
+    for (ShipTypeId type : DEFAULT_FLEET) slot->addShipDefinition(type);
+}
+template <int N>
+AttackEvent BasicBattleshipGameLogic<N>::MakeAttack(int r, int c) {
+    AttackEvent event; event.row = r; event.col = c; event.nextTurn = currentTurnState;
+    if (IsGameOver()) { event.gameOver = true; lastActionMessage = "Game is over. " + GetWinnerString(); lastActionMessageStale = false; return event; }
+    PlayerType* attacker = nullptr; PlayerType* defender = nullptr; GameTurn nextTurnStateAfterAttack = GameTurn::SETUP;
+    if (currentTurnState == GameTurn::PLAYER1) {
+        attacker = player1.get(); defender = player2.get(); nextTurnStateAfterAttack = GameTurn::PLAYER2; event.attackerId = 1;
     }
-    char resultChar = defender->receiveAttack(r, c); attacker->processAttackResult(r, c, resultChar, *defender);
-    std::string outcomeStr = ""; std::string sunkMsgDetail = "";
-    if (resultChar == HIT_CHAR) {
-        outcomeStr = "HIT";
-        for (const auto& ship : defender->getAllShips()) {
-            bool cellInThisShip = false;
-            for (const auto& cell : ship.getCells()) if (cell.row == r && cell.col == c) { cellInThisShip = true; break; }
-            if (cellInThisShip && ship.isSunk()) { outcomeStr = "SUNK"; sunkMsgDetail = (defender == player1.get()) ? " Sunk your " : " Sunk their "; sunkMsgDetail += ship.getName() + "!"; break; }
-        }
+    else if (currentTurnState == GameTurn::PLAYER2) {
+        attacker = player2.get(); defender = player1.get(); nextTurnStateAfterAttack = GameTurn::PLAYER1; event.attackerId = 2;
     }
-    else if (resultChar == MISS_CHAR) {
-        outcomeStr = "MISS";
+    else { lastActionMessage = "Invalid game state or not a player's turn for attack."; lastActionMessageStale = false; return event; }
+    if (!attacker || !defender) { lastActionMessage = "Attacker or defender is missing."; lastActionMessageStale = false; return event; }
+    // Rejected moves are reported through the event too, so the message reads "made an invalid move".
+    lastActionEvent = event; lastActionMessageStale = true;
+    if (r < 0 || r >= N || c < 0 || c >= N) return event;
+    if (attacker->getTrackingShotMask().test(PlayerType::Board::cellIndex(r, c))) {
+        event.outcome = AttackOutcome::ALREADY_TARGETED;
+        lastActionEvent = event;
+        return event;
     }
-    else { lastActionMessage = attacker->getName() + " made an invalid move at (" + std::to_string(r) + "," + std::to_string(c) + "). Cell already targeted or invalid state. Try again."; return false; }
-    lastActionMessage = attacker->getName() + " attacked (" + std::to_string(r) + "," + std::to_string(c) + "): " + outcomeStr + "!" + sunkMsgDetail;
-    if (player1->isDefeated()) {
-        currentTurnState = GameTurn::GAME_OVER_P2_WINS; lastActionMessage += " " + GetWinnerString();
+    AttackResult result = defender->receiveAttack(r, c);
+    event.outcome = result.outcome;
+    if (!event.isAccepted()) { lastActionEvent = event; return event; }
+    attacker->processAttackResult(r, c, result.isHit() ? HIT_CHAR : MISS_CHAR, *defender);
+    if (result.outcome == AttackOutcome::SUNK) { // The defender's cell index already names the sunk ship.
+        event.sunkShipIndex = result.shipIndex;
+        attacker->onOpponentShipSunk(r, c, result.shipIndex, defender->getShip(result.shipIndex).getSize());
     }
-    else if (player2->isDefeated()) {
-        currentTurnState = GameTurn::GAME_OVER_P1_WINS; lastActionMessage += " " + GetWinnerString();
+    if (player1->isDefeated()) currentTurnState = GameTurn::GAME_OVER_P2_WINS;
+    else if (player2->isDefeated()) currentTurnState = GameTurn::GAME_OVER_P1_WINS;
+    else currentTurnState = nextTurnStateAfterAttack;
+    event.nextTurn = currentTurnState; event.gameOver = IsGameOver();
+    lastAttack = event; lastActionEvent = event;
+    return event;
+}
+template <int N>
+const std::string& BasicBattleshipGameLogic<N>::GetLastActionMessage() const {
+    if (lastActionMessageStale) {
+        const char* sunkShipName = nullptr;
+        if (lastActionEvent.outcome == AttackOutcome::SUNK) {
+            const PlayerType* defender = GetPlayerById(lastActionEvent.attackerId == 1 ? 2 : 1);
+            if (defender) sunkShipName = defender->getShip(lastActionEvent.sunkShipIndex).getName();
+        }
+        FormatAttackEvent(lastActionEvent, player1 ? player1->getName() : std::string(), player2 ? player2->getName() : std::string(),
+            sunkShipName, lastActionMessage);
+        lastActionMessageStale = false;
     }
-    else { currentTurnState = nextTurnStateAfterAttack; Player* nextPlayer = (currentTurnState == GameTurn::PLAYER1) ? player1.get() : player2.get(); if (nextPlayer) lastActionMessage += " Now " + nextPlayer->getName() + "'s turn."; }
-    return true;
+    return lastActionMessage;
+}
+template <int N>
+bool BasicBattleshipGameLogic<N>::IsComputerTurn() const {
+    if (currentTurnState == GameTurn::PLAYER1) return activeMode == GameMode::COMPUTER_VS_COMPUTER;
+    if (currentTurnState == GameTurn::PLAYER2) return activeMode != GameMode::PLAYER_VS_PLAYER;
+    return false;
 }
-bool BattleshipGameLogic::IsGameOver() const { if (!player1 || !player2) return true; return currentTurnState == GameTurn::GAME_OVER_P1_WINS || currentTurnState == GameTurn::GAME_OVER_P2_WINS || player1->isDefeated() || player2->isDefeated(); }
-std::string BattleshipGameLogic::GetWinnerString() const {
+template <int N>
+AttackEvent BasicBattleshipGameLogic<N>::MakeComputerMove() {
+    if (!IsComputerTurn()) return AttackEvent();
+    PlayerType* attacker = (currentTurnState == GameTurn::PLAYER1) ? player1.get() : player2.get();
+    PlayerType* defender = (currentTurnState == GameTurn::PLAYER1) ? player2.get() : player1.get();
+    int r = 0, c = 0;
+    if (!attacker || !defender || !attacker->makeStrategicMove(*defender, random, r, c)) return AttackEvent();
+    return MakeAttack(r, c);
+}
+template <int N>
+bool BasicBattleshipGameLogic<N>::IsGameOver() const { if (!player1 || !player2) return true; return currentTurnState == GameTurn::GAME_OVER_P1_WINS || currentTurnState == GameTurn::GAME_OVER_P2_WINS || player1->isDefeated() || player2->isDefeated(); }
+template <int N>
+std::string BasicBattleshipGameLogic<N>::GetWinnerString() const {
     if (currentTurnState == GameTurn::GAME_OVER_P1_WINS && player1) return player1->getName() + " wins!"; if (currentTurnState == GameTurn::GAME_OVER_P2_WINS && player2) return player2->getName() + " wins!";
     if (player1 && player1->isDefeated() && player2) return player2->getName() + " wins!"; if (player2 && player2->isDefeated() && player1) return player1->getName() + " wins!"; return "Game Over!";
 }
-const Player* BattleshipGameLogic::GetPlayerById(int playerId) const { if (playerId == 1) return player1.get(); if (playerId == 2) return player2.get(); return nullptr; }
-Player* BattleshipGameLogic::GetPlayerByIdForUpdate(int playerId) { if (playerId == 1) return player1.get(); if (playerId == 2) return player2.get(); return nullptr; }
\ No newline at end of file
+template <int N>
+const typename BasicBattleshipGameLogic<N>::PlayerType* BasicBattleshipGameLogic<N>::GetPlayerById(int playerId) const { if (playerId == 1) return player1.get(); if (playerId == 2) return player2.get(); return nullptr; }
+template <int N>
+typename BasicBattleshipGameLogic<N>::PlayerType* BasicBattleshipGameLogic<N>::GetPlayerByIdForUpdate(int playerId) { if (playerId == 1) return player1.get(); if (playerId == 2) return player2.get(); return nullptr; }
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template class BasicBattleshipGameLogic<10>;
+template class BasicBattleshipGameLogic<15>;
+template class BasicBattleshipGameLogic<20>;
+template class BasicBattleshipGameLogic<32>;
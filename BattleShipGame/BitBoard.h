@@ -0,0 +1,132 @@
+// BitBoard.h
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int popCount64(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(v));
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// The lowest 'count' bits set; count <= 64.
+inline uint64_t lowBitMask64(int count) {
+    return count >= 64 ? ~0ULL : ((1ULL << count) - 1);
+}
+
+// Index of the lowest set bit; v must be non-zero.
+inline int countTrailingZeros64(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    while (!(v & 1ULL)) { v >>= 1; ++n; }
+    return n;
+#endif
+}
+
+// Width of the mask for an N x N board, in 64-bit words. Up to 128 cells (10x10) this is a
+// single 128-bit lane; larger boards are rounded up to whole 256-bit lanes so the word loops
+// below vectorize without a scalar tail (15x15 -> 4 words, 20x20 -> 8, 32x32 -> 16).
+constexpr int bitBoardWords(int boardSize) {
+    return boardSize * boardSize <= 128 ? 2 : ((boardSize * boardSize + 255) / 256) * 4;
+}
+
+// Cell mask for an N x N board. Cell (r, c) maps to bit r * N + c; padding bits stay zero.
+template <int N>
+struct alignas(bitBoardWords(N) > 2 ? 32 : 16) BitBoard {
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N;
+    static constexpr int WORDS = bitBoardWords(N);
+
+    uint64_t words[WORDS];
+
+    BitBoard() { clear(); }
+
+    void clear() {
+        for (int i = 0; i < WORDS; ++i) words[i] = 0;
+    }
+
+    static int cellIndex(int r, int c) { return r * N + c; }
+
+    bool test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1ULL; }
+    void set(int bit) { words[bit >> 6] |= (1ULL << (bit & 63)); }
+    void reset(int bit) { words[bit >> 6] &= ~(1ULL << (bit & 63)); }
+
+    // Bits [bit, bit + width) as an integer, lowest cell first; width <= 64. With bit = r * N and
+    // width = N this is row r.
+    uint64_t extract(int bit, int width) const {
+        int word = bit >> 6, offset = bit & 63;
+        uint64_t v = words[word] >> offset;
+        if (offset != 0 && offset + width > 64 && word + 1 < WORDS) v |= words[word + 1] << (64 - offset);
+        return width >= 64 ? v : (v & ((1ULL << width) - 1));
+    }
+
+    // Sets the bits of 'value' in [bit, bit + width); the inverse of extract for a cleared range.
+    void deposit(int bit, int width, uint64_t value) {
+        if (width < 64) value &= (1ULL << width) - 1;
+        int word = bit >> 6, offset = bit & 63;
+        words[word] |= value << offset;
+        if (offset != 0 && offset + width > 64 && word + 1 < WORDS) words[word + 1] |= value >> (64 - offset);
+    }
+
+    bool any() const {
+        uint64_t acc = 0;
+        for (int i = 0; i < WORDS; ++i) acc |= words[i];
+        return acc != 0;
+    }
+    bool none() const { return !any(); }
+
+    int count() const {
+        int total = 0;
+        for (int i = 0; i < WORDS; ++i) total += popCount64(words[i]);
+        return total;
+    }
+
+    bool intersects(const BitBoard& other) const {
+        uint64_t acc = 0;
+        for (int i = 0; i < WORDS; ++i) acc |= words[i] & other.words[i];
+        return acc != 0;
+    }
+
+    // True when every bit set here is also set in 'other'.
+    bool isSubsetOf(const BitBoard& other) const {
+        uint64_t acc = 0;
+        for (int i = 0; i < WORDS; ++i) acc |= words[i] & ~other.words[i];
+        return acc == 0;
+    }
+
+    BitBoard& operator|=(const BitBoard& other) {
+        for (int i = 0; i < WORDS; ++i) words[i] |= other.words[i];
+        return *this;
+    }
+    BitBoard& operator&=(const BitBoard& other) {
+        for (int i = 0; i < WORDS; ++i) words[i] &= other.words[i];
+        return *this;
+    }
+    BitBoard& andNot(const BitBoard& other) {
+        for (int i = 0; i < WORDS; ++i) words[i] &= ~other.words[i];
+        return *this;
+    }
+
+    friend BitBoard operator|(BitBoard a, const BitBoard& b) { return a |= b; }
+    friend BitBoard operator&(BitBoard a, const BitBoard& b) { return a &= b; }
+    friend bool operator==(const BitBoard& a, const BitBoard& b) {
+        for (int i = 0; i < WORDS; ++i) if (a.words[i] != b.words[i]) return false;
+        return true;
+    }
+    friend bool operator!=(const BitBoard& a, const BitBoard& b) { return !(a == b); }
+};
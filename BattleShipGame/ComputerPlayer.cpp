@@ -1,63 +1,118 @@
 #include "ComputerPlayer.h"
-#include <cstdlib> // For rand
 
-ComputerPlayer::ComputerPlayer(const std::string& name) : Player(name) {}
+template <int N>
+BasicComputerPlayer<N>::BasicComputerPlayer(const std::string& name) : BasicPlayer<N>(name) {}
 
-void ComputerPlayer::strategizeAfterHit(int r, int c, const Player& opponent) {
-    (void)opponent;
-    BoardPos hitPos = { r, c };
-    int dr[] = { -1, 1, 0, 0 };
-    int dc[] = { 0, 0, -1, 1 };
+template <int N>
+bool BasicComputerPlayer<N>::makeStrategicMove(BasicPlayer<N>& opponent, GameRandom& rng, int& outRow, int& outCol) {
+    // Shot results are public: combine what this player tracked with the marks on the opponent's board.
+    typename BasicPlayer<N>::Board hits = this->getTrackingHitMask() | opponent.getOwnHitMask();
+    typename BasicPlayer<N>::Board misses = this->getTrackingMissMask() | opponent.getOwnMissMask();
+    if (hits.none() && misses.none()) { // New game
+        targetingReady = false;
+        untried.reset();
+        if (endgame) endgame->clearTable();
+        endgameGaveUpAt = -1;
+    }
+    if (strategy == ComputerStrategy::RANDOM) {
+        untried.markTried(hits | misses);
+        int cell = untried.sample(rng);
+        if (cell < 0) return false;
+        outRow = cell / N;
+        outCol = cell % N;
+        return true;
+    }
+    if (!targetingReady) {
+        targeting.reset();
+        for (int i = 0; i < opponent.getShipCount(); ++i) targeting.addShip(opponent.getShip(i).getSize()); // Fleet sizes are part of the rules
+        targetingReady = true;
+    }
+    if (strategy == ComputerStrategy::ENDGAME_SOLVER && chooseEndgameTarget(opponent, hits, misses, outRow, outCol)) return true;
+    return targeting.chooseTarget(hits, misses, rng, outRow, outCol);
+}
 
-    for (int i = 0; i < 4; ++i) {
-        BoardPos nextPos = { hitPos.r + dr[i], hitPos.c + dc[i] };
-        if (nextPos.r >= 0 && nextPos.r < BOARD_SIZE_CONST &&
-            nextPos.c >= 0 && nextPos.c < BOARD_SIZE_CONST &&
-            this->getTrackingBoardCell(nextPos.r, nextPos.c) == HIDDEN_CHAR &&
-            attemptedMoves.find(nextPos) == attemptedMoves.end()) {
-            smartTargetQueue.push(nextPos);
-        }
+// False, leaving the move to the density targeting, while too many ships or layouts remain, while
+// a sunk ship's cells are not known exactly, or when the search runs out of budget (and from then
+// on until another ship sinks).
+template <int N>
+bool BasicComputerPlayer<N>::chooseEndgameTarget(const BasicPlayer<N>& opponent, const typename BasicPlayer<N>::Board& hits,
+    const typename BasicPlayer<N>::Board& misses, int& outRow, int& outCol) {
+    int sizes[MAX_ENDGAME_SHIPS];
+    int afloat = 0, sunkShips = 0, sunkCells = 0;
+    for (int i = 0; i < opponent.getShipCount(); ++i) {
+        const Ship& ship = opponent.getShip(i);
+        if (ship.isSunk()) { sunkShips++; sunkCells += ship.getSize(); continue; } // Announced, so public
+        if (afloat == ENDGAME_MAX_SHIPS) return false;
+        sizes[afloat++] = ship.getSize();
     }
+    const typename BasicPlayer<N>::Board& sunk = targeting.getSunkMask();
+    if (afloat == 0 || sunk.count() != sunkCells || sunkShips == endgameGaveUpAt) return false;
+    if (!endgame) {
+        EndgameLimits limits;
+        limits.maxLayouts = ENDGAME_MAX_LAYOUTS;
+        limits.maxNodes = ENDGAME_MAX_NODES;
+        limits.maxWork = ENDGAME_MAX_WORK;
+        endgame = std::make_unique<BasicEndgameSolver<N>>(limits);
+    }
+    typename BasicPlayer<N>::Board afloatHits = hits;
+    afloatHits.andNot(sunk);
+    EndgameResult result;
+    if (!endgame->solve(afloatHits, misses | sunk, sizes, afloat, result)) {
+        if (result.layouts > 0 && result.layouts <= ENDGAME_MAX_LAYOUTS) endgameGaveUpAt = sunkShips; // Out of budget, not of layouts
+        return false;
+    }
+    outRow = result.row;
+    outCol = result.col;
+    return true;
 }
 
-bool ComputerPlayer::makeStrategicMove(Player& opponent, int& outRow, int& outCol) {
-    BoardPos target;
-    while (!smartTargetQueue.empty()) {
-        target = smartTargetQueue.front();
-        smartTargetQueue.pop();
-        if (opponent.getOwnBoardCell(target.r, target.c) != HIT_CHAR &&
-            opponent.getOwnBoardCell(target.r, target.c) != MISS_CHAR &&
-            attemptedMoves.find(target) == attemptedMoves.end()) {
-
-            outRow = target.r;
-            outCol = target.c;
-            attemptedMoves.insert(target);
-            return true;
-        }
-    }
-
-    int current_attempts = 0; // Renamed from 'attempts' to avoid conflict if there's a member var
-    const int maxAttempts = BOARD_SIZE_CONST * BOARD_SIZE_CONST * 2;
-    while (current_attempts < maxAttempts) {
-        target.r = rand() % BOARD_SIZE_CONST;
-        target.c = rand() % BOARD_SIZE_CONST;
-        if (attemptedMoves.find(target) == attemptedMoves.end() &&
-            opponent.getOwnBoardCell(target.r, target.c) != HIT_CHAR &&
-            opponent.getOwnBoardCell(target.r, target.c) != MISS_CHAR) {
-            outRow = target.r;
-            outCol = target.c;
-            attemptedMoves.insert(target);
-            return true;
-        }
-        current_attempts++;
-    }
-    return false;
+template <int N>
+void BasicComputerPlayer<N>::onOpponentShipSunk(int r, int c, int shipIndex, int shipSize) {
+    (void)shipIndex;
+    if (targetingReady) targeting.onShipSunk(r, c, shipSize, this->getTrackingHitMask());
 }
 
-void ComputerPlayer::resetComputerLogic() {
+template <int N>
+void BasicComputerPlayer<N>::resetComputerLogic() {
     // Player::resetPlayer(); // Base class resetPlayer should be called by its own logic if needed
                            // Or if ComputerPlayer has specific needs beyond Player's reset.
                            // For now, just reset ComputerPlayer specific state.
-    while (!smartTargetQueue.empty()) smartTargetQueue.pop();
-    attemptedMoves.clear();
-}
\ No newline at end of file
+    targeting.reset();
+    targetingReady = false;
+    untried.reset();
+    endgameGaveUpAt = -1;
+}
+
+template <int N>
+uint32_t BasicComputerPlayer<N>::getPlacedSunkShips(const BasicPlayer<N>& opponent) const {
+    uint32_t placed = 0;
+    if (!targetingReady) return placed;
+    for (int i = 0; i < opponent.getShipCount(); ++i) {
+        const Ship& ship = opponent.getShip(i);
+        if (!ship.isPlaced() || !ship.isSunk()) continue;
+        CellCoordinate first = ship.getCell(0);
+        if (targeting.getSunkMask().test(BasicPlayer<N>::Board::cellIndex(first.row, first.col))) placed |= 1u << i;
+    }
+    return placed;
+}
+
+template <int N>
+void BasicComputerPlayer<N>::restoreComputerLogic(const BasicPlayer<N>& opponent, uint32_t placedSunkShips) {
+    resetComputerLogic();
+    if (strategy == ComputerStrategy::RANDOM) return; // 'untried' is rebuilt from the shot marks on the next move
+    for (int i = 0; i < opponent.getShipCount(); ++i) {
+        const Ship& ship = opponent.getShip(i);
+        if (!ship.isSunk()) { targeting.addShip(ship.getSize()); continue; }
+        if (!(placedSunkShips & (1u << i)) || !ship.isPlaced()) continue;
+        typename BasicPlayer<N>::Board cells;
+        for (int k = 0; k < ship.getCellCount(); ++k) cells.set(BasicPlayer<N>::Board::cellIndex(ship.getCell(k).row, ship.getCell(k).col));
+        targeting.markSunkCells(cells);
+    }
+    targetingReady = true;
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template class BasicComputerPlayer<10>;
+template class BasicComputerPlayer<15>;
+template class BasicComputerPlayer<20>;
+template class BasicComputerPlayer<32>;
@@ -1,26 +1,53 @@
 #pragma once
 #include "Player.h" // Player must be fully defined first
-#include <queue>
-#include <set>
-#include "Constants.h" // For BOARD_SIZE_CONST
+#include "TargetingEngine.h"
+#include "UntriedCells.h"
+#include "EndgameSolver.h"
+#include <memory>
 
-// BoardPos struct should be fine here or in NetworkCommon.h if used by client too
-struct BoardPos {
-    int r, c;
-    bool operator<(const BoardPos& other) const {
-        if (r != other.r) return r < other.r;
-        return c < other.c;
-    }
+enum class ComputerStrategy {
+    PROBABILITY_DENSITY, // Fires where the most remaining ship placements overlap (TargetingEngine)
+    RANDOM,              // Fires at a uniformly chosen untried cell
+    ENDGAME_SOLVER       // PROBABILITY_DENSITY, but solved exactly once few ships and layouts remain (EndgameSolver)
 };
 
-class ComputerPlayer : public Player {
+// When ENDGAME_SOLVER hands a move to the solver. Node and work budgets only, no clock, so
+// computer games stay reproducible from their seed. Nearly every search that finishes visits a few
+// dozen layouts; one that runs out of budget is thrown away, so the work cap (about 0.7 ms on a
+// 10x10 board) bounds what a move costs, and after one the player waits for the next ship to sink
+// before trying again.
+const int ENDGAME_MAX_SHIPS = 2;         // Ships afloat
+const size_t ENDGAME_MAX_LAYOUTS = 32;
+const uint64_t ENDGAME_MAX_NODES = 4000;
+const uint64_t ENDGAME_MAX_WORK = 20000;
+
+template <int N>
+class BasicComputerPlayer : public BasicPlayer<N> {
 private:
-    std::queue<BoardPos> smartTargetQueue;
-    std::set<BoardPos> attemptedMoves;
+    ComputerStrategy strategy = ComputerStrategy::PROBABILITY_DENSITY;
+    BasicTargetingEngine<N> targeting;
+    bool targetingReady = false; // Fleet loaded into 'targeting' for the current game
+    UntriedCells<N> untried;     // RANDOM: cells not yet fired at in the current game
+    std::unique_ptr<BasicEndgameSolver<N>> endgame; // ENDGAME_SOLVER: created on first use, table kept for the game
+    int endgameGaveUpAt = -1; // ENDGAME_SOLVER: ships sunk when the solver last ran out of budget; -1 if it has not
+
+    bool chooseEndgameTarget(const BasicPlayer<N>& opponent, const typename BasicPlayer<N>::Board& hits,
+        const typename BasicPlayer<N>::Board& misses, int& outRow, int& outCol);
 
 public:
-    ComputerPlayer(const std::string& name = "Computer");
-    void strategizeAfterHit(int r, int c, const Player& opponent);
-    bool makeStrategicMove(Player& opponent, int& outRow, int& outCol) override; // <<< Added override
+    BasicComputerPlayer(const std::string& name = "Computer");
+    bool makeStrategicMove(BasicPlayer<N>& opponent, GameRandom& rng, int& outRow, int& outCol) override;
+    void onOpponentShipSunk(int r, int c, int shipIndex, int shipSize) override;
     void resetComputerLogic();
-};
\ No newline at end of file
+    ComputerStrategy getStrategy() const { return strategy; }
+    void setStrategy(ComputerStrategy s) { strategy = s; }
+    const BasicTargetingEngine<N>& getTargetingEngine() const { return targeting; }
+
+    // What the targeting engine has worked out beyond the public shot marks: bit i is set when
+    // it has placed the opponent's sunk ship i exactly. Enough, with the shots, to rebuild it.
+    uint32_t getPlacedSunkShips(const BasicPlayer<N>& opponent) const;
+    // Rebuilds the AI state for a restored game from the opponent's board and getPlacedSunkShips().
+    void restoreComputerLogic(const BasicPlayer<N>& opponent, uint32_t placedSunkShips);
+};
+
+typedef BasicComputerPlayer<BOARD_SIZE_CONST> ComputerPlayer;
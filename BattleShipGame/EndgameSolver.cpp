@@ -0,0 +1,244 @@
+// EndgameSolver.cpp
+#include "EndgameSolver.h"
+#include "GameRandom.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    const uint64_t ZOBRIST_SEED = 0x5EA2B0A7D1CE5EEDULL;
+
+    int64_t NowTicks() {
+        return static_cast<int64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+}
+
+template <int N>
+BasicEndgameSolver<N>::BasicEndgameSolver(const EndgameLimits& initialLimits) {
+    // Fixed keys, so a position hashes the same in every solver and every run.
+    hitKeys.resize(CELL_COUNT);
+    for (int cell = 0; cell < CELL_COUNT; ++cell) hitKeys[cell] = mixSeed(ZOBRIST_SEED, static_cast<uint64_t>(cell));
+    setLimits(initialLimits);
+}
+
+template <int N>
+void BasicEndgameSolver<N>::setLimits(const EndgameLimits& newLimits) {
+    limits = newLimits;
+    size_t entries = 1;
+    while (entries * 2 * sizeof(TableEntry) <= limits.tableBytes) entries *= 2;
+    table.assign(entries, TableEntry{ 0, 0.0f, -1 });
+}
+
+template <int N>
+void BasicEndgameSolver<N>::clearTable() {
+    std::fill(table.begin(), table.end(), TableEntry{ 0, 0.0f, -1 });
+}
+
+template <int N>
+bool BasicEndgameSolver<N>::solve(const Board& hits, const Board& blocked, const int* shipSizes, int count, EndgameResult& result) {
+    result = EndgameResult();
+    if (count <= 0 || count > MAX_ENDGAME_SHIPS || hits.intersects(blocked)) return false;
+    shipCount = count;
+    layouts.clear();
+    fleets.clear();
+    layoutKeys.clear();
+    Board used;
+    bool complete = enumerateLayouts(hits, blocked, shipSizes, 0, used);
+    result.layouts = fleets.size();
+    if (!complete || fleets.empty()) return false;
+
+    uint64_t hitKey = 0;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) if (hits.test(cell)) hitKey ^= hitKeys[cell];
+    std::vector<uint32_t> all(fleets.size());
+    for (size_t k = 0; k < all.size(); ++k) all[k] = static_cast<uint32_t>(k);
+    cover.assign(CELL_COUNT, 0);
+    boundCover.assign(CELL_COUNT, 0);
+    if (depthLayouts.size() < static_cast<size_t>(CELL_COUNT) + 1) depthLayouts.resize(CELL_COUNT + 1); // One shot per depth
+    if (depthCells.size() < static_cast<size_t>(CELL_COUNT) + 1) depthCells.resize(CELL_COUNT + 1);
+    nodes = work = tableHits = 0;
+    aborted = false;
+    deadline = 0;
+    if (limits.timeBudgetMs > 0.0) {
+        auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(limits.timeBudgetMs));
+        deadline = NowTicks() + static_cast<int64_t>(budget.count());
+    }
+    int bestCell = -1;
+    double expected = search(all.data(), all.size(), hits, hitKey, 0, &bestCell);
+    result.nodes = nodes;
+    result.work = work;
+    result.tableHits = tableHits;
+    if (aborted || bestCell < 0) return false;
+    result.solved = true;
+    result.row = bestCell / N;
+    result.col = bestCell % N;
+    result.expectedShots = expected;
+    return true;
+}
+
+// Places ships[ship..] in every legal way; false once more than maxLayouts layouts turn up.
+template <int N>
+bool BasicEndgameSolver<N>::enumerateLayouts(const Board& hits, const Board& blocked, const int* shipSizes, int ship, const Board& used) {
+    if (ship == shipCount) {
+        if (!hits.isSubsetOf(used)) return true; // Every hit belongs to a ship afloat
+        if (fleets.size() >= limits.maxLayouts) { fleets.push_back(used); return false; }
+        layouts.insert(layouts.end(), placed, placed + shipCount);
+        fleets.push_back(used);
+        // Mixed once more: a plain XOR of ship keys would make sets like {a1 b1, a1 b2, a2 b1, a2 b2} hash to 0.
+        uint64_t key = 0;
+        for (int i = 0; i < shipCount; ++i) key ^= placedKeys[i];
+        layoutKeys.push_back(mixSeed(ZOBRIST_SEED ^ 2, key));
+        return true;
+    }
+    int size = shipSizes[ship];
+    if (size <= 0 || size > N) return true;
+    for (int horizontal = 1; horizontal >= 0; --horizontal) {
+        if (size == 1 && !horizontal) break; // A single cell has one placement
+        for (int r = 0; r + (horizontal ? 0 : size - 1) < N; ++r) {
+            for (int c = 0; c + (horizontal ? size - 1 : 0) < N; ++c) {
+                Board& cells = placed[ship];
+                cells.clear();
+                for (int k = 0; k < size; ++k) cells.set(Board::cellIndex(horizontal ? r : r + k, horizontal ? c + k : c));
+                // Clear of the other ships and of misses, and not fully hit already (it would have been announced sunk).
+                if (cells.intersects(used) || cells.intersects(blocked) || cells.isSubsetOf(hits)) continue;
+                // Ship i at a given place has the same key whatever the other ships do.
+                uint64_t placement = static_cast<uint64_t>(ship * (N + 1) + size) * CELL_COUNT + static_cast<uint64_t>(Board::cellIndex(r, c));
+                placedKeys[ship] = mixSeed(ZOBRIST_SEED ^ 1, placement * 2 + static_cast<uint64_t>(horizontal));
+                if (!enumerateLayouts(hits, blocked, shipSizes, ship + 1, used | cells)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Every layout covers the same hits, so all need the same number of hits to finish; on top of
+// that the next shot misses unless it lands on a cell covered in all of them.
+template <int N>
+double BasicEndgameSolver<N>::lowerBound(const uint32_t* set, size_t count, const Board& hitCells) {
+    Board left = fleets[set[0]];
+    double bound = static_cast<double>(left.andNot(hitCells).count());
+    if (count < 2 || bound == 0.0) return bound;
+    work += count;
+    uint32_t most = 0;
+    for (int pass = 0; pass < 2; ++pass) { // Count, then put the counters back to zero
+        for (size_t k = 0; k < count; ++k) {
+            Board open = fleets[set[k]];
+            open.andNot(hitCells);
+            for (int w = 0; w < Board::WORDS; ++w) {
+                for (uint64_t bits = open.words[w]; bits; bits &= bits - 1) {
+                    uint32_t& covered = boundCover[w * 64 + countTrailingZeros64(bits)];
+                    if (pass == 0) { if (++covered > most) most = covered; }
+                    else covered = 0;
+                }
+            }
+        }
+    }
+    return bound + 1.0 - static_cast<double>(most) / static_cast<double>(count);
+}
+
+template <int N>
+bool BasicEndgameSolver<N>::outOfBudget() {
+    if (limits.maxNodes && nodes >= limits.maxNodes) return true;
+    if (limits.maxWork && work >= limits.maxWork) return true;
+    return deadline != 0 && (nodes & 255) == 0 && NowTicks() > deadline;
+}
+
+// Expected shots to sink every ship in the layouts set[0..count), all equally likely, given the
+// hits so far. Misses need no tracking: no layout left has a ship on a missed cell. Fills
+// *bestCell with the shot that achieves it when asked.
+template <int N>
+double BasicEndgameSolver<N>::search(const uint32_t* set, size_t count, const Board& hitCells, uint64_t hitKey, int depth, int* bestCell) {
+    if (count == 1) { // Known layout: one shot per unhit cell
+        Board left = fleets[set[0]];
+        left.andNot(hitCells);
+        if (bestCell) {
+            *bestCell = -1;
+            for (int w = 0; w < Board::WORDS && *bestCell < 0; ++w) if (left.words[w]) *bestCell = w * 64 + countTrailingZeros64(left.words[w]);
+        }
+        return static_cast<double>(left.count());
+    }
+    uint64_t key = hitKey;
+    for (size_t k = 0; k < count; ++k) key ^= layoutKeys[set[k]];
+    TableEntry& entry = table[key & (table.size() - 1)];
+    if (entry.key == key && entry.bestCell >= 0) {
+        tableHits++;
+        if (bestCell) *bestCell = entry.bestCell;
+        return entry.expectedShots;
+    }
+    if (outOfBudget()) { aborted = true; return 0.0; }
+    nodes++;
+    work += count;
+
+    // Shots worth trying: unhit cells some layout has a ship on, most likely hits first.
+    std::fill(cover.begin(), cover.end(), 0u);
+    for (size_t k = 0; k < count; ++k) {
+        Board open = fleets[set[k]];
+        open.andNot(hitCells);
+        for (int w = 0; w < Board::WORDS; ++w) {
+            for (uint64_t bits = open.words[w]; bits; bits &= bits - 1) cover[w * 64 + countTrailingZeros64(bits)]++;
+        }
+    }
+    // Every ship cell has to be shot some time, so a cell that every layout has a ship on is
+    // never worse to shoot now: it costs no miss and can only tell more. Try it alone.
+    std::vector<int>& cells = depthCells[depth];
+    cells.clear();
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        if (cover[cell] == count) { cells.assign(1, cell); break; }
+        if (cover[cell]) cells.push_back(cell);
+    }
+    std::stable_sort(cells.begin(), cells.end(), [&](int a, int b) { return cover[a] > cover[b]; });
+
+    std::vector<uint32_t>& children = depthLayouts[depth];
+    children.resize(count);
+    double best = 1e300;
+    int bestShot = -1;
+    for (int shot : cells) {
+        // One position can try a hundred shots with bounds on each outcome: check between them too.
+        if (limits.maxWork && work >= limits.maxWork) { aborted = true; return 0.0; }
+        work += count;
+        // Split the layouts by what the shot would reveal: 0 miss, 1 hit, 2 + i ship i sunk.
+        size_t outcomeCount[2 + MAX_ENDGAME_SHIPS] = {};
+        size_t offset[2 + MAX_ENDGAME_SHIPS + 1];
+        Board hitAfter = hitCells;
+        hitAfter.set(shot);
+        auto outcomeOf = [&](uint32_t layout) {
+            if (!fleets[layout].test(shot)) return 0;
+            const Board* ships = &layouts[static_cast<size_t>(layout) * shipCount];
+            for (int i = 0; i < shipCount; ++i) {
+                if (ships[i].test(shot)) return ships[i].isSubsetOf(hitAfter) ? 2 + i : 1;
+            }
+            return 1;
+        };
+        for (size_t k = 0; k < count; ++k) outcomeCount[outcomeOf(set[k])]++;
+        offset[0] = 0;
+        for (int o = 0; o < 2 + shipCount; ++o) offset[o + 1] = offset[o] + outcomeCount[o];
+        size_t fill[2 + MAX_ENDGAME_SHIPS];
+        for (int o = 0; o < 2 + shipCount; ++o) fill[o] = offset[o];
+        for (size_t k = 0; k < count; ++k) children[fill[outcomeOf(set[k])]++] = set[k];
+
+        // Lower bounds first: skip the shot if even they cannot beat the best one.
+        double bounds[2 + MAX_ENDGAME_SHIPS];
+        double expected = 1.0;
+        for (int o = 0; o < 2 + shipCount; ++o) {
+            bounds[o] = outcomeCount[o] ? lowerBound(&children[offset[o]], outcomeCount[o], o == 0 ? hitCells : hitAfter) : 0.0;
+            expected += bounds[o] * static_cast<double>(outcomeCount[o]) / static_cast<double>(count);
+        }
+        for (int o = 0; o < 2 + shipCount && expected < best; ++o) {
+            if (!outcomeCount[o]) continue;
+            double value = search(&children[offset[o]], outcomeCount[o], o == 0 ? hitCells : hitAfter,
+                o == 0 ? hitKey : hitKey ^ hitKeys[shot], depth + 1, nullptr);
+            if (aborted) return 0.0;
+            expected += (value - bounds[o]) * static_cast<double>(outcomeCount[o]) / static_cast<double>(count);
+        }
+        if (expected < best - 1e-9) { best = expected; bestShot = shot; }
+    }
+    entry.key = key;
+    entry.expectedShots = static_cast<float>(best);
+    entry.bestCell = bestShot;
+    if (bestCell) *bestCell = bestShot;
+    return best;
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template class BasicEndgameSolver<10>;
+template class BasicEndgameSolver<15>;
+template class BasicEndgameSolver<20>;
+template class BasicEndgameSolver<32>;
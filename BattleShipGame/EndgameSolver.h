@@ -0,0 +1,89 @@
+// EndgameSolver.h
+#pragma once
+#include "BitBoard.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int MAX_ENDGAME_SHIPS = 8; // Ships still afloat that solve() accepts
+
+// Budgets for one BasicEndgameSolver::solve call; solve gives up (and says so) past any of them.
+struct EndgameLimits {
+    size_t maxLayouts = 512;     // Fleet layouts consistent with the board
+    uint64_t maxNodes = 50000;   // Positions searched, not counting transposition table hits; 0 for no limit
+    uint64_t maxWork = 0;        // Layouts visited, lower bounds included (most of the time goes there); 0 for no limit
+    double timeBudgetMs = 0.0;   // Wall-clock limit; 0 for none. A time limit makes the outcome depend on the machine
+    size_t tableBytes = 1 << 20; // Transposition table, rounded down to a power-of-two number of entries
+};
+
+struct EndgameResult {
+    bool solved = false;        // False when a budget ran out or no layout fits the board
+    int row = -1;               // Best shot, when solved
+    int col = -1;
+    double expectedShots = 0.0; // Shots from here until every ship afloat is sunk, playing best
+    size_t layouts = 0;         // Consistent layouts found (up to maxLayouts + 1)
+    uint64_t nodes = 0;
+    uint64_t work = 0;          // Layouts visited; see EndgameLimits::maxWork
+    uint64_t tableHits = 0;
+};
+
+// Exact endgame search for an N x N board. Enumerates every layout of the ships still afloat
+// that agrees with the shots so far and finds the shot that minimizes the expected number of
+// shots to sink them all, each layout being equally likely. A shot reveals a miss, a hit, or
+// "ship i sunk", as the game announces it, and splits the layouts accordingly. A position is the
+// set of layouts still possible plus the hits; its key XORs a Zobrist key per layout and per hit
+// cell, so the many shot orders (and miss patterns) that leave the same layouts share one entry
+// of the transposition table. Keys depend on the layouts' contents, not on their order, so the
+// table keeps paying off from one solve call to the next until clearTable(). Sibling shots are
+// cut off once a lower bound shows they cannot beat the best one found. Instantiated for the
+// supported board sizes in EndgameSolver.cpp.
+template <int N>
+class BasicEndgameSolver {
+public:
+    static constexpr int CELL_COUNT = N * N;
+    typedef BitBoard<N> Board;
+
+    explicit BasicEndgameSolver(const EndgameLimits& limits = EndgameLimits());
+    void setLimits(const EndgameLimits& limits);
+    const EndgameLimits& getLimits() const { return limits; }
+    void clearTable();
+
+    // 'hits': hit cells that belong to ships still afloat; 'blocked': misses and the cells of sunk
+    // ships; shipSizes[0..shipCount): the ships afloat, in the order "ship i sunk" refers to them.
+    bool solve(const Board& hits, const Board& blocked, const int* shipSizes, int shipCount, EndgameResult& result);
+
+private:
+    struct TableEntry {
+        uint64_t key;
+        float expectedShots;
+        int32_t bestCell;
+    };
+
+    EndgameLimits limits;
+    std::vector<TableEntry> table;
+    std::vector<uint64_t> hitKeys; // Per cell
+
+    // Per solve: layouts[k * shipCount + i] is ship i of layout k, fleets[k] their union.
+    int shipCount = 0;
+    std::vector<Board> layouts;
+    std::vector<Board> fleets;
+    std::vector<uint64_t> layoutKeys;
+    std::vector<std::vector<uint32_t>> depthLayouts; // Per search depth: the layouts of each outcome of the shot being tried
+    std::vector<std::vector<int>> depthCells;        // Per search depth: the shots to try, best first
+    std::vector<uint32_t> cover;                     // Per cell: layouts of the position being searched with a ship there
+    std::vector<uint32_t> boundCover;                // The same for lowerBound, left all zero between calls
+    Board placed[MAX_ENDGAME_SHIPS];                 // Ships of the layout being enumerated, and their keys
+    uint64_t placedKeys[MAX_ENDGAME_SHIPS];
+    uint64_t nodes = 0;
+    uint64_t work = 0;
+    uint64_t tableHits = 0;
+    bool aborted = false;
+    int64_t deadline = 0; // steady_clock ticks; 0 for none
+
+    bool enumerateLayouts(const Board& hits, const Board& blocked, const int* shipSizes, int ship, const Board& used);
+    double search(const uint32_t* set, size_t count, const Board& hitCells, uint64_t hitKey, int depth, int* bestCell);
+    double lowerBound(const uint32_t* set, size_t count, const Board& hitCells);
+    bool outOfBudget();
+};
+
+typedef BasicEndgameSolver<10> EndgameSolver;
@@ -0,0 +1,279 @@
+// GameJournal.cpp
+#include "GameJournal.h"
+#include "GameSession.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint8_t JOURNAL_MAGIC[3] = { 'B', 'S', 'J' };
+
+    bool IsRecordedOutcome(AttackOutcome outcome) {
+        return outcome == AttackOutcome::MISS || outcome == AttackOutcome::HIT || outcome == AttackOutcome::SUNK;
+    }
+
+    bool SyncFile(std::FILE* file) {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+    // Bounds-checked little-endian decoding; every Read* fails once the data runs out.
+    struct ByteCursor {
+        const uint8_t* data;
+        size_t size;
+        size_t pos;
+
+        bool ReadByte(uint8_t& out) {
+            if (pos >= size) return false;
+            out = data[pos++];
+            return true;
+        }
+        bool ReadU64(uint64_t& out) {
+            if (size - pos < 8) return false;
+            out = 0;
+            for (int i = 0; i < 8; ++i) out |= static_cast<uint64_t>(data[pos + i]) << (8 * i);
+            pos += 8;
+            return true;
+        }
+        bool ReadVarint(uint64_t& out) {
+            out = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte = 0;
+                if (!ReadByte(byte)) return false;
+                out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+        bool ReadName(std::string& out) {
+            uint8_t length = 0;
+            if (!ReadByte(length) || size - pos < length) return false;
+            out.assign(reinterpret_cast<const char*>(data + pos), length);
+            pos += length;
+            return true;
+        }
+    };
+
+    bool ReadGameStart(ByteCursor& in, JournalGameStart& start) {
+        uint8_t boardSize = 0, mode = 0, shipCount = 0;
+        if (!in.ReadVarint(start.gameId) || !in.ReadU64(start.seed) || !in.ReadByte(boardSize) || !in.ReadByte(mode)) return false;
+        if (mode > static_cast<uint8_t>(GameMode::COMPUTER_VS_COMPUTER)) return false;
+        if (!in.ReadName(start.playerNames[0]) || !in.ReadName(start.playerNames[1]) || !in.ReadByte(shipCount)) return false;
+        if (shipCount > MAX_FLEET_SIZE) return false;
+        start.boardSize = boardSize;
+        start.mode = static_cast<GameMode>(mode);
+        start.shipCount = shipCount;
+        for (int p = 0; p < 2; ++p) {
+            for (int i = 0; i < shipCount; ++i) {
+                uint8_t size = 0, row = 0, col = 0, horizontal = 0;
+                if (!in.ReadByte(size) || !in.ReadByte(row) || !in.ReadByte(col) || !in.ReadByte(horizontal) || horizontal > 1) return false;
+                JournalShip& ship = start.ships[p][i];
+                ship.size = size; ship.row = row; ship.col = col; ship.horizontal = (horizontal == 1);
+            }
+        }
+        return true;
+    }
+
+    // Recorded placement of every ship of 'player', or false if the fleet does not fit the record format.
+    template <int N>
+    bool DescribeFleet(const BasicPlayer<N>& player, JournalShip* ships) {
+        for (int i = 0; i < player.getShipCount(); ++i) {
+            const Ship& ship = player.getShip(i);
+            if (!ship.isPlaced()) return false;
+            CellCoordinate first = ship.getCell(0);
+            ships[i].size = ship.getSize();
+            ships[i].row = first.row;
+            ships[i].col = first.col;
+            ships[i].horizontal = ship.getCellCount() < 2 || ship.getCell(1).row == first.row;
+        }
+        return true;
+    }
+
+    // Places the recorded fleet on 'player', unless it is already there (the usual case when the
+    // seed still produces the same placement).
+    template <int N>
+    bool RestoreFleet(BasicPlayer<N>& player, const JournalShip* ships, int shipCount) {
+        if (player.getShipCount() != shipCount) return false;
+        JournalShip current[MAX_FLEET_SIZE];
+        bool same = DescribeFleet(player, current);
+        for (int i = 0; same && i < shipCount; ++i) {
+            same = current[i].row == ships[i].row && current[i].col == ships[i].col && current[i].horizontal == ships[i].horizontal;
+        }
+        if (same) return true;
+        player.resetPlayer();
+        for (int i = 0; i < shipCount; ++i) {
+            if (player.getShip(i).getSize() != ships[i].size || !player.placeShip(i, ships[i].row, ships[i].col, ships[i].horizontal)) return false;
+        }
+        return true;
+    }
+}
+
+JournalReader::JournalReader(const uint8_t* d, size_t s) : data(d), size(s), offset(0), valid(false) {
+    if (size >= JOURNAL_HEADER_SIZE && data[0] == JOURNAL_MAGIC[0] && data[1] == JOURNAL_MAGIC[1] && data[2] == JOURNAL_MAGIC[2]
+        && data[3] == JOURNAL_VERSION) {
+        valid = true;
+        offset = JOURNAL_HEADER_SIZE;
+    }
+}
+
+bool JournalReader::Next(JournalRecord& record) {
+    if (!valid || offset >= size) return false;
+    ByteCursor in{ data, size, offset };
+    uint8_t tag = 0;
+    in.ReadByte(tag);
+    bool ok = false;
+    if (tag == JOURNAL_GAME_START) {
+        record.type = JournalRecordType::GAME_START;
+        ok = ReadGameStart(in, record.start);
+    }
+    else if (tag == JOURNAL_GAME_END) {
+        uint8_t finished = 0;
+        record.type = JournalRecordType::GAME_END;
+        ok = in.ReadVarint(record.end.gameId) && in.ReadByte(finished) && finished <= 1;
+        record.end.finished = (finished == 1);
+    }
+    else if (tag >= JOURNAL_MOVE && IsRecordedOutcome(static_cast<AttackOutcome>(tag - JOURNAL_MOVE))) {
+        uint8_t row = 0, col = 0;
+        record.type = JournalRecordType::MOVE;
+        ok = in.ReadVarint(record.move.gameId) && in.ReadByte(row) && in.ReadByte(col);
+        record.move.row = row;
+        record.move.col = col;
+        record.move.outcome = static_cast<AttackOutcome>(tag - JOURNAL_MOVE);
+    }
+    if (!ok) return false; // 'offset' stays at the start of the bad record
+    offset = in.pos;
+    return true;
+}
+
+GameJournalWriter::~GameJournalWriter() {
+    Close();
+}
+
+bool GameJournalWriter::Open(const std::string& path, std::string& error) {
+    Close();
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) { error = "cannot open journal " + path; return false; }
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0) {
+        buffer.insert(buffer.end(), JOURNAL_MAGIC, JOURNAL_MAGIC + 3);
+        buffer.push_back(JOURNAL_VERSION);
+    }
+    buffer.reserve(FLUSH_BYTES + 1024);
+    if (!Sync()) { error = "cannot write journal " + path; return false; }
+    return true;
+}
+
+void GameJournalWriter::Close() {
+    if (!file) return;
+    Sync();
+    std::fclose(file);
+    file = nullptr;
+}
+
+template <int N>
+void GameJournalWriter::AppendGameStart(uint64_t gameId, const BasicBattleshipGameLogic<N>& logic) {
+    const BasicPlayer<N>* players[2] = { logic.GetPlayer1(), logic.GetPlayer2() };
+    JournalShip ships[2][MAX_FLEET_SIZE];
+    if (!players[0] || !players[1] || players[0]->getShipCount() != players[1]->getShipCount()
+        || !DescribeFleet(*players[0], ships[0]) || !DescribeFleet(*players[1], ships[1])) return;
+    buffer.push_back(JOURNAL_GAME_START);
+    AppendVarint(gameId);
+    for (int i = 0; i < 8; ++i) buffer.push_back(static_cast<uint8_t>(logic.GetSeed() >> (8 * i)));
+    buffer.push_back(static_cast<uint8_t>(N));
+    buffer.push_back(static_cast<uint8_t>(logic.GetActiveMode()));
+    AppendName(players[0]->getName());
+    AppendName(players[1]->getName());
+    int shipCount = players[0]->getShipCount();
+    buffer.push_back(static_cast<uint8_t>(shipCount));
+    for (int p = 0; p < 2; ++p) {
+        for (int i = 0; i < shipCount; ++i) {
+            const JournalShip& ship = ships[p][i];
+            uint8_t bytes[4] = { static_cast<uint8_t>(ship.size), static_cast<uint8_t>(ship.row), static_cast<uint8_t>(ship.col), ship.horizontal ? uint8_t(1) : uint8_t(0) };
+            buffer.insert(buffer.end(), bytes, bytes + 4);
+        }
+    }
+    FlushIfFull();
+}
+
+void GameJournalWriter::AppendGameStart(uint64_t gameId, const GameSession& session) {
+    if (const BasicBattleshipGameLogic<10>* logic = session.GetLogic<10>()) AppendGameStart(gameId, *logic);
+    else if (const BasicBattleshipGameLogic<15>* logic = session.GetLogic<15>()) AppendGameStart(gameId, *logic);
+    else if (const BasicBattleshipGameLogic<20>* logic = session.GetLogic<20>()) AppendGameStart(gameId, *logic);
+    else if (const BasicBattleshipGameLogic<32>* logic = session.GetLogic<32>()) AppendGameStart(gameId, *logic);
+}
+
+void GameJournalWriter::AppendMove(uint64_t gameId, const AttackEvent& event) {
+    if (!event.isAccepted()) return;
+    buffer.push_back(static_cast<uint8_t>(JOURNAL_MOVE + static_cast<int>(event.outcome)));
+    AppendVarint(gameId);
+    buffer.push_back(static_cast<uint8_t>(event.row));
+    buffer.push_back(static_cast<uint8_t>(event.col));
+    FlushIfFull();
+}
+
+void GameJournalWriter::AppendGameEnd(uint64_t gameId, bool finished) {
+    buffer.push_back(JOURNAL_GAME_END);
+    AppendVarint(gameId);
+    buffer.push_back(finished ? 1 : 0);
+    FlushIfFull();
+}
+
+void GameJournalWriter::AppendVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void GameJournalWriter::AppendName(const std::string& name) {
+    size_t length = name.size() < 255 ? name.size() : 255;
+    buffer.push_back(static_cast<uint8_t>(length));
+    buffer.insert(buffer.end(), name.begin(), name.begin() + length);
+}
+
+bool GameJournalWriter::Flush() {
+    if (!file) return false;
+    if (buffer.empty()) return true;
+    size_t written = std::fwrite(buffer.data(), 1, buffer.size(), file);
+    bytesWritten += written;
+    unsynced = true;
+    bool ok = written == buffer.size() && std::fflush(file) == 0;
+    buffer.clear();
+    return ok;
+}
+
+bool GameJournalWriter::Sync() {
+    if (!Flush()) return false;
+    if (!unsynced) return true;
+    unsynced = false;
+    return SyncFile(file);
+}
+
+template <int N>
+bool ReplayGame(const JournalGameStart& start, const JournalMove* moves, size_t moveCount, BasicBattleshipGameLogic<N>& logic) {
+    if (start.boardSize != N) return false;
+    logic.StartNewGame(start.playerNames[0], start.playerNames[1], start.mode, start.seed);
+    if (!RestoreFleet(*logic.GetPlayer1ForUpdate(), start.ships[0], start.shipCount)
+        || !RestoreFleet(*logic.GetPlayer2ForUpdate(), start.ships[1], start.shipCount)) return false;
+    for (size_t i = 0; i < moveCount; ++i) {
+        AttackEvent event = logic.MakeAttack(moves[i].row, moves[i].col);
+        if (!event.isAccepted() || event.outcome != moves[i].outcome) return false;
+    }
+    return true;
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template void GameJournalWriter::AppendGameStart<10>(uint64_t, const BasicBattleshipGameLogic<10>&);
+template void GameJournalWriter::AppendGameStart<15>(uint64_t, const BasicBattleshipGameLogic<15>&);
+template void GameJournalWriter::AppendGameStart<20>(uint64_t, const BasicBattleshipGameLogic<20>&);
+template void GameJournalWriter::AppendGameStart<32>(uint64_t, const BasicBattleshipGameLogic<32>&);
+template bool ReplayGame<10>(const JournalGameStart&, const JournalMove*, size_t, BasicBattleshipGameLogic<10>&);
+template bool ReplayGame<15>(const JournalGameStart&, const JournalMove*, size_t, BasicBattleshipGameLogic<15>&);
+template bool ReplayGame<20>(const JournalGameStart&, const JournalMove*, size_t, BasicBattleshipGameLogic<20>&);
+template bool ReplayGame<32>(const JournalGameStart&, const JournalMove*, size_t, BasicBattleshipGameLogic<32>&);
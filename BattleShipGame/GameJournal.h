@@ -0,0 +1,132 @@
+// GameJournal.h
+#pragma once
+#include "BattleShipGame.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class GameSession;
+
+// Append-only binary journal of games: the seed and fleet placements of every game, then one
+// record per accepted MakeAttack, enough to rebuild the game at any move. Records of different
+// games may interleave (a server appends them as the games are played), so each names its game.
+// Integers are little-endian and nothing in the file depends on where it is loaded, so a reader
+// can work directly on a memory-mapped file.
+//
+//   header      'B' 'S' 'J' JOURNAL_VERSION
+//   game start  JOURNAL_GAME_START <game id> <seed: 8 bytes> <board size> <mode> <name 1> <name 2>
+//               <ship count> then, for player 1 and then player 2, per ship: <size> <row> <col> <horizontal>
+//   move        JOURNAL_MOVE + outcome (MISS, HIT or SUNK), <game id> <row> <col>
+//   game end    JOURNAL_GAME_END <game id> <finished: 1, or 0 if abandoned>
+//
+// <game id> is an unsigned LEB128 varint, so a move takes 4 bytes while ids stay below 128.
+// Names are a length byte followed by at most 255 bytes. Whose turn it was is not stored: it
+// follows from replaying the game. A game id only has to be unique among the games in progress;
+// a game start for an id still in progress ends the earlier game (e.g. after a server restart).
+const uint8_t JOURNAL_VERSION = 1;
+const size_t JOURNAL_HEADER_SIZE = 4;
+const uint8_t JOURNAL_GAME_START = 0x01;
+const uint8_t JOURNAL_GAME_END = 0x02;
+const uint8_t JOURNAL_MOVE = 0x10; // Plus the AttackOutcome value
+
+struct JournalShip {
+    int size = 0;
+    int row = 0;
+    int col = 0;
+    bool horizontal = true;
+};
+
+struct JournalGameStart {
+    uint64_t gameId = 0;
+    uint64_t seed = 0;
+    int boardSize = 0;
+    GameMode mode = GameMode::PLAYER_VS_PLAYER;
+    std::string playerNames[2];
+    int shipCount = 0;
+    JournalShip ships[2][MAX_FLEET_SIZE]; // [player 1 / player 2][ship index]
+};
+
+struct JournalMove {
+    uint64_t gameId = 0;
+    int row = 0;
+    int col = 0;
+    AttackOutcome outcome = AttackOutcome::MISS;
+};
+
+struct JournalGameEnd {
+    uint64_t gameId = 0;
+    bool finished = false;
+};
+
+enum class JournalRecordType { GAME_START, MOVE, GAME_END };
+
+// One decoded record; only the member named by 'type' is filled in.
+struct JournalRecord {
+    JournalRecordType type = JournalRecordType::MOVE;
+    JournalGameStart start;
+    JournalMove move;
+    JournalGameEnd end;
+};
+
+// Walks the records of a journal held in memory (read or mapped); does not copy the data.
+class JournalReader {
+public:
+    JournalReader(const uint8_t* data, size_t size);
+    bool IsValid() const { return valid; } // The header is present and of a known version
+    // Decodes the next record into 'record' (reusing its name buffers). False at the end of the
+    // data, or at a record that is cut short or malformed; IsTruncated() tells the two apart.
+    bool Next(JournalRecord& record);
+    bool IsTruncated() const { return valid && offset < size; }
+    size_t GetOffset() const { return offset; } // Bytes consumed so far, header included
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+    bool valid;
+};
+
+// Appends records to a journal file. Records collect in memory and are written out once
+// FLUSH_BYTES have built up or on Flush(); Sync() also forces them to disk, so the caller
+// chooses how often to pay for an fsync.
+class GameJournalWriter {
+public:
+    static const size_t FLUSH_BYTES = 64 * 1024;
+
+    GameJournalWriter() = default;
+    GameJournalWriter(const GameJournalWriter&) = delete;
+    GameJournalWriter& operator=(const GameJournalWriter&) = delete;
+    ~GameJournalWriter(); // Syncs and closes
+
+    bool Open(const std::string& path, std::string& error); // Appends to 'path', writing the header if the file is new
+    bool IsOpen() const { return file != nullptr; }
+    void Close();
+
+    // The game as StartNewGame left it: seed, mode, names and both fleets.
+    template <int N> void AppendGameStart(uint64_t gameId, const BasicBattleshipGameLogic<N>& logic);
+    void AppendGameStart(uint64_t gameId, const GameSession& session);
+    void AppendMove(uint64_t gameId, const AttackEvent& event); // Ignores events that were not accepted
+    void AppendGameEnd(uint64_t gameId, bool finished);
+
+    bool Flush(); // Hands buffered records to the OS
+    bool Sync();  // Flush, then fsync if anything was written since the last Sync
+    size_t GetBytesWritten() const { return bytesWritten; }
+
+private:
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    size_t bytesWritten = 0;
+    bool unsynced = false;
+
+    void AppendVarint(uint64_t value);
+    void AppendName(const std::string& name);
+    void FlushIfFull() { if (buffer.size() >= FLUSH_BYTES) Flush(); }
+};
+
+// Rebuilds 'logic' as it stood after the first 'moveCount' moves of the game described by
+// 'start'. Every move must be accepted and produce its recorded outcome; false otherwise (or
+// if the game was played on another board size), leaving 'logic' at the first move that
+// disagreed. Computer players' own random choices are not rewound.
+template <int N>
+bool ReplayGame(const JournalGameStart& start, const JournalMove* moves, size_t moveCount, BasicBattleshipGameLogic<N>& logic);
@@ -0,0 +1,67 @@
+// GameRandom.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Small, fast generator for game randomness (ship placement, AI tie-breaks). PCG32 (XSH-RR output)
+// on a 64-bit LCG with a fixed stream, so the whole state is 8 bytes and a game can be replayed
+// from its seed. Each game owns its own instance, so games on different threads never share state.
+class GameRandom {
+public:
+    explicit GameRandom(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        state = 0;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + INCREMENT;
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rot) | (xorShifted << ((0u - rot) & 31));
+    }
+
+    // Uniform in [0, bound), bound > 0 (Lemire's multiply-shift with rejection, no modulo bias).
+    uint32_t nextBelow(uint32_t bound) {
+        uint64_t m = static_cast<uint64_t>(next()) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(next()) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    bool nextBool() { return (next() >> 31) != 0; }
+
+    uint64_t getState() const { return state; }
+    void setState(uint64_t s) { state = s; }
+
+private:
+    static const uint64_t INCREMENT = 1442695040888963407ULL;
+    uint64_t state;
+};
+
+// Mixes a base seed with an index (e.g. a game number) into an independent seed (SplitMix64 finalizer).
+inline uint64_t mixSeed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// A fresh seed for a game nobody asked to reproduce (std::random_device mixed with the clock).
+// Record it (BattleshipGameLogic::GetSeed) to replay the game later.
+inline uint64_t makeGameSeed() {
+    std::random_device device;
+    uint64_t entropy = (static_cast<uint64_t>(device()) << 32) ^ device();
+    return mixSeed(entropy, static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+}
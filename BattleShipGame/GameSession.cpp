@@ -0,0 +1,105 @@
+// GameSession.cpp
+#include "GameSession.h"
+#include <stdexcept>
+
+struct GameSession::Concept {
+    virtual ~Concept() = default;
+    virtual int BoardSize() const = 0;
+    virtual void* Logic() = 0;
+    virtual void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode) = 0;
+    virtual void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed) = 0;
+    virtual uint64_t GetSeed() const = 0;
+    virtual bool SaveSnapshot(GameSnapshot& out) const = 0;
+    virtual bool RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name) = 0;
+    virtual AttackEvent MakeAttack(int r, int c) = 0;
+    virtual bool IsComputerTurn() const = 0;
+    virtual AttackEvent MakeComputerMove() = 0;
+    virtual GameTurn GetCurrentTurnState() const = 0;
+    virtual bool IsGameOver() const = 0;
+    virtual const std::string& GetLastActionMessage() const = 0;
+    virtual const AttackEvent& GetLastAttack() const = 0;
+    virtual std::string GetWinnerString() const = 0;
+    virtual const std::string& GetPlayerName(int playerId) const = 0;
+    virtual void SetPlayerName(int playerId, const std::string& name) = 0;
+    virtual std::string GetOwnBoardAsString(int playerId) const = 0;
+    virtual char GetOwnBoardCell(int playerId, int r, int c) const = 0;
+};
+
+template <int N>
+struct GameSession::Model : GameSession::Concept {
+    BasicBattleshipGameLogic<N> logic;
+
+    int BoardSize() const override { return N; }
+    void* Logic() override { return &logic; }
+    void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode) override { logic.StartNewGame(p1Name, p2Name, mode); }
+    void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed) override { logic.StartNewGame(p1Name, p2Name, mode, seed); }
+    uint64_t GetSeed() const override { return logic.GetSeed(); }
+    bool SaveSnapshot(GameSnapshot& out) const override { return logic.SaveSnapshot(out); }
+    bool RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name) override {
+        return logic.RestoreSnapshot(snapshot, p1Name, p2Name);
+    }
+    AttackEvent MakeAttack(int r, int c) override { return logic.MakeAttack(r, c); }
+    bool IsComputerTurn() const override { return logic.IsComputerTurn(); }
+    AttackEvent MakeComputerMove() override { return logic.MakeComputerMove(); }
+    GameTurn GetCurrentTurnState() const override { return logic.GetCurrentTurnState(); }
+    bool IsGameOver() const override { return logic.IsGameOver(); }
+    const std::string& GetLastActionMessage() const override { return logic.GetLastActionMessage(); }
+    const AttackEvent& GetLastAttack() const override { return logic.GetLastAttack(); }
+    std::string GetWinnerString() const override { return logic.GetWinnerString(); }
+    const std::string& GetPlayerName(int playerId) const override {
+        static const std::string empty;
+        const BasicPlayer<N>* player = logic.GetPlayerById(playerId);
+        return player ? player->getName() : empty;
+    }
+    void SetPlayerName(int playerId, const std::string& name) override {
+        BasicPlayer<N>* player = logic.GetPlayerByIdForUpdate(playerId);
+        if (player) player->setName(name);
+    }
+    std::string GetOwnBoardAsString(int playerId) const override {
+        const BasicPlayer<N>* player = logic.GetPlayerById(playerId);
+        return player ? player->getOwnBoardAsString() : std::string();
+    }
+    char GetOwnBoardCell(int playerId, int r, int c) const override {
+        const BasicPlayer<N>* player = logic.GetPlayerById(playerId);
+        return player ? player->getOwnBoardCell(r, c) : ' ';
+    }
+};
+
+GameSession::GameSession(int boardSize) {
+    switch (boardSize) {
+    case 10: impl.reset(new Model<10>()); break;
+    case 15: impl.reset(new Model<15>()); break;
+    case 20: impl.reset(new Model<20>()); break;
+    case 32: impl.reset(new Model<32>()); break;
+    default: throw std::invalid_argument("Unsupported board size: " + std::to_string(boardSize));
+    }
+}
+
+GameSession::~GameSession() = default;
+
+bool GameSession::IsSupportedBoardSize(int boardSize) {
+    return boardSize == 10 || boardSize == 15 || boardSize == 20 || boardSize == 32;
+}
+
+void* GameSession::RawLogic(int boardSize) const { return impl->BoardSize() == boardSize ? impl->Logic() : nullptr; }
+
+int GameSession::GetBoardSize() const { return impl->BoardSize(); }
+void GameSession::StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode) { impl->StartNewGame(p1Name, p2Name, mode); }
+void GameSession::StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed) { impl->StartNewGame(p1Name, p2Name, mode, seed); }
+uint64_t GameSession::GetSeed() const { return impl->GetSeed(); }
+bool GameSession::SaveSnapshot(GameSnapshot& out) const { return impl->SaveSnapshot(out); }
+bool GameSession::RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name) {
+    return impl->RestoreSnapshot(snapshot, p1Name, p2Name);
+}
+AttackEvent GameSession::MakeAttack(int r, int c) { return impl->MakeAttack(r, c); }
+bool GameSession::IsComputerTurn() const { return impl->IsComputerTurn(); }
+AttackEvent GameSession::MakeComputerMove() { return impl->MakeComputerMove(); }
+GameTurn GameSession::GetCurrentTurnState() const { return impl->GetCurrentTurnState(); }
+bool GameSession::IsGameOver() const { return impl->IsGameOver(); }
+const std::string& GameSession::GetLastActionMessage() const { return impl->GetLastActionMessage(); }
+const AttackEvent& GameSession::GetLastAttack() const { return impl->GetLastAttack(); }
+std::string GameSession::GetWinnerString() const { return impl->GetWinnerString(); }
+const std::string& GameSession::GetPlayerName(int playerId) const { return impl->GetPlayerName(playerId); }
+void GameSession::SetPlayerName(int playerId, const std::string& name) { impl->SetPlayerName(playerId, name); }
+std::string GameSession::GetOwnBoardAsString(int playerId) const { return impl->GetOwnBoardAsString(playerId); }
+char GameSession::GetOwnBoardCell(int playerId, int r, int c) const { return impl->GetOwnBoardCell(playerId, r, c); }
@@ -0,0 +1,56 @@
+// GameSession.h
+#pragma once
+#include "BattleShipGame.h"
+#include <memory>
+#include <string>
+
+// Board-size-erased handle on a BasicBattleshipGameLogic<N>, so a server can hold games of
+// different sizes side by side. The size is fixed when the session is created.
+class GameSession {
+public:
+    explicit GameSession(int boardSize = BOARD_SIZE_CONST); // Throws std::invalid_argument for unsupported sizes
+    GameSession(GameSession&&) = default;
+    GameSession& operator=(GameSession&&) = default;
+    ~GameSession();
+
+    static bool IsSupportedBoardSize(int boardSize); // 10, 15, 20 or 32
+
+    int GetBoardSize() const;
+    void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode = GameMode::PLAYER_VS_PLAYER);
+    void StartNewGame(const std::string& p1Name, const std::string& p2Name, GameMode mode, uint64_t seed);
+    uint64_t GetSeed() const;
+    bool SaveSnapshot(GameSnapshot& out) const; // See BasicBattleshipGameLogic::SaveSnapshot
+    bool RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name); // Same board size only
+    AttackEvent MakeAttack(int r, int c);
+    bool IsComputerTurn() const;
+    AttackEvent MakeComputerMove(); // See BasicBattleshipGameLogic::MakeComputerMove
+    GameTurn GetCurrentTurnState() const;
+    bool IsGameOver() const;
+    const std::string& GetLastActionMessage() const;
+    const AttackEvent& GetLastAttack() const;
+    std::string GetWinnerString() const;
+    const std::string& GetPlayerName(int playerId) const;
+    void SetPlayerName(int playerId, const std::string& name);
+    std::string GetOwnBoardAsString(int playerId) const;
+    char GetOwnBoardCell(int playerId, int r, int c) const;
+
+    // Typed access for callers that know the size; nullptr if the session has a different size.
+    template <int N> BasicBattleshipGameLogic<N>* GetLogic();
+    template <int N> const BasicBattleshipGameLogic<N>* GetLogic() const;
+
+private:
+    struct Concept;
+    template <int N> struct Model;
+    std::unique_ptr<Concept> impl;
+    void* RawLogic(int boardSize) const;
+};
+
+template <int N>
+BasicBattleshipGameLogic<N>* GameSession::GetLogic() {
+    return static_cast<BasicBattleshipGameLogic<N>*>(RawLogic(N));
+}
+
+template <int N>
+const BasicBattleshipGameLogic<N>* GameSession::GetLogic() const {
+    return static_cast<const BasicBattleshipGameLogic<N>*>(RawLogic(N));
+}
@@ -0,0 +1,220 @@
+// GameSnapshot.cpp
+// BasicBattleshipGameLogic<N>::SaveSnapshot / RestoreSnapshot; the format is described in GameSnapshot.h.
+#include "BattleShipGame.h"
+#include "ComputerPlayer.h"
+
+namespace {
+    const size_t SNAPSHOT_HEADER_BYTES = 19;
+
+    // Width of a cell index on a board of 'cellCount' cells.
+    int CellBits(int cellCount) {
+        int bits = 1;
+        while ((1 << bits) < cellCount) ++bits;
+        return bits;
+    }
+
+    void WriteU64(uint8_t* out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t ReadU64(const uint8_t* in) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        return value;
+    }
+
+    // Least-significant-bit-first packing; fields are at most 32 bits wide.
+    class BitWriter {
+    public:
+        BitWriter(uint8_t* out, size_t capacity) : out(out), capacity(capacity) {}
+        void Write(uint32_t value, int bits) {
+            pending |= static_cast<uint64_t>(value & static_cast<uint32_t>(lowBitMask64(bits))) << pendingBits;
+            pendingBits += bits;
+            while (pendingBits >= 8) { Put(static_cast<uint8_t>(pending)); pending >>= 8; pendingBits -= 8; }
+        }
+        template <int N>
+        void WriteBoard(const BitBoard<N>& board) {
+            for (int r = 0; r < N; ++r) Write(static_cast<uint32_t>(board.extract(r * N, N)), N);
+        }
+        size_t Finish() { // Pads the last byte; returns the bytes written
+            if (pendingBits > 0) { Put(static_cast<uint8_t>(pending)); pending = 0; pendingBits = 0; }
+            return used;
+        }
+        bool Ok() const { return !overflow; }
+
+    private:
+        uint8_t* out;
+        size_t capacity;
+        size_t used = 0;
+        uint64_t pending = 0;
+        int pendingBits = 0;
+        bool overflow = false;
+        void Put(uint8_t byte) { if (used < capacity) out[used++] = byte; else overflow = true; }
+    };
+
+    class BitReader {
+    public:
+        BitReader(const uint8_t* in, size_t size) : in(in), size(size) {}
+        uint32_t Read(int bits) {
+            while (pendingBits < bits) {
+                if (used >= size) { overflow = true; return 0; }
+                pending |= static_cast<uint64_t>(in[used++]) << pendingBits;
+                pendingBits += 8;
+            }
+            uint32_t value = static_cast<uint32_t>(pending & lowBitMask64(bits));
+            pending >>= bits;
+            pendingBits -= bits;
+            return value;
+        }
+        template <int N>
+        void ReadBoard(BitBoard<N>& board) {
+            board.clear();
+            for (int r = 0; r < N; ++r) board.deposit(r * N, N, Read(N));
+        }
+        bool Ok() const { return !overflow; }
+
+    private:
+        const uint8_t* in;
+        size_t size;
+        size_t used = 0;
+        uint64_t pending = 0;
+        int pendingBits = 0;
+        bool overflow = false;
+    };
+
+    // Last-attack outcome codes; 0 means no attack has been accepted yet.
+    uint32_t OutcomeCode(const AttackEvent& attack) {
+        if (attack.attackerId == 0) return 0;
+        return attack.outcome == AttackOutcome::MISS ? 1 : attack.outcome == AttackOutcome::HIT ? 2 : 3;
+    }
+
+    // The classic fleet, placed; the only fleet the logic deals out.
+    template <int N>
+    bool HasDefaultFleet(const BasicPlayer<N>& player) {
+        if (player.getShipCount() != DEFAULT_FLEET_COUNT) return false;
+        for (int i = 0; i < DEFAULT_FLEET_COUNT; ++i) {
+            if (player.getShip(i).getTypeId() != DEFAULT_FLEET[i] || !player.getShip(i).isPlaced()) return false;
+        }
+        return true;
+    }
+}
+
+template <int N>
+bool BasicBattleshipGameLogic<N>::SaveSnapshot(GameSnapshot& out) const {
+    out.size = 0;
+    if (!player1 || !player2 || currentTurnState == GameTurn::SETUP || !HasDefaultFleet(*player1) || !HasDefaultFleet(*player2)) return false;
+    const PlayerType* players[2] = { player1.get(), player2.get() };
+    const bool computer[2] = { player1IsComputer, player2IsComputer };
+    uint8_t flags = static_cast<uint8_t>(static_cast<int>(activeMode) | (static_cast<int>(currentTurnState) << 2));
+    for (int p = 0; p < 2; ++p) {
+        if (computer[p] && static_cast<const BasicComputerPlayer<N>&>(*players[p]).getStrategy() == ComputerStrategy::RANDOM) flags |= 1 << (5 + p);
+    }
+    out.bytes[0] = SNAPSHOT_VERSION;
+    out.bytes[1] = static_cast<uint8_t>(N);
+    out.bytes[2] = flags;
+    WriteU64(out.bytes + 3, gameSeed);
+    WriteU64(out.bytes + 11, random.getState());
+
+    const int cellBits = CellBits(N * N);
+    BitWriter bits(out.bytes + SNAPSHOT_HEADER_BYTES, GameSnapshot::MAX_BYTES - SNAPSHOT_HEADER_BYTES);
+    for (int p = 0; p < 2; ++p) {
+        for (int i = 0; i < DEFAULT_FLEET_COUNT; ++i) {
+            const Ship& ship = players[p]->getShip(i);
+            CellCoordinate first = ship.getCell(0);
+            bits.Write(static_cast<uint32_t>(PlayerType::Board::cellIndex(first.row, first.col)), cellBits);
+            bits.Write(ship.isHorizontal() ? 1 : 0, 1);
+            bits.Write(ship.getHitMask(), ship.getSize());
+        }
+        if (computer[p]) bits.Write(static_cast<const BasicComputerPlayer<N>&>(*players[p]).getPlacedSunkShips(*players[1 - p]), DEFAULT_FLEET_COUNT);
+        bits.WriteBoard(players[p]->getOwnMissMask());
+    }
+    bits.Write(lastAttack.attackerId ? static_cast<uint32_t>(PlayerType::Board::cellIndex(lastAttack.row, lastAttack.col)) : 0, cellBits);
+    bits.Write(OutcomeCode(lastAttack), 2);
+    size_t length = bits.Finish();
+    if (!bits.Ok()) return false;
+    out.size = SNAPSHOT_HEADER_BYTES + length;
+    return true;
+}
+
+template <int N>
+bool BasicBattleshipGameLogic<N>::RestoreSnapshot(const GameSnapshot& snapshot, const std::string& p1Name, const std::string& p2Name) {
+    currentTurnState = GameTurn::SETUP; // Until the whole snapshot has been applied
+    const uint8_t* in = snapshot.bytes;
+    if (snapshot.size < SNAPSHOT_HEADER_BYTES || snapshot.size > GameSnapshot::MAX_BYTES || in[0] != SNAPSHOT_VERSION || in[1] != N) return false;
+    int mode = in[2] & 3, turn = (in[2] >> 2) & 7;
+    if (mode > static_cast<int>(GameMode::COMPUTER_VS_COMPUTER) || turn > static_cast<int>(GameTurn::GAME_OVER_P2_WINS)) return false;
+    activeMode = static_cast<GameMode>(mode);
+    gameSeed = ReadU64(in + 3);
+    random.setState(ReadU64(in + 11));
+    const bool computer[2] = { activeMode == GameMode::COMPUTER_VS_COMPUTER, activeMode != GameMode::PLAYER_VS_PLAYER };
+    PreparePlayer(player1, player1IsComputer, computer[0], computerStrategies[0], p1Name);
+    PreparePlayer(player2, player2IsComputer, computer[1], computerStrategies[1], p2Name);
+    PlayerType* players[2] = { player1.get(), player2.get() };
+
+    const int cellBits = CellBits(N * N);
+    BitReader bits(in + SNAPSHOT_HEADER_BYTES, snapshot.size - SNAPSHOT_HEADER_BYTES);
+    uint32_t placedSunkShips[2] = { 0, 0 };
+    for (int p = 0; p < 2; ++p) {
+        uint32_t hitMasks[MAX_FLEET_SIZE];
+        for (int i = 0; i < DEFAULT_FLEET_COUNT; ++i) {
+            int cell = static_cast<int>(bits.Read(cellBits));
+            bool horizontal = bits.Read(1) != 0;
+            hitMasks[i] = bits.Read(SHIP_TYPES[DEFAULT_FLEET[i]].size);
+            if (cell >= N * N || !players[p]->placeShip(i, cell / N, cell % N, horizontal)) return false;
+        }
+        if (computer[p]) placedSunkShips[p] = bits.Read(DEFAULT_FLEET_COUNT);
+        typename PlayerType::Board misses;
+        bits.ReadBoard(misses);
+        if (!bits.Ok() || !players[p]->restoreOwnShots(hitMasks, misses)) return false;
+    }
+    int lastCell = static_cast<int>(bits.Read(cellBits));
+    uint32_t lastOutcome = bits.Read(2);
+    if (!bits.Ok() || lastCell >= N * N) return false;
+
+    player1->restoreTrackingBoard(player2->getOwnHitMask(), player2->getOwnMissMask());
+    player2->restoreTrackingBoard(player1->getOwnHitMask(), player1->getOwnMissMask());
+    for (int p = 0; p < 2; ++p) {
+        if (!computer[p]) continue;
+        BasicComputerPlayer<N>& ai = static_cast<BasicComputerPlayer<N>&>(*players[p]);
+        if ((in[2] >> (5 + p)) & 1) ai.setStrategy(ComputerStrategy::RANDOM);
+        else if (ai.getStrategy() == ComputerStrategy::RANDOM) ai.setStrategy(ComputerStrategy::PROBABILITY_DENSITY); // Keeps a configured ENDGAME_SOLVER
+        ai.restoreComputerLogic(*players[1 - p], placedSunkShips[p]);
+    }
+
+    // The turn has to agree with the boards: the game is over exactly when a fleet is sunk.
+    GameTurn restoredTurn = static_cast<GameTurn>(turn);
+    bool overByTurn = restoredTurn == GameTurn::GAME_OVER_P1_WINS || restoredTurn == GameTurn::GAME_OVER_P2_WINS;
+    bool overByBoards = player1->isDefeated() || player2->isDefeated();
+    if (overByTurn != overByBoards || (restoredTurn == GameTurn::GAME_OVER_P1_WINS && !player2->isDefeated())
+        || (restoredTurn == GameTurn::GAME_OVER_P2_WINS && !player1->isDefeated())) return false;
+
+    // The last attack was made by the player not to move now (by the winner once the game is over).
+    lastAttack = AttackEvent();
+    if (lastOutcome != 0) {
+        bool player1Attacked = restoredTurn == GameTurn::PLAYER2 || restoredTurn == GameTurn::GAME_OVER_P1_WINS;
+        const PlayerType* defender = player1Attacked ? player2.get() : player1.get();
+        if (!defender->getOwnShotMask().test(lastCell)) return false;
+        lastAttack.attackerId = player1Attacked ? 1 : 2;
+        lastAttack.row = lastCell / N;
+        lastAttack.col = lastCell % N;
+        lastAttack.outcome = lastOutcome == 1 ? AttackOutcome::MISS : lastOutcome == 2 ? AttackOutcome::HIT : AttackOutcome::SUNK;
+        lastAttack.sunkShipIndex = lastAttack.outcome == AttackOutcome::SUNK ? defender->getShipIndexAt(lastAttack.row, lastAttack.col) : NO_SHIP_INDEX;
+        lastAttack.nextTurn = restoredTurn;
+        lastAttack.gameOver = overByTurn;
+    }
+    currentTurnState = restoredTurn;
+    lastActionEvent = lastAttack;
+    if (lastAttack.attackerId == 0) lastActionEvent.nextTurn = restoredTurn; // Formats as "<player 1>'s turn to attack."
+    lastActionMessageStale = true;
+    return true;
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template bool BasicBattleshipGameLogic<10>::SaveSnapshot(GameSnapshot&) const;
+template bool BasicBattleshipGameLogic<15>::SaveSnapshot(GameSnapshot&) const;
+template bool BasicBattleshipGameLogic<20>::SaveSnapshot(GameSnapshot&) const;
+template bool BasicBattleshipGameLogic<32>::SaveSnapshot(GameSnapshot&) const;
+template bool BasicBattleshipGameLogic<10>::RestoreSnapshot(const GameSnapshot&, const std::string&, const std::string&);
+template bool BasicBattleshipGameLogic<15>::RestoreSnapshot(const GameSnapshot&, const std::string&, const std::string&);
+template bool BasicBattleshipGameLogic<20>::RestoreSnapshot(const GameSnapshot&, const std::string&, const std::string&);
+template bool BasicBattleshipGameLogic<32>::RestoreSnapshot(const GameSnapshot&, const std::string&, const std::string&);
@@ -0,0 +1,44 @@
+// GameSnapshot.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Versioned binary image of a BasicBattleshipGameLogic<N> (SaveSnapshot / RestoreSnapshot), for
+// moving a game to another process or bringing it back after a crash without replaying it.
+// Restoring sets the boards directly, so it costs the same at move 0 as at move 90.
+//
+//   byte 0      SNAPSHOT_VERSION
+//   byte 1      board size N
+//   byte 2      mode (2 bits) | turn (3 bits) << 2 | player 1 RANDOM strategy << 5 | player 2 << 6
+//   bytes 3-10  game seed (GetSeed), little-endian
+//   bytes 11-18 GameRandom state, little-endian
+//   then a bit stream, least significant bit first, for player 1 and then player 2:
+//     per ship of the classic fleet: start cell (cell bits) | horizontal (1) | hit mask (ship size bits)
+//     for a computer player only: which sunk opponent ships its targeting has placed (1 bit per ship)
+//     the water cells the opponent has shot (N * N bits)
+//   and finally the last accepted attack: cell (cell bits) | outcome (2 bits: none, MISS, HIT, SUNK).
+//
+// Cell bits is the width of N * N - 1 (7 for 10x10, which makes the classic game 61 bytes).
+// Player names are not stored; the caller passes them to RestoreSnapshot. Tracking boards are
+// the opponent's own shot marks. The RANDOM strategy's untried-cell order is rebuilt rather than
+// saved, so a restored RANDOM computer fires at uniformly chosen cells but not the same ones.
+// ENDGAME_SOLVER is not stored either: a computer without the RANDOM bit keeps the strategy the
+// restoring game was configured with (SetComputerStrategy), and its solver starts with an empty
+// transposition table, so a search the original finished within its budget may fall back, and
+// it has forgotten a search it gave up on, so it may try that one again.
+const uint8_t SNAPSHOT_VERSION = 1;
+
+struct GameSnapshot {
+    static const size_t MAX_BYTES = 320; // 32x32 needs 296
+    uint8_t bytes[MAX_BYTES];
+    size_t size = 0;
+
+    // Copies a snapshot received from elsewhere; false if it cannot be one.
+    bool assign(const uint8_t* data, size_t length) {
+        if (length > MAX_BYTES) return false;
+        std::memcpy(bytes, data, length);
+        size = length;
+        return true;
+    }
+};
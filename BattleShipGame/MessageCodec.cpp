@@ -0,0 +1,132 @@
+// MessageCodec.cpp
+#include "MessageCodec.h"
+#include <charconv>
+
+namespace {
+    // Indexed by MessageType.
+    const std::string_view COMMANDS[MESSAGE_TYPE_COUNT] = {
+        "", "CONNECT_REQUEST", "WELCOME", "READY", "ATTACK", "GAME_UPDATE", "PROTOCOL", "PROTOCOL_OK", "RESYNC",
+        "GAME_SNAPSHOT", "GAME_DELTA", "DISCONNECT", "SERVER_SHUTDOWN", "RATING", "SPECTATE",
+        "SESSION", "RESUME"
+    };
+    const std::string_view ESCAPED_SPACE = "_SPACE_";
+
+    template <typename T>
+    bool ParseWholeField(std::string_view field, T& out) {
+        T value = 0;
+        auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (field.empty() || result.ec != std::errc() || result.ptr != field.data() + field.size()) return false;
+        out = value;
+        return true;
+    }
+
+    template <typename T>
+    void AppendNumber(std::string& text, T value) {
+        char digits[24]; // A uint64_t has up to 20
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, result.ptr);
+    }
+}
+
+// Commands differ in length or early on, so comparing lengths first rules out nearly all of them.
+MessageType LookupMessageType(std::string_view command) {
+    for (int type = 1; type < MESSAGE_TYPE_COUNT; ++type) {
+        if (COMMANDS[type].size() == command.size() && COMMANDS[type] == command) return static_cast<MessageType>(type);
+    }
+    return MessageType::UNKNOWN;
+}
+
+const char* MessageTypeName(MessageType type) {
+    int index = static_cast<int>(type);
+    return index < MESSAGE_TYPE_COUNT ? COMMANDS[index].data() : "";
+}
+
+std::string_view ProtocolMessage::GetRest(int i) const {
+    if (i >= fieldCount) return std::string_view();
+    return line.substr(static_cast<size_t>(fields[i].data() - line.data()));
+}
+
+// Splits at every space like String::Split(' '), so two spaces in a row make an empty field.
+bool ParseMessage(std::string_view line, ProtocolMessage& out) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    out.line = line;
+    out.fieldCount = 0;
+    out.type = MessageType::UNKNOWN;
+    if (line.empty()) return false;
+    size_t start = 0;
+    while (out.fieldCount < MAX_MESSAGE_FIELDS - 1) {
+        size_t space = line.find(' ', start);
+        if (space == std::string_view::npos) break;
+        out.fields[out.fieldCount++] = line.substr(start, space - start);
+        start = space + 1;
+    }
+    out.fields[out.fieldCount++] = line.substr(start);
+    out.type = LookupMessageType(out.fields[0]);
+    return true;
+}
+
+bool ParseField(std::string_view field, int& out) { return ParseWholeField(field, out); }
+bool ParseField(std::string_view field, unsigned int& out) { return ParseWholeField(field, out); }
+bool ParseField(std::string_view field, uint64_t& out) { return ParseWholeField(field, out); }
+
+std::string UnescapeSpaces(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+    size_t start = 0, found;
+    while ((found = text.find(ESCAPED_SPACE, start)) != std::string_view::npos) {
+        result.append(text.data() + start, found - start);
+        result += ' ';
+        start = found + ESCAPED_SPACE.size();
+    }
+    result.append(text.data() + start, text.size() - start);
+    return result;
+}
+
+MessageBuilder& MessageBuilder::Begin(MessageType type) {
+    text.clear();
+    text.append(COMMANDS[static_cast<int>(type)]);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::Add(std::string_view field) {
+    text += ' ';
+    text.append(field);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::Add(int value) {
+    text += ' ';
+    AppendNumber(text, value);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::Add(unsigned int value) {
+    text += ' ';
+    AppendNumber(text, value);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::Add(uint64_t value) {
+    text += ' ';
+    AppendNumber(text, value);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::Add(char value) {
+    text += ' ';
+    text += value;
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::AddBool(bool value) {
+    return Add(value ? std::string_view("True") : std::string_view("False"));
+}
+
+MessageBuilder& MessageBuilder::AddEscaped(std::string_view field) {
+    text += ' ';
+    for (char ch : field) {
+        if (ch == ' ') text.append(ESCAPED_SPACE);
+        else text += ch;
+    }
+    return *this;
+}
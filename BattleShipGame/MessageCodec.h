@@ -0,0 +1,105 @@
+// MessageCodec.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Tokenizing, dispatch and building of protocol lines, independent of the game logic and of .NET,
+// so Form1, the headless server and the load generator all read and write the protocol the same
+// way. What each command carries is described in Protocol.h.
+
+enum class MessageType : uint8_t {
+    UNKNOWN,
+    CONNECT_REQUEST,
+    WELCOME,
+    READY,
+    ATTACK,
+    GAME_UPDATE,
+    PROTOCOL,
+    PROTOCOL_OK,
+    RESYNC,
+    GAME_SNAPSHOT,
+    GAME_DELTA,
+    DISCONNECT,
+    SERVER_SHUTDOWN,
+    RATING,
+    SPECTATE,
+    SESSION,
+    RESUME
+};
+const int MESSAGE_TYPE_COUNT = 17;
+
+MessageType LookupMessageType(std::string_view command); // UNKNOWN for anything else
+const char* MessageTypeName(MessageType type);            // The command as sent; "" for UNKNOWN
+
+const int MAX_MESSAGE_FIELDS = 16; // The last field keeps the rest of a longer line, spaces and all
+
+// One line split at its spaces, without copying: the fields are views into the line, which must
+// outlive the message. fields[0] is the command.
+struct ProtocolMessage {
+    MessageType type = MessageType::UNKNOWN;
+    std::string_view line;
+    std::string_view fields[MAX_MESSAGE_FIELDS];
+    int fieldCount = 0;
+
+    int GetArgCount() const { return fieldCount > 0 ? fieldCount - 1 : 0; }
+    std::string_view GetField(int i) const { return i < fieldCount ? fields[i] : std::string_view(); }
+    std::string_view GetRest(int i) const; // Field i and everything after it; empty past the end
+};
+
+// False for an empty line. A trailing '\r' (from a client that sends CRLF) is dropped.
+bool ParseMessage(std::string_view line, ProtocolMessage& out);
+// The whole field as a decimal number, as std::from_chars reads it; false (out unchanged) otherwise.
+bool ParseField(std::string_view field, int& out);
+bool ParseField(std::string_view field, unsigned int& out);
+bool ParseField(std::string_view field, uint64_t& out);
+// Free text travels as one field with its spaces written as "_SPACE_".
+std::string UnescapeSpaces(std::string_view text);
+
+// Calls a member function of Target for each command it has one for, looked up by MessageType.
+// A handler can ask for a minimum number of arguments; shorter lines are dropped as malformed.
+// Build one per handler class, once, and share it.
+template <typename Target, typename... Args>
+class MessageDispatcher {
+public:
+    typedef void (Target::*Handler)(const ProtocolMessage& message, Args... args);
+
+    MessageDispatcher& On(MessageType type, Handler handler, int minArgs = 0) {
+        entries[static_cast<int>(type)] = Entry{ handler, minArgs };
+        return *this;
+    }
+    // False when nothing handled the message: an unknown command, or too few arguments.
+    bool Dispatch(Target& target, const ProtocolMessage& message, Args... args) const {
+        const Entry& entry = entries[static_cast<int>(message.type)];
+        if (!entry.handler || message.GetArgCount() < entry.minArgs) return false;
+        (target.*entry.handler)(message, args...);
+        return true;
+    }
+
+private:
+    struct Entry {
+        Handler handler = nullptr;
+        int minArgs = 0;
+    };
+    Entry entries[MESSAGE_TYPE_COUNT];
+};
+
+// Builds one outgoing line (without the '\n') in a buffer that keeps its capacity from one message
+// to the next, so a long-lived builder stops allocating once it has seen the longest message.
+class MessageBuilder {
+public:
+    MessageBuilder& Begin(MessageType type); // Clears the buffer and writes the command
+    MessageBuilder& Add(std::string_view field);
+    MessageBuilder& Add(const char* field) { return Add(std::string_view(field)); }
+    MessageBuilder& Add(int value);
+    MessageBuilder& Add(unsigned int value);
+    MessageBuilder& Add(uint64_t value);
+    MessageBuilder& Add(char value);
+    MessageBuilder& AddBool(bool value);              // "True" / "False", as .NET writes them
+    MessageBuilder& AddEscaped(std::string_view text); // Spaces as "_SPACE_"; see UnescapeSpaces
+
+    const std::string& GetText() const { return text; }
+
+private:
+    std::string text;
+};
@@ -1,148 +1,297 @@
 // Player.cpp
 #include "Player.h" 
-#include <cstdlib>   // For rand()
-#include <vector>    // For std::vector
 
-Player::Player(const std::string& name) : playerName(name) {
+template <int N>
+BasicPlayer<N>::BasicPlayer(const std::string& name) : playerName(name) {
     initializeBoards();
 }
 
-const std::string& Player::getName() const {
+template <int N>
+const std::string& BasicPlayer<N>::getName() const {
     return playerName;
 }
 
-void Player::setName(const std::string& name) {
+template <int N>
+void BasicPlayer<N>::setName(const std::string& name) {
     this->playerName = name;
 }
 
-void Player::initializeBoards() {
-    for (int i = 0; i < BOARD_SIZE_CONST; ++i) {
-        for (int j = 0; j < BOARD_SIZE_CONST; ++j) {
-            ownBoard[i][j] = WATER_CHAR;
-            trackingBoard[i][j] = HIDDEN_CHAR; // Initialize tracking board too
-        }
-    }
+template <int N>
+void BasicPlayer<N>::initializeBoards() {
+    ownShipMask.clear();
+    ownHitMask.clear();
+    ownMissMask.clear();
+    trackHitMask.clear(); // Initialize tracking board too
+    trackMissMask.clear();
+    for (int i = 0; i < CELL_COUNT; ++i) shipIndexAt[i] = NO_SHIP_INDEX;
+    syncSeq = 0;
+}
+
+template <int N>
+bool BasicPlayer<N>::addShipDefinition(int typeId) {
+    if (shipCount >= MAX_FLEET_SIZE || typeId <= NO_SHIP_TYPE || typeId >= SHIP_TYPE_COUNT) return false;
+    ships[shipCount++] = Ship(typeId); // Unplaced
+    return true;
 }
 
-void Player::addShipDefinition(const std::string& name, int size) {
-    ships.emplace_back(name, size); // Creates a new Ship object with given name and size
+template <int N>
+void BasicPlayer<N>::clearShipDefinitions() {
+    initializeBoards();
+    shipCount = 0;
 }
 
-// Places a ship from the 'ships' vector at the given index
-bool Player::placeShip(int shipIndex, int r, int c, bool isHorizontal) {
-    if (shipIndex < 0 || static_cast<size_t>(shipIndex) >= ships.size()) return false;
+// Places a ship from the 'ships' array at the given index
+template <int N>
+bool BasicPlayer<N>::placeShip(int shipIndex, int r, int c, bool isHorizontal) {
+    if (shipIndex < 0 || shipIndex >= shipCount) return false;
     Ship& currentShip = ships[shipIndex];
 
     // Ensure the ship object is clean for placement (no previous cell data)
     // This should be handled by how Ship objects are managed, esp. after Player::resetPlayer
     // or before calling placeShip in a loop like in placeShipsRandomly.
-    // Calling clearCells here makes sure.
-    currentShip.clearCells();
+    // Clearing here makes sure, and also frees the board cells of a previous placement.
+    clearShipCells(shipIndex);
 
-    std::vector<CellCoordinate> tempCellPositions;
     int shipSize = currentShip.getSize();
+    if (shipSize <= 0 || r < 0 || c < 0) return false;
+    if (isHorizontal ? (c + shipSize > N || r >= N)
+                     : (r + shipSize > N || c >= N)) return false;
 
-    if (isHorizontal) {
-        if (c + shipSize > BOARD_SIZE_CONST) return false;
-        for (int j = 0; j < shipSize; ++j) {
-            if (ownBoard[r][c + j] != WATER_CHAR) return false;
-            tempCellPositions.emplace_back(r, c + j);
-        }
+    // Build the placement as a mask so the overlap test is a single intersection.
+    Board placement;
+    int start = Board::cellIndex(r, c);
+    int step = isHorizontal ? 1 : N;
+    for (int k = 0; k < shipSize; ++k) placement.set(start + k * step);
+    if (placement.intersects(ownShipMask | ownHitMask | ownMissMask)) return false;
+
+    ownShipMask |= placement;
+    currentShip.place(r, c, isHorizontal);
+    for (int k = 0; k < shipSize; ++k) shipIndexAt[start + k * step] = static_cast<signed char>(shipIndex);
+    return true;
+}
+
+template <int N>
+void BasicPlayer<N>::clearShipCells(int shipIndex) {
+    if (shipIndex < 0 || shipIndex >= shipCount) return;
+    for (int k = 0; k < ships[shipIndex].getCellCount(); ++k) {
+        CellCoordinate cellPos = ships[shipIndex].getCell(k);
+        int bit = Board::cellIndex(cellPos.row, cellPos.col);
+        ownShipMask.reset(bit);
+        ownHitMask.reset(bit);
+        shipIndexAt[bit] = NO_SHIP_INDEX;
     }
-    else {
-        if (r + shipSize > BOARD_SIZE_CONST) return false;
-        for (int i = 0; i < shipSize; ++i) {
-            if (ownBoard[r + i][c] != WATER_CHAR) return false;
-            tempCellPositions.emplace_back(r + i, c);
+    ships[shipIndex].clearCells();
+}
+
+template <int N>
+bool BasicPlayer<N>::placeShipsRandomly(GameRandom& rng) {
+    // Assumes the ships array contains Ship objects (definitions) ready to be placed.
+    // Player::resetPlayer ensures these are fresh objects.
+    int fleetCells = 0;
+    for (int i = 0; i < shipCount; ++i) {
+        clearShipCells(i);
+        fleetCells += ships[i].getSize();
+    }
+    Board blocked = ownHitMask | ownMissMask; // Ships never go on cells that were already shot
+    if (fleetCells > CELL_COUNT - blocked.count()) return false;
+    uint64_t freeRows[N];
+    for (int r = 0; r < N; ++r) freeRows[r] = ~blocked.extract(r * N, N) & lowBitMask64(N);
+    return placeShipsFrom(0, freeRows, nullptr, false, rng);
+}
+
+namespace {
+    // Legal start cells per row for a ship of 'size' on the free cells 'freeRows' (bit c = column c):
+    // horizontally, bits c..c+size-1 of row r must be free; vertically, bit c of rows r..r+size-1.
+    // A one-cell ship only gets the horizontal set, so each placement appears once.
+    template <int N>
+    void findPlacements(const uint64_t* freeRows, int size, uint64_t* horizontal, uint64_t* vertical) {
+        for (int r = 0; r < N; ++r) {
+            uint64_t h = freeRows[r];
+            for (int k = 1; k < size && h; ++k) h &= freeRows[r] >> k;
+            uint64_t v = 0;
+            if (size > 1 && r + size <= N) {
+                v = freeRows[r];
+                for (int k = 1; k < size && v; ++k) v &= freeRows[r + k];
+            }
+            horizontal[r] = h;
+            vertical[r] = v;
         }
     }
 
-    for (const auto& cellPos : tempCellPositions) {
-        ownBoard[cellPos.row][cellPos.col] = SHIP_CHAR;
-        currentShip.addCellPos(cellPos.row, cellPos.col);
+    // Number of free cells that at least one placement of 'size' would cover.
+    template <int N>
+    int countCoverableCells(const uint64_t* freeRows, int size) {
+        uint64_t horizontal[N], vertical[N], covered[N] = {};
+        findPlacements<N>(freeRows, size, horizontal, vertical);
+        for (int r = 0; r < N; ++r) {
+            for (int k = 0; k < size; ++k) {
+                covered[r] |= horizontal[r] << k;
+                if (vertical[r]) covered[r + k] |= vertical[r];
+            }
+        }
+        int total = 0;
+        for (int r = 0; r < N; ++r) total += popCount64(covered[r] & lowBitMask64(N));
+        return total;
     }
-    return true;
 }
 
-void Player::placeShipsRandomly() {
-    // Assumes ships vector contains Ship objects (definitions) ready to be placed.
-    // Player::resetPlayer ensures these are fresh objects.
-    for (size_t i = 0; i < ships.size(); ++i) {
-        ships[i].clearCells(); // Good practice to ensure it's unplaced
-        bool placed = false;
-        int attempts = 0;
-        while (!placed && attempts < 200) {
-            int r_coord = rand() % BOARD_SIZE_CONST;
-            int c_coord = rand() % BOARD_SIZE_CONST;
-            bool isHorizontal = (rand() % 2 == 0);
-
-            if (placeShip(static_cast<int>(i), r_coord, c_coord, isHorizontal)) {
-                placed = true;
+template <int N>
+bool BasicPlayer<N>::placeShipsFrom(size_t index, const uint64_t* freeRows, const uint64_t* knownFailures, bool prune, GameRandom& rng) {
+    if (index == static_cast<size_t>(shipCount)) return true;
+    int size = ships[index].getSize();
+    if (size <= 0 || size > N) return false;
+
+    // Prune dead ends early: every ship of size >= s lies on cells some size-s placement covers,
+    // so for each size s still to place there must be enough of those cells for all of them.
+    for (size_t i = index; prune && i < static_cast<size_t>(shipCount); ++i) {
+        int s = ships[i].getSize();
+        bool seen = false;
+        for (size_t j = index; j < i && !seen; ++j) seen = ships[j].getSize() == s;
+        if (seen) continue;
+        int needed = 0;
+        for (size_t j = index; j < static_cast<size_t>(shipCount); ++j) if (ships[j].getSize() >= s) needed += ships[j].getSize();
+        if (countCoverableCells<N>(freeRows, s) < needed) return false;
+    }
+
+    // A placement that failed for an earlier ship of this size fails here too: were there a
+    // completion with this ship on it, swapping the two ships would complete the earlier one.
+    uint64_t failed[2 * N];
+    for (int i = 0; i < 2 * N; ++i) failed[i] = knownFailures ? knownFailures[i] : 0;
+    bool nextSameSize = index + 1 < static_cast<size_t>(shipCount) && ships[index + 1].getSize() == size;
+
+    // Draw placements uniformly without replacement until the rest of the fleet fits around one.
+    // On a mostly empty board a few draws over all (row, column, orientation) triples find a legal
+    // placement without enumerating; once that misses, or after a dead end, the legal placements
+    // are enumerated, counted per row and indexed directly.
+    uint64_t horizontal[N], vertical[N];
+    uint32_t rowPlacements[N]; // Untried placements starting in each row, both orientations
+    uint32_t remaining = 0;
+    bool counted = false;
+    uint64_t span = lowBitMask64(size);
+    uint64_t rows[N];
+    for (;;) {
+        int r = -1, c = 0;
+        bool isHorizontal = true;
+        for (int attempt = 0; !counted && attempt < 8 && r < 0; ++attempt) {
+            int tr = static_cast<int>(rng.nextBelow(N)), tc = static_cast<int>(rng.nextBelow(N));
+            bool th = size == 1 || rng.nextBool();
+            if ((failed[(th ? 0 : N) + tr] >> tc) & 1ULL) continue;
+            bool fits = true;
+            if (th) fits = tc + size <= N && ((freeRows[tr] >> tc) & span) == span;
+            else for (int k = 0; k < size && fits; ++k) fits = tr + k < N && ((freeRows[tr + k] >> tc) & 1ULL);
+            if (fits) { r = tr; c = tc; isHorizontal = th; }
+        }
+        if (r < 0) {
+            if (!counted) {
+                findPlacements<N>(freeRows, size, horizontal, vertical);
+                for (int i = 0; i < N; ++i) {
+                    horizontal[i] &= ~failed[i];
+                    vertical[i] &= ~failed[N + i];
+                    rowPlacements[i] = static_cast<uint32_t>(popCount64(horizontal[i]) + popCount64(vertical[i]));
+                    remaining += rowPlacements[i];
+                }
+                counted = true;
             }
-            attempts++;
+            if (remaining == 0) break;
+            uint32_t pick = rng.nextBelow(remaining);
+            r = 0;
+            while (pick >= rowPlacements[r]) pick -= rowPlacements[r++];
+            uint32_t h = static_cast<uint32_t>(popCount64(horizontal[r]));
+            isHorizontal = pick < h;
+            uint64_t bits = isHorizontal ? horizontal[r] : vertical[r];
+            for (uint32_t i = isHorizontal ? 0 : h; i < pick; ++i) bits &= bits - 1;
+            c = countTrailingZeros64(bits);
         }
-        // if (!placed) { /* Optionally handle ships that couldn't be placed */ }
+
+        for (int i = 0; i < N; ++i) rows[i] = freeRows[i];
+        if (isHorizontal) rows[r] &= ~(span << c);
+        else for (int k = 0; k < size; ++k) rows[r + k] &= ~(1ULL << c);
+        if (placeShipsFrom(index + 1, rows, nextSameSize ? failed : nullptr, prune, rng)) return placeShip(static_cast<int>(index), r, c, isHorizontal);
+
+        // Tried; not drawn again
+        failed[(isHorizontal ? 0 : N) + r] |= 1ULL << c;
+        if (counted) {
+            (isHorizontal ? horizontal[r] : vertical[r]) &= ~(1ULL << c);
+            rowPlacements[r]--;
+            remaining--;
+        }
+        prune = true;
     }
+    return false;
 }
 
-char Player::getOwnBoardCell(int r, int c) const {
-    if (r >= 0 && r < BOARD_SIZE_CONST && c >= 0 && c < BOARD_SIZE_CONST) {
-        return ownBoard[r][c];
+// Char view of the own board, derived from the masks.
+template <int N>
+char BasicPlayer<N>::getOwnBoardCell(int r, int c) const {
+    if (r >= 0 && r < N && c >= 0 && c < N) {
+        int bit = Board::cellIndex(r, c);
+        if (ownHitMask.test(bit)) return HIT_CHAR;
+        if (ownMissMask.test(bit)) return MISS_CHAR;
+        return ownShipMask.test(bit) ? SHIP_CHAR : WATER_CHAR;
     }
     return ' ';
 }
 
-char Player::getTrackingBoardCell(int r, int c) const {
-    if (r >= 0 && r < BOARD_SIZE_CONST && c >= 0 && c < BOARD_SIZE_CONST) {
-        return trackingBoard[r][c];
+// Char view of the tracking board, derived from the masks.
+template <int N>
+char BasicPlayer<N>::getTrackingBoardCell(int r, int c) const {
+    if (r >= 0 && r < N && c >= 0 && c < N) {
+        int bit = Board::cellIndex(r, c);
+        if (trackHitMask.test(bit)) return HIT_CHAR;
+        if (trackMissMask.test(bit)) return MISS_CHAR;
+        return HIDDEN_CHAR;
     }
     return ' ';
 }
 
-const std::vector<Ship>& Player::getAllShips() const {
-    return ships;
+template <int N>
+int BasicPlayer<N>::getShipIndexAt(int r, int c) const {
+    if (r < 0 || r >= N || c < 0 || c >= N) return NO_SHIP_INDEX;
+    return shipIndexAt[Board::cellIndex(r, c)];
 }
 
 // This player is being attacked at (r,c)
-char Player::receiveAttack(int r, int c) {
-    if (r < 0 || r >= BOARD_SIZE_CONST || c < 0 || c >= BOARD_SIZE_CONST) {
-        return ' '; // Invalid coordinate
-    }
-    if (ownBoard[r][c] == SHIP_CHAR) {
-        ownBoard[r][c] = HIT_CHAR; // Update board display
-        for (auto& ship : ships) { // Update ship object state
-            if (ship.attemptHit(r, c)) {
-                break;
-            }
-        }
-        return HIT_CHAR;
+template <int N>
+AttackResult BasicPlayer<N>::receiveAttack(int r, int c) {
+    if (r < 0 || r >= N || c < 0 || c >= N) {
+        return { AttackOutcome::INVALID, NO_SHIP_INDEX }; // Invalid coordinate
+    }
+    int bit = Board::cellIndex(r, c);
+    int shipIndex = shipIndexAt[bit];
+    if (ownHitMask.test(bit) || ownMissMask.test(bit)) {
+        return { AttackOutcome::ALREADY_TARGETED, shipIndex }; // Cell was already hit or missed
     }
-    else if (ownBoard[r][c] == WATER_CHAR) {
-        ownBoard[r][c] = MISS_CHAR;
-        return MISS_CHAR;
+    if (shipIndex == NO_SHIP_INDEX) {
+        ownMissMask.set(bit);
+        return { AttackOutcome::MISS, NO_SHIP_INDEX };
     }
-    return ownBoard[r][c]; // Cell was already hit or missed
+    ownHitMask.set(bit);
+    Ship& ship = ships[shipIndex]; // Update only the ship that covers this cell
+    ship.attemptHit(r, c);
+    return { ship.isSunk() ? AttackOutcome::SUNK : AttackOutcome::HIT, shipIndex };
 }
 
 // This player made an attack, and this is the result on the opponent
-bool Player::processAttackResult(int r, int c, char result, Player& opponent) {
+template <int N>
+bool BasicPlayer<N>::processAttackResult(int r, int c, char result, BasicPlayer& opponent) {
     (void)opponent; // Opponent object not directly used here.
 
-    if (r < 0 || r >= BOARD_SIZE_CONST || c < 0 || c >= BOARD_SIZE_CONST) {
+    if (r < 0 || r >= N || c < 0 || c >= N) {
         return false;
     }
-    if (trackingBoard[r][c] != HIDDEN_CHAR) {
+    int bit = Board::cellIndex(r, c);
+    if (trackHitMask.test(bit) || trackMissMask.test(bit)) {
         return false; // Already targeted this cell
     }
 
     if (result == HIT_CHAR) {
-        trackingBoard[r][c] = HIT_CHAR;
+        trackHitMask.set(bit);
     }
     else if (result == MISS_CHAR) {
-        trackingBoard[r][c] = MISS_CHAR;
+        trackMissMask.set(bit);
     }
     else if (result == 'S') { // 'S' for SUNK (from game logic)
-        trackingBoard[r][c] = HIT_CHAR; // Mark as hit, UI might color differently for SUNK
+        trackHitMask.set(bit); // Mark as hit, UI might color differently for SUNK
     }
     else {
         return false; // Unknown result
@@ -150,73 +299,140 @@ bool Player::processAttackResult(int r, int c, char result, Player& opponent) {
     return true;
 }
 
-bool Player::isDefeated() const {
-    if (ships.empty()) return true; // No ships = defeated by default in a game context
-    for (const auto& ship : ships) {
-        if (!ship.isSunk()) {
-            return false;
-        }
-    }
-    return true;
+template <int N>
+bool BasicPlayer<N>::isDefeated() const {
+    if (shipCount == 0) return true; // No ships = defeated by default in a game context
+    return ownShipMask.isSubsetOf(ownHitMask); // Every ship cell has been hit
 }
 
-void Player::resetPlayer() {
+template <int N>
+void BasicPlayer<N>::resetPlayer() {
     initializeBoards();
-    // Create new Ship objects from the name/size data stored in the current Ship objects.
-    // This effectively resets them to unplaced state.
-    std::vector<Ship> freshShips;
-    freshShips.reserve(ships.size());
-    for (const auto& existingShipDefinition : ships) {
-        freshShips.emplace_back(existingShipDefinition.getName(), existingShipDefinition.getSize());
+    for (int i = 0; i < shipCount; ++i) ships[i].clearCells(); // Unplaced and unhit, same name and size
+}
+
+template <int N>
+bool BasicPlayer<N>::restoreOwnShots(const uint32_t* shipHitMasks, const Board& misses) {
+    if (misses.intersects(ownShipMask)) return false;
+    ownHitMask.clear();
+    for (int i = 0; i < shipCount; ++i) {
+        if (!ships[i].restoreHits(shipHitMasks[i])) return false;
+        for (uint32_t hits = shipHitMasks[i]; hits; hits &= hits - 1) {
+            CellCoordinate cell = ships[i].getCell(countTrailingZeros64(hits));
+            ownHitMask.set(Board::cellIndex(cell.row, cell.col));
+        }
     }
-    ships = freshShips;
+    ownMissMask = misses;
+    return true;
 }
 
-std::string Player::getOwnBoardAsString() const {
+template <int N>
+std::string BasicPlayer<N>::getOwnBoardAsString() const {
     std::string s = "";
-    s.reserve(BOARD_SIZE_CONST * BOARD_SIZE_CONST);
-    for (int i = 0; i < BOARD_SIZE_CONST; ++i) {
-        for (int j = 0; j < BOARD_SIZE_CONST; ++j) {
-            s += ownBoard[i][j];
+    s.reserve(CELL_COUNT);
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            s += getOwnBoardCell(i, j);
         }
     }
     return s;
 }
 
-std::string Player::getTrackingBoardAsString() const {
+template <int N>
+std::string BasicPlayer<N>::getTrackingBoardAsString() const {
     std::string s = "";
-    s.reserve(BOARD_SIZE_CONST * BOARD_SIZE_CONST);
-    for (int i = 0; i < BOARD_SIZE_CONST; ++i) {
-        for (int j = 0; j < BOARD_SIZE_CONST; ++j) {
-            s += trackingBoard[i][j];
+    s.reserve(CELL_COUNT);
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            s += getTrackingBoardCell(i, j);
         }
     }
     return s;
 }
 
 // Used by Client to update its own board display based on data from Host
-void Player::setOwnBoardFromString(const std::string& boardStr) {
-    if (boardStr.length() == BOARD_SIZE_CONST * BOARD_SIZE_CONST) {
-        int k = 0;
-        for (int i = 0; i < BOARD_SIZE_CONST; ++i) {
-            for (int j = 0; j < BOARD_SIZE_CONST; ++j) {
-                char receivedCellState = boardStr[k++];
-                // If the cell on server shows hit but was a ship part, update local ship objects.
-                // This is a simplified update; a full sync would involve updating Ship objects' hit status.
-                if (ownBoard[i][j] == SHIP_CHAR && receivedCellState == HIT_CHAR) {
-                    for (auto& ship : ships) {
-                        ship.attemptHit(i, j); // Try to mark this part of ship as hit
-                    }
-                }
-                ownBoard[i][j] = receivedCellState;
-            }
+template <int N>
+void BasicPlayer<N>::setOwnBoardFromString(const std::string& boardStr) {
+    if (boardStr.length() == CELL_COUNT) {
+        for (int bit = 0; bit < CELL_COUNT; ++bit) setOwnCell(bit, boardStr[bit]);
+    }
+}
+
+template <int N>
+void BasicPlayer<N>::setTrackingBoardFromString(const std::string& boardStr) {
+    if (boardStr.length() == CELL_COUNT) {
+        trackHitMask.clear(); trackMissMask.clear();
+        for (int bit = 0; bit < CELL_COUNT; ++bit) {
+            if (boardStr[bit] == HIT_CHAR) trackHitMask.set(bit);
+            else if (boardStr[bit] == MISS_CHAR) trackMissMask.set(bit);
         }
     }
 }
 
 // May not be strictly needed if client redraws tracking board fully from host's ownBoardString
-void Player::setTrackingBoardCell(int r, int c, char val) {
-    if (r >= 0 && r < BOARD_SIZE_CONST && c >= 0 && c < BOARD_SIZE_CONST) {
-        trackingBoard[r][c] = val;
+template <int N>
+void BasicPlayer<N>::setTrackingBoardCell(int r, int c, char val) {
+    if (r >= 0 && r < N && c >= 0 && c < N) {
+        int bit = Board::cellIndex(r, c);
+        trackHitMask.reset(bit); trackMissMask.reset(bit); // HIDDEN_CHAR (or anything else) clears the cell
+        if (val == HIT_CHAR) trackHitMask.set(bit);
+        else if (val == MISS_CHAR) trackMissMask.set(bit);
+    }
+}
+
+template <int N>
+BoardSyncResult BasicPlayer<N>::applyBoardDelta(const BoardCellDelta& delta) {
+    if (delta.seq <= syncSeq) return BoardSyncResult::DUPLICATE;
+    if (delta.seq != syncSeq + 1) return BoardSyncResult::GAP;
+    if (delta.cell < 0 || delta.cell >= CELL_COUNT) return BoardSyncResult::INVALID;
+    if (delta.tracking) {
+        if (delta.state != HIT_CHAR && delta.state != MISS_CHAR && delta.state != HIDDEN_CHAR) return BoardSyncResult::INVALID;
+        trackHitMask.reset(delta.cell); trackMissMask.reset(delta.cell);
+        if (delta.state == HIT_CHAR) trackHitMask.set(delta.cell);
+        else if (delta.state == MISS_CHAR) trackMissMask.set(delta.cell);
+    }
+    else {
+        if (delta.state != WATER_CHAR && delta.state != SHIP_CHAR && delta.state != HIT_CHAR && delta.state != MISS_CHAR) return BoardSyncResult::INVALID;
+        int placed = shipIndexAt[delta.cell];
+        bool shipCell = delta.state == SHIP_CHAR || delta.state == HIT_CHAR;
+        if (hasPlacedShip(placed) && !shipCell) return BoardSyncResult::INVALID; // A placed ship's cells stay ship cells
+        if (delta.shipIndex != NO_SHIP_INDEX) {
+            // The named ship must fit the fleet, cover the cell, and not be placed on other cells here
+            if (delta.shipIndex < 0 || delta.shipIndex >= MAX_FLEET_SIZE || !shipCell) return BoardSyncResult::INVALID;
+            if (placed != NO_SHIP_INDEX ? delta.shipIndex != placed : hasPlacedShip(delta.shipIndex)) return BoardSyncResult::INVALID;
+        }
+        setOwnCell(delta.cell, delta.state);
+        if (delta.shipIndex != NO_SHIP_INDEX) shipIndexAt[delta.cell] = static_cast<signed char>(delta.shipIndex);
     }
-}
\ No newline at end of file
+    syncSeq = delta.seq;
+    return BoardSyncResult::APPLIED;
+}
+
+// Sets one own-board cell (WATER_CHAR, SHIP_CHAR, HIT_CHAR or MISS_CHAR; anything else is water).
+// A ship placed on the cell gains or loses the matching hit bit, and its cells cannot turn to water
+// or a miss. A client mirroring the host's board has no ships placed: only the masks change, and a
+// ship index a delta recorded for the cell is dropped when the cell stops being a ship cell.
+template <int N>
+void BasicPlayer<N>::setOwnCell(int bit, char state) {
+    int shipIndex = shipIndexAt[bit];
+    bool shipCell = state == SHIP_CHAR || state == HIT_CHAR;
+    if (hasPlacedShip(shipIndex)) {
+        if (!shipCell) return;
+        Ship& ship = ships[shipIndex];
+        CellCoordinate first = ship.getCell(0);
+        uint32_t partBit = 1u << (ship.isHorizontal() ? bit % N - first.col : bit / N - first.row);
+        ship.restoreHits(state == HIT_CHAR ? ship.getHitMask() | partBit : ship.getHitMask() & ~partBit);
+    }
+    else if (!shipCell) shipIndexAt[bit] = NO_SHIP_INDEX;
+    ownHitMask.reset(bit); ownMissMask.reset(bit);
+    if (state == HIT_CHAR) { ownShipMask.set(bit); ownHitMask.set(bit); }
+    else if (state == SHIP_CHAR) ownShipMask.set(bit);
+    else if (state == MISS_CHAR) { ownShipMask.reset(bit); ownMissMask.set(bit); }
+    else ownShipMask.reset(bit); // WATER_CHAR
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template class BasicPlayer<10>;
+template class BasicPlayer<15>;
+template class BasicPlayer<20>;
+template class BasicPlayer<32>;
@@ -2,7 +2,7 @@
 #pragma once
 
 // --- GAME CONSTANTS ---
-const int BOARD_SIZE_CONST = 10;
+const int BOARD_SIZE_CONST = 10; // Board size of the classic game (and of the Form1 grids)
 const char WATER_CHAR = '~';
 const char SHIP_CHAR = 'S';
 const char HIT_CHAR = 'X';
@@ -11,44 +11,133 @@ const char HIDDEN_CHAR = '?';
 // --- END GAME CONSTANTS ---
 
 #include <string>
-#include <vector>
+#include "BitBoard.h"
+#include "GameRandom.h"
 #include "Ship.h" // Ship.h is included after constants are defined
 
-class Player {
+const int NO_SHIP_INDEX = -1;
+const int MAX_FLEET_SIZE = 16; // Ships per player; the fleet is stored inline
+
+enum class AttackOutcome { INVALID, ALREADY_TARGETED, MISS, HIT, SUNK };
+
+// Outcome of an attack on this player's own board. shipIndex is the index for
+// getShip() for HIT/SUNK (and for ALREADY_TARGETED on a ship cell), NO_SHIP_INDEX otherwise.
+struct AttackResult {
+    AttackOutcome outcome;
+    int shipIndex;
+    bool isHit() const { return outcome == AttackOutcome::HIT || outcome == AttackOutcome::SUNK; }
+};
+
+// One changed cell of a player's boards, numbered so that a receiver mirroring them (a network
+// client) notices when one went missing. Each delta's seq is one more than the previous one's.
+struct BoardCellDelta {
+    unsigned int seq = 0;
+    int cell = 0;          // r * N + c
+    char state = HIT_CHAR; // Own board: WATER_CHAR, SHIP_CHAR, HIT_CHAR or MISS_CHAR; tracking board: HIDDEN_CHAR, HIT_CHAR or MISS_CHAR
+    int shipIndex = NO_SHIP_INDEX; // Ship at the cell if the sender names one (own board), the sunk ship (tracking), or NO_SHIP_INDEX
+    bool tracking = false; // Cell of the tracking board rather than the own board
+};
+
+// What applyBoardDelta did with a delta. On GAP nothing was applied and the boards have to be
+// sent again in full (setOwnBoardFromString / setTrackingBoardFromString, then setSyncSeq).
+enum class BoardSyncResult { APPLIED, DUPLICATE, GAP, INVALID };
+
+// A player on an N x N board. The supported sizes (10, 15, 20, 32) are explicitly
+// instantiated in Player.cpp; 'Player' is the classic 10x10 board.
+template <int N>
+class BasicPlayer {
+public:
+    static constexpr int BOARD_SIZE = N;
+    static constexpr int CELL_COUNT = N * N;
+    typedef BitBoard<N> Board;
+
 protected:
     std::string playerName;
-    char ownBoard[BOARD_SIZE_CONST][BOARD_SIZE_CONST];
-    char trackingBoard[BOARD_SIZE_CONST][BOARD_SIZE_CONST]; // Used by Host to track attacks on Client
-    // Client does not use its own trackingBoard logic;
-    // its tracking display is built from Host's ownBoard data.
-    std::vector<Ship> ships;
+    // Own board: cells covered by ships, ship cells hit by the opponent, water cells shot by the opponent.
+    Board ownShipMask;
+    Board ownHitMask;
+    Board ownMissMask;
+    // Tracking board: used by Host to track attacks on Client.
+    // Client does not use its own tracking board logic;
+    // its tracking display is built from Host's own board data.
+    Board trackHitMask;
+    Board trackMissMask;
+    Ship ships[MAX_FLEET_SIZE];
+    int shipCount = 0;
+    signed char shipIndexAt[CELL_COUNT]; // Cell -> index into 'ships', NO_SHIP_INDEX for water
+    unsigned int syncSeq = 0; // seq of the last BoardCellDelta applied (or of the full boards last set)
 
 public:
-    Player(const std::string& name = "Player");
-    virtual ~Player() = default;
+    BasicPlayer(const std::string& name = "Player");
+    virtual ~BasicPlayer() = default;
 
     const std::string& getName() const;
     void setName(const std::string& name);
 
     void initializeBoards();
-    void addShipDefinition(const std::string& name, int size);
+    bool addShipDefinition(int typeId); // A ship of SHIP_TYPES[typeId]; false for an unknown type or once the fleet holds MAX_FLEET_SIZE ships
+    void clearShipDefinitions();
     bool placeShip(int shipIndex, int r, int c, bool isHorizontal);
-    void placeShipsRandomly();
+    void clearShipCells(int shipIndex); // Unplaces a ship, removing it from the board and the cell index
+    // Places every ship, choosing uniformly among the legal placements left for each one in turn and
+    // backtracking out of dead ends, so it succeeds whenever the fleet fits. False if it cannot fit.
+    bool placeShipsRandomly(GameRandom& rng);
 
     char getOwnBoardCell(int r, int c) const;
     char getTrackingBoardCell(int r, int c) const; // Primarily for Host
-    const char (*getOwnBoardCells() const)[BOARD_SIZE_CONST] { return ownBoard; }
 
-    const std::vector<Ship>& getAllShips() const;
+    // Mask views of the boards; the char accessors above are derived from these.
+    const Board& getOwnShipMask() const { return ownShipMask; }
+    const Board& getOwnHitMask() const { return ownHitMask; }
+    const Board& getOwnMissMask() const { return ownMissMask; }
+    Board getOwnShotMask() const { return ownHitMask | ownMissMask; }
+    const Board& getTrackingHitMask() const { return trackHitMask; }
+    const Board& getTrackingMissMask() const { return trackMissMask; }
+    Board getTrackingShotMask() const { return trackHitMask | trackMissMask; }
+
+    int getShipCount() const { return shipCount; }
+    const Ship& getShip(int shipIndex) const { return ships[shipIndex]; } // shipIndex in [0, getShipCount())
+    int getShipIndexAt(int r, int c) const; // NO_SHIP_INDEX if no ship covers the cell
 
-    char receiveAttack(int r, int c); // Updates ownBoard based on attack
-    bool processAttackResult(int r, int c, char result, Player& opponent); // Updates trackingBoard
+    AttackResult receiveAttack(int r, int c); // Updates own board and the hit ship based on attack
+    bool processAttackResult(int r, int c, char result, BasicPlayer& opponent); // Updates trackingBoard
+    // Chooses the next cell to attack. Human players pick through the UI, so the base returns false.
+    virtual bool makeStrategicMove(BasicPlayer& opponent, GameRandom& rng, int& outRow, int& outCol) { (void)opponent; (void)rng; (void)outRow; (void)outCol; return false; }
+    // Called on the attacker after its shot at (r, c) sank the opponent's ship 'shipIndex'.
+    virtual void onOpponentShipSunk(int r, int c, int shipIndex, int shipSize) { (void)r; (void)c; (void)shipIndex; (void)shipSize; }
     bool isDefeated() const;
-    void resetPlayer(); // Resets boards and ships (re-creates ship objects for new placement)
+    void resetPlayer(); // Resets boards and unplaces every ship, keeping the fleet definition
+    // Sets the shots on the own board directly (a restored snapshot): per-ship hit masks
+    // (see Ship::getHitMask) and the water cells shot. Every ship must already be placed;
+    // false if a mask does not fit its ship or a miss lands on a ship.
+    bool restoreOwnShots(const uint32_t* shipHitMasks, const Board& misses);
+    void restoreTrackingBoard(const Board& hits, const Board& misses) { trackHitMask = hits; trackMissMask = misses; }
 
     // Serialization/Deserialization methods
     std::string getOwnBoardAsString() const;
     std::string getTrackingBoardAsString() const; // Host might send this if client needed to reconstruct it
-    void setOwnBoardFromString(const std::string& boardStr); // Client uses this to reflect server state
+    void setOwnBoardFromString(const std::string& boardStr); // Client uses this to reflect server state; placed ships' cells ignore water and misses
+    void setTrackingBoardFromString(const std::string& boardStr); // HIT_CHAR / MISS_CHAR cells; anything else is unexplored (e.g. an opponent's own board)
     void setTrackingBoardCell(int r, int c, char val); // Potentially for client to update its view, but direct redraw from string is simpler
-};
\ No newline at end of file
+
+    // Incremental sync: applies one changed cell in O(1), keeping placed ships' hit bits in step.
+    // A delta at or below getSyncSeq() is a DUPLICATE and ignored; one further ahead than the
+    // next is a GAP and not applied. INVALID if the cell or state is out of range, if it would
+    // turn a placed ship's cell to water or a miss, or if shipIndex names a ship that cannot be
+    // on the cell (another ship's cell, a ship placed elsewhere, or a water or miss state).
+    // Otherwise a named ship is recorded for the cell, and getShipIndexAt reports it.
+    BoardSyncResult applyBoardDelta(const BoardCellDelta& delta);
+    unsigned int getSyncSeq() const { return syncSeq; }
+    void setSyncSeq(unsigned int seq) { syncSeq = seq; } // After setting the full boards of that seq
+
+private:
+    // placeShipsRandomly for ships[index..] given the free cells of each row (bit c = column c).
+    // knownFailures (2 * N rows: horizontal starts, then vertical) are placements already shown
+    // not to complete the fleet for an earlier ship of the same size, or null. 'prune' enables the
+    // dead-end checks, which only pay off once the search has had to backtrack.
+    bool placeShipsFrom(size_t index, const uint64_t* freeRows, const uint64_t* knownFailures, bool prune, GameRandom& rng);
+    void setOwnCell(int bit, char state); // Own-board cell and the hit bit of the ship placed there
+    bool hasPlacedShip(int shipIndex) const { return shipIndex >= 0 && shipIndex < shipCount && ships[shipIndex].isPlaced(); }
+};
+
+typedef BasicPlayer<BOARD_SIZE_CONST> Player;
@@ -0,0 +1,124 @@
+// Protocol.cpp
+#include "Protocol.h"
+
+namespace {
+    const std::string_view NO_WINNER = "N/A";
+
+    void AddGameUpdateFields(MessageBuilder& out, const GameUpdate& update) {
+        out.Add(update.turnId).Add(update.player1Board).Add(update.player2Board).AddEscaped(update.action).AddBool(update.gameOver);
+        if (update.winner.empty()) out.Add(NO_WINNER);
+        else out.AddEscaped(update.winner);
+    }
+
+    bool ParseBool(std::string_view field, bool& out) {
+        if (field == "True" || field == "true") out = true;
+        else if (field == "False" || field == "false") out = false;
+        else return false;
+        return true;
+    }
+}
+
+int WireTurnId(GameTurn turn, int receiverPlayerId) {
+    switch (turn) {
+    case GameTurn::PLAYER1: case GameTurn::GAME_OVER_P1_WINS: return WirePlayerId(1, receiverPlayerId);
+    case GameTurn::PLAYER2: case GameTurn::GAME_OVER_P2_WINS: return WirePlayerId(2, receiverPlayerId);
+    default: return 0;
+    }
+}
+
+GameDelta MakeGameDelta(const AttackEvent& attack, unsigned int seq, int receiverPlayerId) {
+    GameDelta delta;
+    delta.seq = seq;
+    delta.attackerId = WirePlayerId(attack.attackerId, receiverPlayerId);
+    delta.row = attack.row;
+    delta.col = attack.col;
+    delta.result = (attack.outcome == AttackOutcome::SUNK) ? SUNK_RESULT_CHAR : (attack.outcome == AttackOutcome::HIT) ? HIT_CHAR : MISS_CHAR;
+    delta.sunkShipIndex = attack.sunkShipIndex;
+    delta.nextTurnId = WireTurnId(attack.nextTurn, receiverPlayerId);
+    delta.gameOver = attack.gameOver;
+    return delta;
+}
+
+BoardCellDelta MakeBoardCellDelta(const GameDelta& delta, int boardSize) {
+    BoardCellDelta cell;
+    cell.seq = delta.seq;
+    cell.cell = delta.row * boardSize + delta.col;
+    cell.state = (delta.result == MISS_CHAR) ? MISS_CHAR : HIT_CHAR;
+    cell.shipIndex = (delta.result == SUNK_RESULT_CHAR) ? delta.sunkShipIndex : NO_SHIP_INDEX;
+    cell.tracking = (delta.attackerId == 2);
+    if (delta.row < 0 || delta.row >= boardSize || delta.col < 0 || delta.col >= boardSize) cell.cell = -1; // Rejected by applyBoardDelta
+    return cell;
+}
+
+// GAME_DELTA <seq> <attacker> <r> <c> <result> <sunk ship> <next turn> <game over>
+void BuildGameDelta(MessageBuilder& out, const GameDelta& delta) {
+    out.Begin(MessageType::GAME_DELTA).Add(delta.seq).Add(delta.attackerId).Add(delta.row).Add(delta.col).Add(delta.result)
+        .Add(delta.sunkShipIndex).Add(delta.nextTurnId).Add(delta.gameOver ? 1 : 0);
+}
+
+bool ParseGameDelta(const ProtocolMessage& message, GameDelta& out) {
+    unsigned int seq = 0;
+    int attacker = 0, r = 0, c = 0, sunk = 0, next = 0, over = 0;
+    if (message.type != MessageType::GAME_DELTA || message.fieldCount != 9) return false;
+    std::string_view result = message.fields[5];
+    if (!ParseField(message.fields[1], seq) || !ParseField(message.fields[2], attacker) || !ParseField(message.fields[3], r)
+        || !ParseField(message.fields[4], c) || result.size() != 1 || !ParseField(message.fields[6], sunk)
+        || !ParseField(message.fields[7], next) || !ParseField(message.fields[8], over)) return false;
+    if ((attacker != 1 && attacker != 2) || next < 0 || next > 2 || (over != 0 && over != 1)) return false;
+    if (result[0] != MISS_CHAR && result[0] != HIT_CHAR && result[0] != SUNK_RESULT_CHAR) return false;
+    if (result[0] == SUNK_RESULT_CHAR && (sunk < 0 || sunk >= DEFAULT_FLEET_COUNT)) return false;
+    out.seq = seq;
+    out.attackerId = attacker;
+    out.row = r;
+    out.col = c;
+    out.result = result[0];
+    out.sunkShipIndex = (result[0] == SUNK_RESULT_CHAR) ? sunk : NO_SHIP_INDEX;
+    out.nextTurnId = next;
+    out.gameOver = (over == 1);
+    return true;
+}
+
+void BuildGameUpdate(MessageBuilder& out, const GameUpdate& update) {
+    out.Begin(MessageType::GAME_UPDATE);
+    AddGameUpdateFields(out, update);
+}
+
+void BuildGameSnapshot(MessageBuilder& out, const GameUpdate& update) {
+    out.Begin(MessageType::GAME_SNAPSHOT).Add(update.seq);
+    AddGameUpdateFields(out, update);
+}
+
+// A winner with spaces in it (from an older host that did not escape it) spans the remaining fields.
+bool ParseGameUpdate(const ProtocolMessage& message, GameUpdate& out) {
+    int first = (message.type == MessageType::GAME_SNAPSHOT) ? 2 : 1; // The turn id's field
+    if ((message.type != MessageType::GAME_UPDATE && first == 1) || message.fieldCount < first + 5) return false;
+    GameUpdate update;
+    if (first == 2 && !ParseField(message.fields[1], update.seq)) return false;
+    if (!ParseField(message.fields[first], update.turnId) || !ParseBool(message.fields[first + 4], update.gameOver)) return false;
+    update.player1Board = message.fields[first + 1];
+    update.player2Board = message.fields[first + 2];
+    if (update.player1Board.empty() || update.player1Board.size() != update.player2Board.size()) return false;
+    update.action = message.fields[first + 3];
+    update.winner = message.GetRest(first + 5);
+    if (update.winner == NO_WINNER) update.winner = std::string_view();
+    out = update;
+    return true;
+}
+
+// Mirrors FormatAttackEvent word for word, player 2 being the receiver, without linking the game
+// logic (the load generator only needs Protocol.cpp).
+std::string FormatGameDeltaMessage(const GameDelta& delta, const std::string& receiverName, const std::string& opponentName) {
+    const std::string& attacker = (delta.attackerId == 2) ? receiverName : opponentName;
+    std::string message = attacker + " attacked (" + std::to_string(delta.row) + "," + std::to_string(delta.col) + "): ";
+    if (delta.result == SUNK_RESULT_CHAR) {
+        message += "SUNK!";
+        message += (delta.attackerId == 2) ? " Sunk your " : " Sunk their ";
+        message += (delta.sunkShipIndex >= 0 && delta.sunkShipIndex < DEFAULT_FLEET_COUNT) ? SHIP_TYPES[DEFAULT_FLEET[delta.sunkShipIndex]].name : "ship";
+        message += "!";
+    }
+    else message += (delta.result == HIT_CHAR) ? "HIT!" : "MISS!";
+    const std::string& next = (delta.nextTurnId == 2) ? receiverName : opponentName;
+    if (delta.gameOver) message += " " + next + " wins!";
+    else message += " Now " + next + "'s turn.";
+    return message;
+}
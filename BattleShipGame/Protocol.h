@@ -0,0 +1,87 @@
+// Protocol.h
+#pragma once
+#include "BattleShipGame.h"
+#include "MessageCodec.h"
+#include <string>
+
+// Line protocol versions.
+// v1 is the original text protocol: every move is answered with a GAME_UPDATE carrying both full boards.
+// v2 keeps the v1 handshake and adds:
+//   GAME_SNAPSHOT <seq> <GAME_UPDATE fields>  - full state; sent when the game starts, after a rejected
+//                                               move, and in reply to RESYNC
+//   GAME_DELTA <seq> <attacker> <r> <c> <result> <sunk ship> <next turn> <game over>
+//                                             - one accepted shot; seq is one more than the previous message
+//   RESYNC                                    - client -> host, sent when it sees a gap in seq
+// A client asks for v2 with "PROTOCOL 2" before CONNECT_REQUEST and a v2 host answers "PROTOCOL_OK 2".
+// Hosts that predate v2 ignore the unknown command, so the client simply keeps receiving GAME_UPDATE.
+const int PROTOCOL_V1 = 1;
+const int PROTOCOL_V2 = 2;
+
+// "RATING <r>" before CONNECT_REQUEST tells a matchmaking host (battleship-server) the player's
+// rating, so it can pair players of similar strength. Form1 hosts ignore it; players who never
+// send it are rated DEFAULT_RATING.
+const int DEFAULT_RATING = 1500;
+
+// "SPECTATE [session]" instead of CONNECT_REQUEST asks battleship-server to watch a game. Each game
+// watched starts with "WELCOME <player 1> <player 2> 0", then the v2 messages player 2 would get,
+// with both fleets hidden (so player 1 is wire player 1); a spectator that cannot keep up is sent
+// WELCOME and a GAME_SNAPSHOT again in place of the messages it missed. Without a session id (or
+// with 0) the spectator follows the games of its connection's reactor thread, newest first, moving
+// on to the next one paired when a game ends; with an id it watches that game and gets DISCONNECT
+// when it ends.
+
+// A battleship-server that keeps a session store sends each player "SESSION <slot> <generation>
+// <token>" when its game starts; the token is a 64-bit number drawn from the OS's secure random
+// source, so one seat's token says nothing about the other's. If the connection drops because the server went down, the client
+// can connect again once it is back and send "RESUME <slot> <generation> <token>" (after PROTOCOL,
+// instead of CONNECT_REQUEST): it gets WELCOME and the game as it stood, and plays on. A RESUME the
+// server cannot honour is answered with DISCONNECT; with several reactor threads that includes one
+// that reached a thread other than the game's, so a client tries a few connections before giving up.
+
+const char SUNK_RESULT_CHAR = 'S'; // GAME_DELTA result for a hit that sank a ship
+
+// One accepted shot as seen by the peer receiving it. Player ids are wire ids, as in GAME_UPDATE:
+// the receiver is always player 2 and its opponent player 1.
+struct GameDelta {
+    unsigned int seq = 0;
+    int attackerId = 0;
+    int row = -1;
+    int col = -1;
+    char result = MISS_CHAR; // MISS_CHAR, HIT_CHAR or SUNK_RESULT_CHAR
+    int sunkShipIndex = NO_SHIP_INDEX; // Index into DEFAULT_FLEET when result is SUNK_RESULT_CHAR
+    int nextTurnId = 0; // Player to move next; the winner once gameOver is set
+    bool gameOver = false;
+};
+
+// The fields of a GAME_UPDATE (and of a GAME_SNAPSHOT, which adds seq) as the client receiving it
+// sees them. Player ids are wire ids and the receiver is player 2, so player1Board is the host's
+// (or opponent's) board and player2Board the receiver's own. Action and winner are plain text;
+// ParseGameUpdate leaves them escaped, as views into the line (see UnescapeSpaces).
+struct GameUpdate {
+    unsigned int seq = 0; // GAME_SNAPSHOT only
+    int turnId = 0; // Player to move; the winner once gameOver is set
+    std::string_view player1Board; // One char per cell, row by row
+    std::string_view player2Board;
+    std::string_view action;
+    bool gameOver = false;
+    std::string_view winner; // Empty until the game is over; sent as "N/A"
+};
+
+// Wire id of a logic player id (1 or 2) for the peer that plays 'receiverPlayerId'.
+inline int WirePlayerId(int playerId, int receiverPlayerId) { return playerId == receiverPlayerId ? 2 : 1; }
+int WireTurnId(GameTurn turn, int receiverPlayerId); // 0 for SETUP
+
+GameDelta MakeGameDelta(const AttackEvent& attack, unsigned int seq, int receiverPlayerId);
+void BuildGameDelta(MessageBuilder& out, const GameDelta& delta);
+bool ParseGameDelta(const ProtocolMessage& message, GameDelta& out);
+// GAME_UPDATE <turn id> <player 1 board> <player 2 board> <action> <game over> <winner>
+void BuildGameUpdate(MessageBuilder& out, const GameUpdate& update);
+// GAME_SNAPSHOT <seq> <GAME_UPDATE fields>
+void BuildGameSnapshot(MessageBuilder& out, const GameUpdate& update);
+bool ParseGameUpdate(const ProtocolMessage& message, GameUpdate& out); // GAME_UPDATE or GAME_SNAPSHOT
+// The cell the shot changed on the receiver's boards: its tracking board for its own shot, its own
+// board otherwise. Feed it to Player::applyBoardDelta on the receiver's mirror of the game.
+BoardCellDelta MakeBoardCellDelta(const GameDelta& delta, int boardSize);
+// The status line the host would have sent in a GAME_UPDATE for this shot, word for word, with the
+// receiver as player 2 (so "Sunk your" when the receiver made the sinking shot, as the host words it).
+std::string FormatGameDeltaMessage(const GameDelta& delta, const std::string& receiverName, const std::string& opponentName);
@@ -1,57 +1,58 @@
 // Ship.cpp
-#include "Ship.h" 
+#include "Ship.h"
 
-Ship::Ship(const std::string& shipName, int s) : name(shipName), size(s), hitsTaken(0) {
-    // Cells vector is initially empty.
+Ship::Ship(int type) : typeId(NO_SHIP_TYPE), row(0), col(0), cellCount(0), horizontal(true), hitMask(0) {
+    if (type > NO_SHIP_TYPE && type < SHIP_TYPE_COUNT) typeId = static_cast<uint8_t>(type);
 }
 
-const std::string& Ship::getName() const {
-    return this->name;
+CellCoordinate Ship::getCell(int k) const {
+    return horizontal ? CellCoordinate{ row, col + k } : CellCoordinate{ row + k, col };
 }
 
-int Ship::getSize() const {
-    return this->size;
-}
-
-const std::vector<CellCoordinate>& Ship::getCells() const {
-    return this->cells;
-}
-
-void Ship::addCellPos(int row, int col) {
+void Ship::place(int r, int c, bool isHorizontal) {
     // Called during initial ship placement by Player::placeShip
-    if (static_cast<int>(cells.size()) < this->size) {
-        cells.emplace_back(row, col); // New CellCoordinate will have isHit = false
-    }
+    row = static_cast<uint8_t>(r);
+    col = static_cast<uint8_t>(c);
+    horizontal = isHorizontal;
+    cellCount = static_cast<uint8_t>(getSize());
+    hitMask = 0;
 }
 
 bool Ship::attemptHit(int r, int c) {
     if (this->isSunk()) {
         return false;
     }
-    for (auto& cell : cells) {
-        if (cell.row == r && cell.col == c) {
-            if (!cell.isHit) {
-                cell.isHit = true;
-                this->hitsTaken++;
-                return true;
-            }
-            return false; // Already hit this part
-        }
+    int k = horizontal ? c - col : r - row;
+    if ((horizontal ? r != row : c != col) || k < 0 || k >= cellCount) {
+        return false; // Not part of this ship
     }
-    return false; // Not part of this ship
+    uint32_t bit = 1u << k;
+    if (hitMask & bit) {
+        return false; // Already hit this part
+    }
+    hitMask |= bit;
+    return true;
+}
+
+bool Ship::restoreHits(uint32_t mask) {
+    uint32_t cells = cellCount >= 32 ? ~0u : ((1u << cellCount) - 1);
+    if (!isPlaced() || (mask & ~cells)) return false;
+    hitMask = mask;
+    return true;
 }
 
 bool Ship::isSunk() const {
-    if (this->size <= 0) return true;
-    return (this->hitsTaken >= this->size);
+    int size = getSize();
+    if (size <= 0) return true;
+    return cellCount == size && hitMask == (size >= 32 ? ~0u : ((1u << size) - 1));
 }
 
 void Ship::clearCells() {
-    cells.clear();
-    hitsTaken = 0;
+    cellCount = 0;
+    hitMask = 0;
 }
 
 // reset() now makes the ship "unplaced" and "unhit", ready for Player::placeShip.
 void Ship::reset() {
     clearCells();
-}
\ No newline at end of file
+}
@@ -1,33 +1,52 @@
 // Ship.h
 #pragma once
-#include <string>
-#include <vector>
+#include <cstdint>
 
 // Constants are visible because Player.h (which defines them) includes Ship.h
 
+const int MAX_SHIP_LENGTH = 32; // Longest ship; bounded by the 32-bit hit mask (and the largest board)
+
+// The kinds of ship there are. A Ship holds the id of its type, which names it and gives its size,
+// so names are never copied per ship. The table is constant, so every thread shares it as it is.
+enum ShipTypeId : uint8_t { NO_SHIP_TYPE, CARRIER, BATTLESHIP, CRUISER, SUBMARINE, DESTROYER };
+struct ShipType { const char* name; int size; };
+const ShipType SHIP_TYPES[] = { // By ShipTypeId
+    {"", 0}, {"Carrier", 5}, {"Battleship", 4}, {"Cruiser", 3}, {"Submarine", 3}, {"Destroyer", 2}
+};
+const int SHIP_TYPE_COUNT = sizeof(SHIP_TYPES) / sizeof(SHIP_TYPES[0]);
+
 struct CellCoordinate {
     int row;
     int col;
-    bool isHit;
-    CellCoordinate(int r, int c) : row(r), col(c), isHit(false) {}
 };
 
+// One ship, stored inline: its type, its placement as a start cell plus orientation, and one hit
+// bit per cell (bit k = k-th cell from the start). No heap allocation, so a fleet of ships can be
+// reset and re-placed every game without touching the allocator.
 class Ship {
 private:
-    std::string name;
-    int size;
-    std::vector<CellCoordinate> cells;
-    int hitsTaken;
+    uint8_t typeId;     // Index into SHIP_TYPES
+    uint8_t row;        // First cell, when placed
+    uint8_t col;
+    uint8_t cellCount;  // 0 when unplaced, otherwise 'size'
+    bool horizontal;
+    uint32_t hitMask;
 
 public:
-    Ship(const std::string& name, int s);
-    const std::string& getName() const;
-    int getSize() const;
-    const std::vector<CellCoordinate>& getCells() const; // Useful for checking ship location
+    explicit Ship(int type = NO_SHIP_TYPE); // An id outside SHIP_TYPES makes a NO_SHIP_TYPE ship
+    int getTypeId() const { return typeId; }
+    const char* getName() const { return SHIP_TYPES[typeId].name; }
+    int getSize() const { return SHIP_TYPES[typeId].size; }
+    bool isPlaced() const { return cellCount != 0; }
+    int getCellCount() const { return cellCount; }
+    CellCoordinate getCell(int k) const; // k in [0, getCellCount())
+    bool isHorizontal() const { return horizontal; }
+    uint32_t getHitMask() const { return hitMask; } // Bit k set when getCell(k) has been hit
 
-    void addCellPos(int row, int col);
+    void place(int r, int c, bool isHorizontal); // Called by Player::placeShip once the cells are known to be free
     bool attemptHit(int r, int c); // Returns true if it's a new hit on this ship part
+    bool restoreHits(uint32_t mask); // Sets getHitMask() of a placed ship; false if 'mask' names cells it does not have
     bool isSunk() const;
-    void reset();      // Resets hitsTaken and clears cell positions.
-    void clearCells(); // Specifically clears cell positions and hitsTaken.
-};
\ No newline at end of file
+    void reset();      // Same as clearCells().
+    void clearCells(); // Makes the ship unplaced and unhit.
+};
@@ -0,0 +1,141 @@
+// TargetingEngine.cpp
+#include "TargetingEngine.h"
+
+template <int N>
+BasicTargetingEngine<N>::BasicTargetingEngine() {
+    static_assert(N > 0 && N <= 64, "Rows are processed as 64-bit words");
+    reset();
+}
+
+template <int N>
+void BasicTargetingEngine<N>::reset() {
+    for (int i = 0; i <= N; ++i) remainingBySize[i] = 0;
+    sunkMask.clear();
+}
+
+template <int N>
+void BasicTargetingEngine<N>::addShip(int size) {
+    if (size > 0 && size <= N) remainingBySize[size]++;
+}
+
+template <int N>
+int BasicTargetingEngine<N>::remainingShips() const {
+    int total = 0;
+    for (int i = 1; i <= N; ++i) total += remainingBySize[i];
+    return total;
+}
+
+template <int N>
+void BasicTargetingEngine<N>::onShipSunk(int r, int c, int size, const Board& hits) {
+    if (size <= 0 || size > N || r < 0 || r >= N || c < 0 || c >= N) return;
+    if (remainingBySize[size] > 0) remainingBySize[size]--;
+
+    // Find every line of 'size' unclaimed hits through (r, c); mark it only if there is exactly one.
+    Board open = hits;
+    open.andNot(sunkMask);
+    Board found;
+    int candidates = 0;
+    for (int horizontal = 0; horizontal < 2 && candidates < 2; ++horizontal) {
+        if (size == 1 && horizontal) break; // A single cell has one placement
+        for (int k = 0; k < size && candidates < 2; ++k) {
+            int r0 = horizontal ? r : r - k, c0 = horizontal ? c - k : c;
+            if (r0 < 0 || c0 < 0 || (horizontal ? c0 + size > N : r0 + size > N)) continue;
+            Board line;
+            for (int i = 0; i < size; ++i) line.set(Board::cellIndex(horizontal ? r0 : r0 + i, horizontal ? c0 + i : c0));
+            if (line.isSubsetOf(open)) { found = line; candidates++; }
+        }
+    }
+    if (candidates == 1) sunkMask |= found;
+}
+
+// Adds every legal placement's weight to the cells it covers. Returns false if, in target mode,
+// no remaining ship can cover any open hit (the caller then falls back to hunting).
+template <int N>
+bool BasicTargetingEngine<N>::accumulate(const uint64_t* freeRows, const uint64_t* hitRows, bool targetMode, uint32_t* counts) const {
+    bool any = false;
+    for (int size = 1; size <= N; ++size) {
+        uint32_t ships = static_cast<uint32_t>(remainingBySize[size]);
+        if (ships == 0) continue;
+        uint64_t span = lowBitMask64(size);
+
+        for (int r = 0; r < N; ++r) { // Horizontal placements
+            uint64_t starts = freeRows[r];
+            for (int k = 1; k < size && starts; ++k) starts &= freeRows[r] >> k;
+            while (starts) {
+                int c = countTrailingZeros64(starts);
+                starts &= starts - 1;
+                uint32_t weight = ships;
+                if (targetMode) {
+                    uint32_t covered = static_cast<uint32_t>(popCount64((hitRows[r] >> c) & span));
+                    if (covered == 0) continue;
+                    weight *= covered * covered;
+                }
+                uint32_t* cell = counts + r * N + c;
+                for (int i = 0; i < size; ++i) cell[i] += weight;
+                any = true;
+            }
+        }
+
+        if (size == 1) continue; // Same placements as horizontal
+        for (int r = 0; r + size <= N; ++r) { // Vertical placements starting in row r
+            uint64_t starts = freeRows[r];
+            for (int k = 1; k < size && starts; ++k) starts &= freeRows[r + k];
+            while (starts) {
+                int c = countTrailingZeros64(starts);
+                starts &= starts - 1;
+                uint32_t weight = ships;
+                if (targetMode) {
+                    uint32_t covered = 0;
+                    for (int k = 0; k < size; ++k) covered += static_cast<uint32_t>((hitRows[r + k] >> c) & 1ULL);
+                    if (covered == 0) continue;
+                    weight *= covered * covered;
+                }
+                uint32_t* cell = counts + r * N + c;
+                for (int i = 0; i < size; ++i) cell[i * N] += weight;
+                any = true;
+            }
+        }
+    }
+    return any;
+}
+
+template <int N>
+void BasicTargetingEngine<N>::computeDensity(const Board& hits, const Board& misses, uint32_t* counts) const {
+    uint64_t freeRows[N], hitRows[N];
+    Board blocked = misses | sunkMask;
+    Board open = hits;
+    open.andNot(sunkMask);
+    bool targetMode = false;
+    for (int r = 0; r < N; ++r) {
+        freeRows[r] = ~blocked.extract(r * N, N) & lowBitMask64(N);
+        hitRows[r] = open.extract(r * N, N);
+        targetMode = targetMode || hitRows[r] != 0;
+    }
+    for (int i = 0; i < CELL_COUNT; ++i) counts[i] = 0;
+    if (accumulate(freeRows, hitRows, targetMode, counts) || !targetMode) return;
+    accumulate(freeRows, hitRows, false, counts); // Open hits no remaining ship explains; hunt instead
+}
+
+template <int N>
+bool BasicTargetingEngine<N>::chooseTarget(const Board& hits, const Board& misses, GameRandom& rng, int& outRow, int& outCol) const {
+    uint32_t counts[CELL_COUNT];
+    computeDensity(hits, misses, counts);
+    Board shot = hits | misses;
+    int best = -1, ties = 0;
+    uint32_t bestCount = 0;
+    for (int i = 0; i < CELL_COUNT; ++i) {
+        if (shot.test(i)) continue;
+        if (best < 0 || counts[i] > bestCount) { best = i; bestCount = counts[i]; ties = 1; }
+        else if (counts[i] == bestCount && rng.nextBelow(static_cast<uint32_t>(++ties)) == 0) best = i; // Uniform among equal cells
+    }
+    if (best < 0) return false;
+    outRow = best / N;
+    outCol = best % N;
+    return true;
+}
+
+// Supported board sizes; see BasicPlayer in Player.h.
+template class BasicTargetingEngine<10>;
+template class BasicTargetingEngine<15>;
+template class BasicTargetingEngine<20>;
+template class BasicTargetingEngine<32>;
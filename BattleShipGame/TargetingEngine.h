@@ -0,0 +1,48 @@
+// TargetingEngine.h
+#pragma once
+#include "BitBoard.h"
+#include "GameRandom.h"
+#include <cstdint>
+
+// Probability-density targeting for an N x N board (N <= 64). For every cell it counts how many
+// legal placements of the ships still afloat cover it, given the shots so far, and fires at the
+// cell with the highest count. While there are hits that do not belong to a sunk ship, only
+// placements through those hits are counted (weighted by how many of them they cover), so the
+// engine finishes off a wounded ship before hunting again.
+//
+// Rows are handled as 64-bit words: a row's legal horizontal starts for a ship of length L are
+// the AND of the row's free mask shifted 0..L-1, and the legal vertical starts in row r are the
+// AND of rows r..r+L-1. Instantiated for the supported board sizes in TargetingEngine.cpp.
+template <int N>
+class BasicTargetingEngine {
+public:
+    static constexpr int BOARD_SIZE = N;
+    static constexpr int CELL_COUNT = N * N;
+    typedef BitBoard<N> Board;
+
+    BasicTargetingEngine();
+
+    void reset();                 // Forgets the fleet and any sunk ships
+    void addShip(int size);       // One enemy ship of this length is afloat
+    int remainingShips() const;
+
+    // Records that the shot at (r, c) sank a ship of 'size'. The ship is removed from the fleet, and its
+    // cells are excluded from further targeting when the hits around (r, c) place it unambiguously.
+    void onShipSunk(int r, int c, int size, const Board& hits);
+    const Board& getSunkMask() const { return sunkMask; }
+    void markSunkCells(const Board& cells) { sunkMask |= cells; } // Restores cells onShipSunk had placed
+
+    // Placement counts per cell (row-major) for the given shot history.
+    void computeDensity(const Board& hits, const Board& misses, uint32_t* counts) const;
+
+    // Picks the unshot cell with the highest density (ties broken at random). False when every cell has been shot.
+    bool chooseTarget(const Board& hits, const Board& misses, GameRandom& rng, int& outRow, int& outCol) const;
+
+private:
+    int remainingBySize[N + 1]; // Ships afloat per length
+    Board sunkMask;             // Hit cells known to belong to sunk ships
+
+    bool accumulate(const uint64_t* freeRows, const uint64_t* hitRows, bool targetMode, uint32_t* counts) const;
+};
+
+typedef BasicTargetingEngine<10> TargetingEngine;
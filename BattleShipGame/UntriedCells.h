@@ -0,0 +1,66 @@
+// UntriedCells.h
+#pragma once
+#include "BitBoard.h"
+#include "GameRandom.h"
+#include <cstdint>
+#include <cstring>
+
+// The cells of an N x N board that have not been fired at, for uniform random shots in O(1).
+// A dense bitset answers "already tried?", and a swap-remove array keeps the untried cells in its
+// first count() slots. Both arrays store (value XOR index), so zeroed memory is the untouched
+// board: reset() is a memset, with no per-cell initialization.
+template <int N>
+class UntriedCells {
+public:
+    typedef BitBoard<N> Board;
+    static constexpr int CELL_COUNT = N * N;
+
+    UntriedCells() { reset(); }
+
+    void reset() {
+        std::memset(slotCells, 0, sizeof(slotCells));
+        std::memset(cellSlots, 0, sizeof(cellSlots));
+        tried.clear();
+        remaining = CELL_COUNT;
+    }
+
+    int count() const { return remaining; }
+    bool isTried(int cell) const { return tried.test(cell); }
+    const Board& getTried() const { return tried; }
+
+    void markTried(int cell) {
+        if (cell < 0 || cell >= CELL_COUNT || tried.test(cell)) return;
+        tried.set(cell);
+        int slot = slotOf(cell);
+        int last = --remaining;
+        int lastCell = cellAt(last);
+        setCell(slot, lastCell); setSlot(lastCell, slot);
+        setCell(last, cell); setSlot(cell, last);
+    }
+
+    // Marks every cell of 'shots' not yet tried; the cost is proportional to the new cells.
+    void markTried(const Board& shots) {
+        Board fresh = shots;
+        fresh.andNot(tried);
+        for (int w = 0; w < Board::WORDS; ++w) {
+            for (uint64_t bits = fresh.words[w]; bits; bits &= bits - 1) markTried(w * 64 + countTrailingZeros64(bits));
+        }
+    }
+
+    // A uniformly chosen untried cell, or -1 if every cell has been tried. Does not mark it.
+    int sample(GameRandom& rng) const {
+        if (remaining == 0) return -1;
+        return cellAt(static_cast<int>(rng.nextBelow(static_cast<uint32_t>(remaining))));
+    }
+
+private:
+    uint16_t slotCells[CELL_COUNT]; // slot -> cell, stored XOR slot
+    uint16_t cellSlots[CELL_COUNT]; // cell -> slot, stored XOR cell
+    Board tried;
+    int remaining;
+
+    int cellAt(int slot) const { return slotCells[slot] ^ slot; }
+    int slotOf(int cell) const { return cellSlots[cell] ^ cell; }
+    void setCell(int slot, int cell) { slotCells[slot] = static_cast<uint16_t>(cell ^ slot); }
+    void setSlot(int cell, int slot) { cellSlots[cell] = static_cast<uint16_t>(slot ^ cell); }
+};
@@ -34,20 +34,41 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
         }
     }
 
+    // .NET copy of a protocol field (a view into the std::string being processed).
+    String^ FieldToString(std::string_view field) { return msclr::interop::marshal_as<String^>(std::string(field)); }
+
+    // Host: GAME_UPDATE (or GAME_SNAPSHOT at 'seq') for the game as the client, player 2, sees it.
+    std::string BuildHostGameState(const BattleshipGameLogic& logic, bool snapshot, unsigned int seq) {
+        std::string p1Board = logic.GetPlayer1()->getOwnBoardAsString(); // Host's board first...
+        std::string p2Board = logic.GetPlayer2()->getOwnBoardAsString(); // ...then the client's.
+        std::string winner = logic.IsGameOver() ? logic.GetWinnerString() : std::string(); // Sent as "N/A" until the game is over.
+        GameUpdate update; // Fields of the message.
+        update.seq = seq;
+        update.turnId = WireTurnId(logic.GetCurrentTurnState(), 2); // Player to move, or the winner once the game is over.
+        update.player1Board = p1Board; update.player2Board = p2Board;
+        update.action = logic.GetLastActionMessage(); update.gameOver = logic.IsGameOver(); update.winner = winner;
+        MessageBuilder out; // Shared builder: escapes the free text the same way the headless server does.
+        if (snapshot) BuildGameSnapshot(out, update); else BuildGameUpdate(out, update);
+        return out.GetText();
+    }
+
     // Constructor for the Form1 class.
     Form1::Form1(void) {
         InitializeComponent(); // Calls the method to initialize all UI controls (auto-generated by Windows Forms Designer).
-        std::srand(static_cast<unsigned int>(std::time(nullptr))); // Seeds the standard C++ random number generator (used by gameLogicServer).
         gameLogicServer = nullptr; // Initializes the pointer to the native game logic server object to null.
+        clientBoards = nullptr; // Created when the first board state arrives from the host.
         isHost = false; isConnected = false; myPlayerId = 0; // Initializes network state flags and player ID.
         opponentName = gcnew String(L"Opponent"); // Initializes the opponent's name to a default value.
         gameActive = false; isMyTurn = false; // Initializes game state flags.
         clientSentReady = false; hostAcknowledgedClientReady = false; // Initializes flags for the ready-up sequence.
+        peerProtocolVersion = PROTOCOL_V1; gameUpdateSeq = 0; // Plain GAME_UPDATE until the peers negotiate PROTOCOL 2.
 
         UIMessageQueue = gcnew System::Collections::Generic::Queue<String^>(); // Creates a new generic queue to hold incoming network messages for UI processing.
+        UIMessageBatch = gcnew System::Collections::Generic::Queue<String^>(); // The UI thread's half of the double buffer (see DrainUIMessages).
         queueLock = gcnew Object(); // Creates a new object to use as a lock for synchronizing access to UIMessageQueue.
+        uiDrainPosted = false; drainingUIMessages = false; // No drain is queued on the UI thread or running yet.
         messageProcessTimer = gcnew System::Windows::Forms::Timer(this->components); // Creates a new Timer component.
-        messageProcessTimer->Interval = 50; // Sets the timer interval to 50 milliseconds.
+        messageProcessTimer->Interval = 50; // Fallback only: the receive thread wakes the UI thread itself when a message arrives.
         messageProcessTimer->Tick += gcnew System::EventHandler(this, &Form1::OnMessageProcessTimerTick); // Assigns an event handler for the timer's Tick event.
 
         backgroundMusicPlayer = gcnew SoundPlayer(); // Creates a new SoundPlayer object for background music.
@@ -340,8 +361,10 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
         if (this->InvokeRequired) { this->BeginInvoke(gcnew VoidDelegate(this, &Form1::ResetGameAndUI)); return; }
         CleanUpNetworkResources(); // Cleans up any existing network connections or listeners.
         if (gameLogicServer) { delete gameLogicServer; gameLogicServer = nullptr; } // Deletes the native game logic object if it exists.
+        if (clientBoards) { delete clientBoards; clientBoards = nullptr; } // Deletes the client's board mirror if it exists.
         isHost = false; isConnected = false; myPlayerId = 0; opponentName = L"Opponent"; // Resets network and player state flags.
         gameActive = false; isMyTurn = false; clientSentReady = false; hostAcknowledgedClientReady = false; // Resets game progression flags.
+        peerProtocolVersion = PROTOCOL_V1; gameUpdateSeq = 0; // Protocol is renegotiated on the next connection.
         for (int r = 0; r < BOARD_SIZE_CONST; ++r) for (int c = 0; c < BOARD_SIZE_CONST; ++c) { // Loop to reset all board buttons.
             if (ownBoardButtons && ownBoardButtons[r, c]) { ownBoardButtons[r, c]->BackColor = Color::Azure; ownBoardButtons[r, c]->Text = L""; } // Reset own board buttons.
             if (trackingBoardButtons && trackingBoardButtons[r, c]) { trackingBoardButtons[r, c]->BackColor = Color::LightGray; trackingBoardButtons[r, c]->Text = L""; } // Reset tracking board buttons.
@@ -413,6 +436,9 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
             std::string my_board_std = context.marshal_as<std::string>(p2BoardStr_param); // Marshal my board string (P2's board).
             // Validate board string lengths.
             if (host_board_std.length() != BOARD_SIZE_CONST * BOARD_SIZE_CONST || my_board_std.length() != BOARD_SIZE_CONST * BOARD_SIZE_CONST) { Log(L"CLIENT: Invalid board string length for Redraw."); return; }
+            if (!clientBoards) clientBoards = new Player("Client"); // Board mirror for GAME_DELTA.
+            clientBoards->setOwnBoardFromString(my_board_std); // Full boards; a following GAME_DELTA continues from them.
+            clientBoards->setTrackingBoardFromString(host_board_std); // Host's ship cells read as unexplored.
             for (int r = 0; r < BOARD_SIZE_CONST; ++r) for (int c = 0; c < BOARD_SIZE_CONST; ++c) { // Iterate board cells.
                 char cellStateMyOwn = my_board_std[r * BOARD_SIZE_CONST + c]; // Get state of my own cell from string.
                 // Update my own board button appearance.
@@ -511,6 +537,7 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
             serverConnection->Connect(ip, port); // Attempt to connect to the server.
             if (serverConnection->Connected) { // If connection successful.
                 serverStream = serverConnection->GetStream(); isConnected = true; Log(L"Connected! Sending my name."); // Get stream, set connected.
+                SendNetMessage(serverStream, String::Format(L"PROTOCOL {0}", PROTOCOL_V2)); // Offer delta updates; hosts without v2 ignore this and keep sending GAME_UPDATE.
                 SendNetMessage(serverStream, String::Format(L"CONNECT_REQUEST {0}", myNameInternal)); // Send initial connect request with name.
                 receiveThread = gcnew Thread(gcnew ParameterizedThreadStart(this, &Form1::ReceiveMessages)); // Create thread for receiving messages.
                 receiveThread->IsBackground = true; // Set as background.
@@ -532,6 +559,8 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
             while ((msg = reader->ReadLine()) != nullptr) { // Loop while messages are being read (ReadLine blocks).
                 if (IsDisposed) break; // If form is disposed, exit loop.
                 msclr::lock l(queueLock); UIMessageQueue->Enqueue(msg); // Lock the queue and add the message for UI thread processing.
+                bool wakeUI = !uiDrainPosted; uiDrainPosted = true; l.release(); // Only the first message of a batch needs to wake the UI thread.
+                if (wakeUI && IsHandleCreated) this->BeginInvoke(gcnew VoidDelegate(this, &Form1::DrainUIMessages)); // Handle it now rather than at the next timer tick.
             }
         }
         catch (IOException^) { // Catch IO exceptions (often indicate connection lost).
@@ -622,14 +651,10 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
                 else { gameLogicServer->StartNewGame(context.marshal_as<std::string>(myNameInternal), context.marshal_as<std::string>(opponentName)); } // Or start new if P2 was temp.
 
                 Log(L"HOST: Both players ready. Sending initial GAME_UPDATE."); // Log status.
-                // Get board states and last action from game logic.
-                String^ p1Board = context.marshal_as<String^>(gameLogicServer->GetPlayer1()->getOwnBoardAsString());
-                String^ p2Board = context.marshal_as<String^>(gameLogicServer->GetPlayer2()->getOwnBoardAsString());
-                String^ lastAction = context.marshal_as<String^>(gameLogicServer->GetLastActionMessage());
-                // Construct GAME_UPDATE message to send to client.
-                String^ gameUpdateMsg = String::Format(L"GAME_UPDATE {0} {1} {2} {3} {4} {5}",
-                    1, p1Board, p2Board, lastAction->Replace(" ", "_SPACE_"), Boolean::FalseString, L"N/A"); // Turn ID 1 (P1), boards, action, not game over, no winner yet.
-                SendNetMessage(opponentStream, gameUpdateMsg); // Send message to client.
+                Log(String::Format(L"HOST: Game seed {0:X16}.", gameLogicServer->GetSeed())); // Replays this game's placement via StartNewGame(..., seed).
+                String^ gameUpdateMsg = BuildGameUpdateMessage(); // Initial state: player 1 to move, no winner yet.
+                gameUpdateSeq = 0; // New game: deltas are numbered from the initial snapshot.
+                SendGameStateToClient(gameUpdateMsg, false); // Send message to client (full state).
                 ProcessUIMessage(gameUpdateMsg); // Process the same message locally for host's UI.
             }
             else { Log(L"Host ready, waiting for Client to send READY signal."); } // If client not ready yet.
@@ -649,32 +674,17 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
         clickedButton->Enabled = false; // Disable clicked button immediately to prevent double-clicks.
 
         if (gameActive && isMyTurn) { // If game is active and it's this player's turn.
-            msclr::interop::marshal_context context; // For string marshalling.
             if (isHost) { // If this instance is the host.
                 if (!gameLogicServer) { Log(L"HOST: No game logic on attack!"); return; } // Should not happen.
-                gameLogicServer->MakeAttack(cell.X, cell.Y); // Host makes attack in its local game logic.
-
-                // Get updated game state from server logic.
-                String^ p1Board = context.marshal_as<String^>(gameLogicServer->GetPlayer1()->getOwnBoardAsString());
-                String^ p2Board = context.marshal_as<String^>(gameLogicServer->GetPlayer2()->getOwnBoardAsString());
-                String^ lastAction = context.marshal_as<String^>(gameLogicServer->GetLastActionMessage());
-                bool gameOver = gameLogicServer->IsGameOver();
-                String^ winner = gameOver ? context.marshal_as<String^>(gameLogicServer->GetWinnerString()) : L"";
-                int nextTurnId = gameOver ? 0 : ((gameLogicServer->GetCurrentTurnState() == GameTurn::PLAYER1) ? 1 : 2); // Determine next turn ID.
-                if (gameOver && gameLogicServer->GetCurrentTurnState() == GameTurn::GAME_OVER_P1_WINS) nextTurnId = 1; // If P1 won, "turn" is P1.
-                else if (gameOver && gameLogicServer->GetCurrentTurnState() == GameTurn::GAME_OVER_P2_WINS) nextTurnId = 2; // If P2 won, "turn" is P2.
-
-                // Construct GAME_UPDATE message with new state.
-                String^ gameUpdateMsg = String::Format(L"GAME_UPDATE {0} {1} {2} {3} {4} {5}",
-                    nextTurnId, p1Board, p2Board, lastAction->Replace(" ", "_SPACE_"), // Replace spaces for network transmission.
-                    gameOver.ToString(), winner->Replace(" ", "_SPACE_"));
-
-                SendNetMessage(opponentStream, gameUpdateMsg); // Send update to client.
+                bool moveAccepted = gameLogicServer->MakeAttack(cell.X, cell.Y).isAccepted(); // Host makes attack in its local game logic.
+                String^ gameUpdateMsg = BuildGameUpdateMessage(); // Updated game state from server logic.
+                SendGameStateToClient(gameUpdateMsg, moveAccepted); // Send update to client.
                 ProcessUIMessage(gameUpdateMsg); // Process update locally for host's UI.
             }
             else { // If this instance is the client.
                 // Log(String::Format(L"CLIENT: Sending ATTACK {0} {1}", cell.X, cell.Y)); // Debug log (commented out).
-                SendNetMessage(serverStream, String::Format(L"ATTACK {0} {1}", cell.X, cell.Y)); // Send ATTACK message to host.
+                MessageBuilder out; // ATTACK <row> <col>
+                SendNetMessage(serverStream, msclr::interop::marshal_as<String^>(out.Begin(MessageType::ATTACK).Add(cell.X).Add(cell.Y).GetText())); // Send ATTACK message to host.
                 isMyTurn = false; // Client assumes turn is over after sending attack.
             }
         }
@@ -685,27 +695,34 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
     // Processes a received network message string to update game state and UI.
     void Form1::ProcessUIMessage(String^ message) {
         if (this->IsDisposed) return; // If form disposed, do nothing.
-        array<String^>^ parts = message->Split(L' '); // Split message into parts by space.
-        String^ command = parts[0]; // First part is the command.
         msclr::interop::marshal_context context; // For string marshalling.
+        std::string line = context.marshal_as<std::string>(message); // One copy; the parsed fields are views into it.
+        ProtocolMessage parsed; // Command and fields (see MessageCodec.h).
+        if (!ParseMessage(line, parsed)) return; // Empty line.
 
         // Log(String::Format(L"UI_Process: {0}", message->Length > 80 ? message->Substring(0,80)+L"..." : message)); // Debug log (commented out).
 
-        if (command == L"CONNECT_REQUEST" && isHost && parts->Length > 1) { // Host receives connect request from client.
-            opponentName = parts[1]; for (int i = 2; i < parts->Length; ++i) opponentName = String::Concat(opponentName, " ", parts[i]); // Reconstruct opponent name if it has spaces.
+        switch (parsed.type) { // Commands this side does not expect are ignored.
+        case MessageType::CONNECT_REQUEST: // Host receives connect request from client.
+            if (!isHost || parsed.GetArgCount() < 1) break;
+            opponentName = FieldToString(parsed.GetRest(1)); // Opponent name, spaces included.
             if (String::IsNullOrWhiteSpace(opponentName)) opponentName = L"ClientPlayer"; // Default opponent name if empty.
             Log(String::Format(L"Host: Received CONNECT_REQUEST from '{0}'. Sending WELCOME.", opponentName)); // Log event.
             if (!gameLogicServer) gameLogicServer = new BattleshipGameLogic(); // Ensure game logic exists.
             // Start new game in server logic with host and client names.
             gameLogicServer->StartNewGame(context.marshal_as<std::string>(String::IsNullOrWhiteSpace(myNameInternal) ? "Host" : myNameInternal), context.marshal_as<std::string>(opponentName));
             SendNetMessage(opponentStream, String::Format(L"WELCOME {0} {1} {2}", myNameInternal, opponentName, 2)); // Send WELCOME to client (my name, opponent name, client's player ID is 2).
-        }
-        else if (command == L"WELCOME" && !isHost && parts->Length > 3) { // Client receives welcome message from host.
-            opponentName = parts[1]; // Host's name.
-            myPlayerId = Convert::ToInt32(parts[3]); // My player ID (should be 2).
+            break;
+        case MessageType::WELCOME: { // Client receives welcome message from host.
+            int playerId = 0; // Should be 2.
+            if (isHost || parsed.GetArgCount() < 3 || !ParseField(parsed.fields[3], playerId)) break;
+            opponentName = FieldToString(parsed.fields[1]); // Host's name.
+            myPlayerId = playerId; // My player ID.
             Log(String::Format(L"Client: Welcome from Host '{0}'. I am Player {1}.", opponentName, myPlayerId)); // Log event.
+            break;
         }
-        else if (command == L"READY" && isHost) { // Host receives "READY" from client.
+        case MessageType::READY: // Host receives "READY" from client.
+            if (!isHost) break;
             clientSentReady = true; Log(L"Host: Client sent READY."); // Mark client as ready.
             if (hostAcknowledgedClientReady) { // If host is also ready.
                 gameActive = true; isMyTurn = true; // Game starts, host's turn.
@@ -714,70 +731,152 @@ namespace BattleshipGame { // Defines the namespace for the Battleship game UI e
                 // Start new game or update names in existing logic.
                 gameLogicServer->StartNewGame(context.marshal_as<std::string>(myNameInternal), context.marshal_as<std::string>(effectiveOpponentName));
                 Log(L"HOST: Both players ready. Sending initial GAME_UPDATE."); // Log status.
-                // Get initial board states and action.
-                String^ p1Board = context.marshal_as<String^>(gameLogicServer->GetPlayer1()->getOwnBoardAsString());
-                String^ p2Board = context.marshal_as<String^>(gameLogicServer->GetPlayer2()->getOwnBoardAsString());
-                String^ lastAction = context.marshal_as<String^>(gameLogicServer->GetLastActionMessage());
-                // Construct and send initial GAME_UPDATE.
-                String^ gameUpdateMsg = String::Format(L"GAME_UPDATE {0} {1} {2} {3} {4} {5}",
-                    1, p1Board, p2Board, lastAction->Replace(" ", "_SPACE_"), Boolean::FalseString, L"N/A");
-                SendNetMessage(opponentStream, gameUpdateMsg); ProcessUIMessage(gameUpdateMsg); // Send and process locally.
+                Log(String::Format(L"HOST: Game seed {0:X16}.", gameLogicServer->GetSeed())); // Replays this game's placement via StartNewGame(..., seed).
+                String^ gameUpdateMsg = BuildGameUpdateMessage(); // Initial state: player 1 to move, no winner yet.
+                gameUpdateSeq = 0; // New game: deltas are numbered from the initial snapshot.
+                SendGameStateToClient(gameUpdateMsg, false); ProcessUIMessage(gameUpdateMsg); // Send and process locally.
             }
-        }
-        else if (command == L"ATTACK" && isHost && parts->Length == 3) { // Host receives ATTACK from client.
+            break;
+        case MessageType::ATTACK: { // Host receives ATTACK from client.
+            if (!isHost || parsed.fieldCount != 3) break;
             if (!gameLogicServer || !gameActive) { Log(L"HOST: Received ATTACK but game not active/ready."); return; } // If game not ready, ignore.
-            int r = Convert::ToInt32(parts[1]); int c = Convert::ToInt32(parts[2]); // Parse attack coordinates.
+            int r = 0, c = 0; // Attack coordinates.
+            if (!ParseField(parsed.fields[1], r) || !ParseField(parsed.fields[2], c)) { Log(String::Format(L"HOST: Malformed ATTACK. Msg: {0}", message)); break; } // Not two numbers.
             // Log(String::Format(L"HOST: Processing client ATTACK {0},{1}", r,c)); // Debug log (commented out).
-            gameLogicServer->MakeAttack(r, c); // Host processes client's attack in its game logic.
-            // Get updated game state.
-            String^ p1Board = context.marshal_as<String^>(gameLogicServer->GetPlayer1()->getOwnBoardAsString());
-            String^ p2Board = context.marshal_as<String^>(gameLogicServer->GetPlayer2()->getOwnBoardAsString());
-            String^ lastAction = context.marshal_as<String^>(gameLogicServer->GetLastActionMessage());
-            bool gameOver = gameLogicServer->IsGameOver();
-            String^ winner = gameOver ? context.marshal_as<String^>(gameLogicServer->GetWinnerString()) : L"";
-            int nextTurnId = (gameLogicServer->GetCurrentTurnState() == GameTurn::PLAYER1) ? 1 : 2; // Determine next turn.
-            if (gameOver) nextTurnId = (gameLogicServer->GetCurrentTurnState() == GameTurn::GAME_OVER_P1_WINS) ? 1 : (gameLogicServer->GetCurrentTurnState() == GameTurn::GAME_OVER_P2_WINS ? 2 : 0); // Set turn based on winner.
-            // Construct and send GAME_UPDATE.
-            String^ gameUpdateMsg = String::Format(L"GAME_UPDATE {0} {1} {2} {3} {4} {5}",
-                nextTurnId, p1Board, p2Board, lastAction->Replace(" ", "_SPACE_"), gameOver.ToString(), winner->Replace(" ", "_SPACE_"));
-            SendNetMessage(opponentStream, gameUpdateMsg); ProcessUIMessage(gameUpdateMsg); // Send and process locally.
-        }
-        else if (command == L"GAME_UPDATE" && parts->Length >= 6) { // Both host and client receive GAME_UPDATE.
-            try {
-                // Parse GAME_UPDATE message parts.
-                int currentTurnId_from_server = Convert::ToInt32(parts[1]);
-                String^ p1Board_str = parts[2]; String^ p2Board_str = parts[3];
-                String^ lastActionMessage_Received = parts[4]->Replace(L"_SPACE_", L" "); // Restore spaces.
-                bool gameOver_Received = Boolean::Parse(parts[5]);
-                String^ winnerMessage_Received = (parts->Length > 6 && parts[6] != L"N/A") ? parts[6]->Replace(L"_SPACE_", L" ") : L""; // Get winner message.
-                if (parts->Length > 7) { for (int i = 7; i < parts->Length; ++i) winnerMessage_Received = String::Concat(winnerMessage_Received, L" ", parts[i]->Replace(L"_SPACE_", L" ")); } // Reconstruct multi-part winner message.
-
-                // Log(String::Format(L"Side ({0}): Recvd GAME_UPDATE. TurnForP{1}. GameOver={2}. LastAction='{3}' Winner='{4}'", (isHost?L"Host":L"Client"), currentTurnId_from_server, gameOver_Received, lastActionMessage_Received, winnerMessage_Received)); // Debug log (commented out).
-                gameActive = !gameOver_Received; // Update game active state.
-                isMyTurn = (currentTurnId_from_server == myPlayerId) && gameActive; // Update whose turn it is.
-                // Log(String::Format(L"Side ({0}): After GAME_UPDATE, isMyTurn = {1}", (isHost?L"Host":L"Client"), isMyTurn)); // Debug log (commented out).
-                RedrawBoardsFromServerData(p1Board_str, p2Board_str); // Redraw boards based on received data.
-                if (statusLabel != nullptr) statusLabel->Text = lastActionMessage_Received; // Update status label with last action.
-                if (gameOver_Received) { // If game is over.
-                    Log(String::Format(L"Side ({0}): Game Over! {1}", (isHost ? L"Host" : L"Client"), winnerMessage_Received)); // Log game over.
-                    MessageBox::Show(String::Format(L"Game Over! {0}", winnerMessage_Received), L"Game Over", MessageBoxButtons::OK); // Show message box.
+            bool moveAccepted = gameLogicServer->MakeAttack(r, c).isAccepted(); // Host processes client's attack in its game logic.
+            String^ gameUpdateMsg = BuildGameUpdateMessage(); // Updated game state.
+            SendGameStateToClient(gameUpdateMsg, moveAccepted); ProcessUIMessage(gameUpdateMsg); // Send and process locally.
+            break;
+        }
+        case MessageType::GAME_UPDATE: // Both host and client receive GAME_UPDATE.
+        case MessageType::GAME_SNAPSHOT: { // Client only: GAME_SNAPSHOT <seq> <GAME_UPDATE fields>.
+            if (parsed.type == MessageType::GAME_SNAPSHOT && isHost) break;
+            GameUpdate update; // Parsed fields; action and winner still escaped.
+            if (!ParseGameUpdate(parsed, update)) { Log(String::Format(L"Error processing {0}. Msg: {1}", FieldToString(parsed.fields[0]), message)); break; } // Log malformed update.
+            String^ lastActionMessage_Received = context.marshal_as<String^>(UnescapeSpaces(update.action)); // Restore spaces.
+            String^ winnerMessage_Received = context.marshal_as<String^>(UnescapeSpaces(update.winner)); // Empty until the game is over.
+            // Log(String::Format(L"Side ({0}): Recvd GAME_UPDATE. TurnForP{1}. GameOver={2}. LastAction='{3}' Winner='{4}'", (isHost?L"Host":L"Client"), update.turnId, update.gameOver, lastActionMessage_Received, winnerMessage_Received)); // Debug log (commented out).
+            gameActive = !update.gameOver; // Update game active state.
+            isMyTurn = (update.turnId == myPlayerId) && gameActive; // Update whose turn it is.
+            RedrawBoardsFromServerData(FieldToString(update.player1Board), FieldToString(update.player2Board)); // Redraw boards based on received data (loads clientBoards).
+            if (parsed.type == MessageType::GAME_SNAPSHOT && clientBoards) clientBoards->setSyncSeq(update.seq); // Deltas continue from here.
+            if (statusLabel != nullptr) statusLabel->Text = lastActionMessage_Received; // Update status label with last action.
+            if (update.gameOver) { // If game is over.
+                Log(String::Format(L"Side ({0}): Game Over! {1}", (isHost ? L"Host" : L"Client"), winnerMessage_Received)); // Log game over.
+                MessageBox::Show(String::Format(L"Game Over! {0}", winnerMessage_Received), L"Game Over", MessageBoxButtons::OK); // Show message box.
+            }
+            break;
+        }
+        case MessageType::PROTOCOL: { // Client offers a newer protocol (sent before CONNECT_REQUEST).
+            int offered = 0;
+            if (isHost && !gameActive && ParseField(parsed.GetField(1), offered) && offered >= PROTOCOL_V2) { // Only switch before the game starts.
+                peerProtocolVersion = PROTOCOL_V2; // Client understands GAME_SNAPSHOT / GAME_DELTA.
+                SendNetMessage(opponentStream, String::Format(L"PROTOCOL_OK {0}", PROTOCOL_V2)); // Confirm the version to the client.
+            }
+            break;
+        }
+        case MessageType::PROTOCOL_OK: { // Host accepted the protocol offer.
+            int accepted = 0;
+            if (!isHost && ParseField(parsed.GetField(1), accepted) && accepted >= PROTOCOL_V2) { peerProtocolVersion = PROTOCOL_V2; Log(L"Client: Host supports delta updates."); } // Expect GAME_SNAPSHOT / GAME_DELTA from now on.
+            break;
+        }
+        case MessageType::RESYNC: // Client missed a GAME_DELTA and asks for the full state.
+            if (isHost && gameLogicServer && peerProtocolVersion >= PROTOCOL_V2) SendGameStateToClient(BuildGameUpdateMessage(), false); // Reply with a GAME_SNAPSHOT at the current sequence number.
+            break;
+        case MessageType::GAME_DELTA: { // One shot since the last snapshot/delta.
+            if (isHost) break;
+            GameDelta delta; // Parsed delta.
+            if (!ParseGameDelta(parsed, delta)) { Log(String::Format(L"Error processing GAME_DELTA. Msg: {0}", message)); } // Log malformed delta.
+            else if (!clientBoards) { SendNetMessage(serverStream, L"RESYNC"); } // No boards to apply it to yet.
+            else {
+                switch (clientBoards->applyBoardDelta(MakeBoardCellDelta(delta, BOARD_SIZE_CONST))) { // Updates the one changed cell of the mirror.
+                case BoardSyncResult::APPLIED: ApplyGameDelta(delta); break; // In order: repaint that cell.
+                case BoardSyncResult::DUPLICATE: break; // Already applied (the snapshot after a RESYNC included it).
+                case BoardSyncResult::GAP: // A delta was lost or reordered: ask the host for the full state.
+                    Log(String::Format(L"Client: GAME_DELTA {0} after {1}; requesting RESYNC.", delta.seq, clientBoards->getSyncSeq())); // Log the gap.
+                    SendNetMessage(serverStream, L"RESYNC"); // Host answers with GAME_SNAPSHOT.
+                    break;
+                default: Log(String::Format(L"Error processing GAME_DELTA. Msg: {0}", message)); break; // Cell out of range.
                 }
             }
-            catch (Exception^ ex) { Log(String::Format(L"Error processing GAME_UPDATE: {0}. Msg: {1}", ex->Message, message)); } // Log error during processing.
+            break;
         }
-        else if (command == L"DISCONNECT" || command == L"SERVER_SHUTDOWN") { // If disconnect or server shutdown message received.
-            Log(String::Format(L"Received {0}. Disconnecting.", command)); // Log event.
-            HandleDisconnection(command); // Handle disconnection.
+        case MessageType::DISCONNECT: // If disconnect or server shutdown message received.
+        case MessageType::SERVER_SHUTDOWN:
+            Log(String::Format(L"Received {0}. Disconnecting.", FieldToString(parsed.fields[0]))); // Log event.
+            HandleDisconnection(FieldToString(parsed.fields[0])); // Handle disconnection.
+            break;
+        default: break; // Unknown command.
         }
         UpdateUI(); // Update UI after processing message.
     }
 
+    // Host: sends the state after a change to the client. A v1 client always gets the full GAME_UPDATE;
+    // a v2 client gets a GAME_DELTA for an accepted move and a GAME_SNAPSHOT otherwise (game start, rejected move, RESYNC).
+    void Form1::SendGameStateToClient(String^ gameUpdateMsg, bool moveAccepted) {
+        if (peerProtocolVersion < PROTOCOL_V2 || !gameLogicServer) { SendNetMessage(opponentStream, gameUpdateMsg); return; } // Old client: full update.
+        msclr::interop::marshal_context context; // For string marshalling.
+        if (moveAccepted) { // Only the shot itself goes over the wire.
+            ++gameUpdateSeq; // One sequence number per accepted move.
+            MessageBuilder out; // GAME_DELTA encoder shared with the headless server.
+            BuildGameDelta(out, MakeGameDelta(gameLogicServer->GetLastAttack(), gameUpdateSeq, 2)); // Client is player 2.
+            SendNetMessage(opponentStream, context.marshal_as<String^>(out.GetText()));
+        }
+        else { SendNetMessage(opponentStream, context.marshal_as<String^>(BuildHostGameState(*gameLogicServer, true, gameUpdateSeq))); } // GAME_UPDATE fields behind the sequence number.
+    }
+
+    // Host: GAME_UPDATE for the current state of the game logic.
+    String^ Form1::BuildGameUpdateMessage() {
+        msclr::interop::marshal_context context; // For string marshalling.
+        return context.marshal_as<String^>(BuildHostGameState(*gameLogicServer, false, 0));
+    }
+
+    // Client: applies one GAME_DELTA. Only the attacked cell changes, so only that button is repainted.
+    void Form1::ApplyGameDelta(const GameDelta& delta) {
+        int r = delta.row, c = delta.col; // Attacked cell.
+        if (r < 0 || r >= BOARD_SIZE_CONST || c < 0 || c >= BOARD_SIZE_CONST) { Log(L"CLIENT: GAME_DELTA cell out of range."); return; } // Ignore bad coordinates.
+        bool hit = (delta.result != MISS_CHAR); // HIT_CHAR or SUNK_RESULT_CHAR.
+        if (delta.attackerId == myPlayerId) { // My shot: update my tracking board.
+            if (trackingBoardButtons && trackingBoardButtons[r, c]) { trackingBoardButtons[r, c]->BackColor = hit ? Color::Red : Color::Blue; trackingBoardButtons[r, c]->Text = hit ? L"H" : L"M"; }
+        }
+        else if (ownBoardButtons && ownBoardButtons[r, c]) { ownBoardButtons[r, c]->Text = L""; ownBoardButtons[r, c]->BackColor = hit ? Color::OrangeRed : Color::LightSkyBlue; } // Opponent's shot: update my own board.
+
+        msclr::interop::marshal_context context; // For string marshalling.
+        gameActive = !delta.gameOver; // Update game active state.
+        isMyTurn = (delta.nextTurnId == myPlayerId) && gameActive; // Update whose turn it is.
+        std::string myName = context.marshal_as<std::string>(myNameInternal); std::string hostName = context.marshal_as<std::string>(opponentName); // Names as the host knows them.
+        if (statusLabel != nullptr) statusLabel->Text = context.marshal_as<String^>(FormatGameDeltaMessage(delta, myName, hostName)); // Same text the host would have sent.
+        if (delta.gameOver) { // If game is over.
+            String^ winnerMessage = String::Format(L"{0} wins!", delta.nextTurnId == myPlayerId ? myNameInternal : opponentName); // The winner made the last move.
+            Log(String::Format(L"Side (Client): Game Over! {0}", winnerMessage)); // Log game over.
+            MessageBox::Show(String::Format(L"Game Over! {0}", winnerMessage), L"Game Over", MessageBoxButtons::OK); // Show message box.
+        }
+    }
+
     // Event handler for the message processing timer's Tick event.
     void Form1::OnMessageProcessTimerTick(Object^ sender, EventArgs^ e) {
-        if (IsDisposed) return; // If form disposed, do nothing.
-        String^ msg = nullptr; // Variable to hold dequeued message.
-        msclr::lock l(queueLock); if (UIMessageQueue->Count > 0) msg = UIMessageQueue->Dequeue(); l.release(); // Lock queue, dequeue message if available, release lock.
-        if (msg != nullptr) ProcessUIMessage(msg); // If a message was dequeued, process it.
+        DrainUIMessages(); // Picks up anything a missed wakeup left behind.
+    }
+
+    // Processes every message received so far. The two queues are swapped under the lock, so the
+    // receive thread keeps enqueueing while this batch is handled, and each batch costs one lock
+    // instead of one per message.
+    void Form1::DrainUIMessages() {
+        if (IsDisposed || drainingUIMessages) return; // If form disposed, or called from a dialog opened by the batch below, do nothing (the timer drains what is left).
+        drainingUIMessages = true; // Marks the batch as in progress.
+        msclr::lock l(queueLock); // Lock the queue only for the swap.
+        System::Collections::Generic::Queue<String^>^ batch = UIMessageQueue; UIMessageQueue = UIMessageBatch; UIMessageBatch = batch; // Take the whole backlog.
+        uiDrainPosted = false; l.release(); // Messages from now on post a new drain.
+        try { while (batch->Count > 0 && !IsDisposed) ProcessUIMessage(batch->Dequeue()); } // Process the batch in arrival order.
+        finally {
+            if (batch->Count > 0 && !IsDisposed) { // A handler threw: the rest of the batch goes back in front of what arrived since, for the next drain.
+                msclr::lock requeue(queueLock); // Lock the queue for the merge.
+                while (UIMessageQueue->Count > 0) batch->Enqueue(UIMessageQueue->Dequeue()); // Keep arrival order: the remainder first, then the newer messages.
+                UIMessageBatch = UIMessageQueue; UIMessageQueue = batch; // The merged queue becomes the shared one again.
+            }
+            else batch->Clear(); // Done, or the form is gone.
+            drainingUIMessages = false; // Let the next drain run.
+        }
     }
 
     // Event handler for the Form's Load event (fires when the form is first loaded).
@@ -1,9 +1,9 @@
 // Form1.h
 #pragma once // Standard preprocessor directive to ensure this header file is included only once during compilation.
 
-#include <cstdlib> // Includes the C standard library for general utilities, e.g., rand(), srand() for random number generation.
-#include <ctime>   // Includes the C time library, often used with <cstdlib> to seed the random number generator (srand(time(0))).
+#include <cstdlib> // Includes the C standard library for general utilities.
 #include "BattleshipGame.h" // Includes a custom header file, likely containing the core game logic class (BattleshipGameLogic).
+#include "Protocol.h" // Protocol versions and the GAME_DELTA encoding shared with the headless server.
 #include <msclr/marshal_cppstd.h> // Includes MSCLR (Microsoft C++ Language Runtime) utilities for marshalling (converting) between .NET System::String and C++ std::string.
 #include <msclr/lock.h>         // Includes MSCLR utility for simplified locking, often used for thread synchronization with a critical section.
 
@@ -34,6 +34,7 @@ namespace BattleshipGame { // Declares a namespace for the game to organize code
             if (backgroundMusicPlayer != nullptr) { backgroundMusicPlayer->Stop(); } // If the background music player exists, stop the music.
             CleanUpNetworkResources(); // Calls a custom method to release network-related resources.
             if (gameLogicServer) { delete gameLogicServer; gameLogicServer = nullptr; } // If the game logic object (unmanaged) exists, delete it and set to nullptr.
+            if (clientBoards) { delete clientBoards; clientBoards = nullptr; } // Client's mirror of its boards (unmanaged).
             if (messageProcessTimer != nullptr) { // If the message processing timer exists...
                 if (messageProcessTimer->Enabled) messageProcessTimer->Stop(); // ...and it's enabled, stop it.
                 delete messageProcessTimer; messageProcessTimer = nullptr; // Delete the timer object and set to nullptr.
@@ -52,19 +53,24 @@ namespace BattleshipGame { // Declares a namespace for the game to organize code
         Label^ ownBoardLabel; Label^ trackingBoardLabel; // UI: Label for the player's own board. UI: Label for the tracking board.
 
         BattleshipGameLogic* gameLogicServer; // Pointer to an instance of the unmanaged C++ BattleshipGameLogic class, holding the game's rules and state.
+        Player* clientBoards; // Client: mirror of its own and tracking boards, kept in step by GAME_SNAPSHOT / GAME_DELTA (its sync seq detects lost deltas).
 
         bool isHost; bool isConnected; int myPlayerId; // Game state: True if this instance is hosting the game. True if connected to an opponent/server. Player ID (e.g., 0 or 1).
         String^ myNameInternal; String^ opponentName; // Game state: This player's name. Opponent's name. (Managed System::String).
         bool gameActive; bool isMyTurn; // Game state: True if the game is currently in progress. True if it's this player's turn.
         bool clientSentReady; bool hostAcknowledgedClientReady; // Game state flags for ready synchronization between host and client.
+        int peerProtocolVersion; unsigned int gameUpdateSeq; // Protocol version agreed with the peer (PROTOCOL_V1 unless PROTOCOL 2 was negotiated). Last GAME_DELTA sequence number sent (host; the client's is clientBoards->getSyncSeq()).
 
         TcpListener^ tcpListener; TcpClient^ opponentClient; NetworkStream^ opponentStream; // Networking: Listens for incoming TCP connections (for host). Represents the TCP connection to the opponent (for host). Stream for sending/receiving data with the opponent (for host).
         TcpClient^ serverConnection; NetworkStream^ serverStream; // Networking: Represents the TCP connection to the server (for client). Stream for sending/receiving data with the server (for client).
         Thread^ listenThread; Thread^ receiveThread; // Threading: Thread for the host to listen for client connections. Thread for receiving messages from the opponent/server.
 
         System::Collections::Generic::Queue<String^>^ UIMessageQueue; // A queue to hold messages received from network threads, to be processed by the UI thread.
+        System::Collections::Generic::Queue<String^>^ UIMessageBatch; // The batch the UI thread is working through; swapped with UIMessageQueue under queueLock.
         Object^ queueLock; // An object used for locking access to the UIMessageQueue to ensure thread safety.
-        System::Windows::Forms::Timer^ messageProcessTimer; // A UI timer that periodically checks the UIMessageQueue to process messages on the UI thread.
+        bool uiDrainPosted; // True while a DrainUIMessages call is queued on the UI thread (guarded by queueLock), so the receive thread posts one per batch.
+        bool drainingUIMessages; // True inside DrainUIMessages; a modal dialog shown while processing pumps messages and could otherwise re-enter it.
+        System::Windows::Forms::Timer^ messageProcessTimer; // A UI timer that drains the UIMessageQueue as a fallback, e.g. for messages that arrived before the window handle existed.
 
         array<Button^, 2>^ ownBoardButtons; // A 2D array of Buttons representing the cells on the player's own game board.
         array<Button^, 2>^ trackingBoardButtons; // A 2D array of Buttons representing the cells on the opponent's game board (tracking board).
@@ -82,7 +88,11 @@ namespace BattleshipGame { // Declares a namespace for the game to organize code
         void StartJoining(); // Networking method for a client to initiate joining a game.
         void ReceiveMessages(Object^ streamObj); // Method executed on a separate thread to continuously receive messages from the network stream.
         void ProcessUIMessage(String^ message); // Method to process a single message from the UIMessageQueue on the UI thread.
+        void DrainUIMessages(); // UI thread: takes every queued message in one lock and processes them in order.
         void SendNetMessage(NetworkStream^ stream, String^ message); // Method to send a message over a given NetworkStream.
+        void SendGameStateToClient(String^ gameUpdateMsg, bool moveAccepted); // Host: sends GAME_UPDATE to a v1 client, GAME_DELTA / GAME_SNAPSHOT to a v2 client.
+        String^ BuildGameUpdateMessage(); // Host: GAME_UPDATE for the current state of gameLogicServer (the one builder for every update it sends).
+        void ApplyGameDelta(const GameDelta& delta); // Client: updates the one changed cell, turn and status from a GAME_DELTA.
         void CleanUpNetworkResources(); // Method to close sockets, streams, and stop threads related to networking.
         void ResetGameAndUI(); // Method to reset the game state and UI elements to their initial state for a new game.
 
@@ -0,0 +1,87 @@
+// AllocationChecks.cpp
+// `Benchmarks --check-allocs`: restarting a game on an existing BattleshipGameLogic (and resetting
+// a player), and playing it out with MakeAttack/MakeComputerMove, must not touch the heap; nor
+// must parsing a protocol line or building a GAME_DELTA into a MessageBuilder already in use.
+// Exits non-zero, naming the case, if any of them allocates.
+#include "BenchHarness.h"
+#include "BattleShipGame.h"
+#include "Protocol.h"
+#include <cstdio>
+
+namespace {
+    const unsigned int CHECK_SEED = 12345;
+    const int CHECK_ROUNDS = 1000;
+
+    // Allocations made by 'body' over CHECK_ROUNDS calls, after one untimed warm-up call.
+    template <typename Body>
+    bool ExpectNoAllocations(const std::string& name, Body body) {
+        body(0);
+        AllocationTotals before = GetAllocationTotals();
+        for (int round = 1; round <= CHECK_ROUNDS; ++round) body(round);
+        AllocationTotals after = GetAllocationTotals();
+        long long count = after.count - before.count;
+        std::printf("%-48s %8lld allocs %10lld bytes over %d rounds  %s\n", name.c_str(), count, after.bytes - before.bytes,
+            CHECK_ROUNDS, count == 0 ? "ok" : "FAILED");
+        return count == 0;
+    }
+
+    template <int N>
+    bool CheckBoardSize() {
+        std::string size = std::to_string(N) + "x" + std::to_string(N);
+        bool ok = true;
+        BasicBattleshipGameLogic<N> logic;
+        const GameMode modes[] = { GameMode::PLAYER_VS_PLAYER, GameMode::PLAYER_VS_COMPUTER, GameMode::COMPUTER_VS_COMPUTER };
+        const char* modeNames[] = { "PvP", "PvC", "CvC" };
+        for (int m = 0; m < 3; ++m) {
+            ok &= ExpectNoAllocations("StartNewGame " + std::string(modeNames[m]) + " " + size, [&](int round) {
+                logic.StartNewGame("Host", "Guest", modes[m], mixSeed(CHECK_SEED, static_cast<uint64_t>(round)));
+            });
+        }
+        // Headless play never asks for the message text, so moves must not build it.
+        ok &= ExpectNoAllocations("MakeComputerMove CvC game " + size, [&](int round) {
+            logic.StartNewGame("Host", "Guest", GameMode::COMPUTER_VS_COMPUTER, mixSeed(CHECK_SEED, static_cast<uint64_t>(round)));
+            while (logic.MakeComputerMove().isAccepted()) {}
+        });
+        ok &= ExpectNoAllocations("MakeAttack PvP game " + size, [&](int round) {
+            logic.StartNewGame("Host", "Guest", GameMode::PLAYER_VS_PLAYER, mixSeed(CHECK_SEED, static_cast<uint64_t>(round)));
+            for (int cell = 0; cell < N * N && !logic.IsGameOver(); ) {
+                logic.MakeAttack(cell / N, cell % N); // Each cell twice: once per player
+                if (logic.GetCurrentTurnState() == GameTurn::PLAYER1) ++cell;
+            }
+        });
+        BasicPlayer<N>* player = logic.GetPlayer1ForUpdate();
+        GameRandom rng(CHECK_SEED);
+        ok &= ExpectNoAllocations("resetPlayer + placeShipsRandomly " + size, [&](int) {
+            player->resetPlayer();
+            player->placeShipsRandomly(rng);
+        });
+        return ok;
+    }
+
+    bool CheckProtocol() {
+        MessageBuilder out;
+        AttackEvent attack;
+        attack.attackerId = 1;
+        attack.row = 3;
+        attack.col = 7;
+        attack.outcome = AttackOutcome::HIT;
+        attack.nextTurn = GameTurn::PLAYER2;
+        return ExpectNoAllocations("ParseMessage + ParseGameDelta + BuildGameDelta", [&](int round) {
+            BuildGameDelta(out, MakeGameDelta(attack, static_cast<unsigned int>(round) + 1000000u, 2));
+            ProtocolMessage message;
+            GameDelta delta;
+            ParseMessage(out.GetText(), message);
+            ParseGameDelta(message, delta);
+        });
+    }
+}
+
+bool RunAllocationChecks() {
+    std::printf("sizeof(Ship)=%zu sizeof(Player)=%zu sizeof(BattleshipGameLogic)=%zu\n", sizeof(Ship), sizeof(Player), sizeof(BattleshipGameLogic));
+    bool ok = CheckBoardSize<10>();
+    ok &= CheckBoardSize<15>();
+    ok &= CheckBoardSize<20>();
+    ok &= CheckBoardSize<32>();
+    ok &= CheckProtocol();
+    return ok;
+}
@@ -0,0 +1,27 @@
+// AllocationCounter.cpp
+// Replaces the global operator new/delete so benchmark cases can report allocations per operation.
+#include "BenchHarness.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+    AllocationTotals totals;
+
+    void* CountedAllocate(std::size_t size) {
+        totals.count++;
+        totals.bytes += static_cast<long long>(size);
+        if (size == 0) size = 1;
+        void* p = std::malloc(size);
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+}
+
+AllocationTotals GetAllocationTotals() { return totals; }
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,63 @@
+// BenchHarness.h
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Minimal timing helpers shared by the benchmark cases. Every case runs from a fixed seed so
+// numbers are comparable between runs and builds.
+
+// Calls to the global operator new since program start (counted in AllocationCounter.cpp).
+// The benchmarks are single-threaded, so plain counters are enough.
+struct AllocationTotals {
+    long long count = 0;
+    long long bytes = 0;
+};
+AllocationTotals GetAllocationTotals();
+
+struct BenchResult {
+    std::string name;
+    long long operations = 0;
+    double totalNs = 0.0;
+    long long allocations = 0;
+    long long allocatedBytes = 0;
+    double NsPerOp() const { return operations > 0 ? totalNs / static_cast<double>(operations) : 0.0; }
+    double AllocsPerOp() const { return operations > 0 ? static_cast<double>(allocations) / static_cast<double>(operations) : 0.0; }
+    double BytesPerOp() const { return operations > 0 ? static_cast<double>(allocatedBytes) / static_cast<double>(operations) : 0.0; }
+};
+
+class BenchTimer {
+public:
+    void Start() {
+        startAllocations = GetAllocationTotals();
+        begin = std::chrono::steady_clock::now();
+    }
+    double StopNs() {
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+    // Adds the time and allocations since Start() to 'result' as 'operations' operations.
+    void StopInto(BenchResult& result, long long operations = 1) {
+        result.totalNs += StopNs();
+        AllocationTotals now = GetAllocationTotals();
+        result.allocations += now.count - startAllocations.count;
+        result.allocatedBytes += now.bytes - startAllocations.bytes;
+        result.operations += operations;
+    }
+private:
+    std::chrono::steady_clock::time_point begin;
+    AllocationTotals startAllocations;
+};
+
+// Every reported result, in order, for the --json output.
+inline std::vector<BenchResult>& ReportedBenchResults() {
+    static std::vector<BenchResult> results;
+    return results;
+}
+
+inline void PrintBenchResult(const BenchResult& result) {
+    std::printf("%-40s %12lld ops %12.1f ns/op %8.2f allocs/op %10.1f B/op\n", result.name.c_str(), result.operations,
+        result.NsPerOp(), result.AllocsPerOp(), result.BytesPerOp());
+    ReportedBenchResults().push_back(result);
+}
@@ -0,0 +1,49 @@
+// BoardSizeBenchmarks.cpp
+// Per-move and per-setup cost of the game core as the board grows (10, 15, 20, 32).
+#include "BenchHarness.h"
+#include "BattleShipGame.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 12345;
+
+    template <int N>
+    void RunBoardSizeBenchmarks(int games) {
+        std::mt19937 shotRng(BENCH_SEED);
+        std::vector<int> cells(N * N);
+        for (int i = 0; i < N * N; ++i) cells[i] = i;
+
+        BenchResult setup; setup.name = "StartNewGame " + std::to_string(N) + "x" + std::to_string(N);
+        BenchResult moves; moves.name = "MakeAttack " + std::to_string(N) + "x" + std::to_string(N);
+        BenchTimer timer;
+        BasicBattleshipGameLogic<N> logic;
+        for (int g = 0; g < games; ++g) {
+            std::shuffle(cells.begin(), cells.end(), shotRng); // Both players fire the same fixed order
+            timer.Start();
+            logic.StartNewGame("P1", "P2", GameMode::PLAYER_VS_PLAYER, mixSeed(BENCH_SEED, static_cast<uint64_t>(g)));
+            timer.StopInto(setup);
+
+            int p1Shot = 0, p2Shot = 0;
+            long long gameMoves = 0;
+            timer.Start();
+            while (!logic.IsGameOver()) {
+                int& next = (logic.GetCurrentTurnState() == GameTurn::PLAYER1) ? p1Shot : p2Shot;
+                int cell = cells[next++];
+                logic.MakeAttack(cell / N, cell % N);
+                gameMoves++;
+            }
+            timer.StopInto(moves, gameMoves);
+        }
+        PrintBenchResult(setup);
+        PrintBenchResult(moves);
+    }
+}
+
+void RunAllBoardSizeBenchmarks(int games) {
+    RunBoardSizeBenchmarks<10>(games);
+    RunBoardSizeBenchmarks<15>(games);
+    RunBoardSizeBenchmarks<20>(games);
+    RunBoardSizeBenchmarks<32>(games);
+}
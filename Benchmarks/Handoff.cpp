@@ -0,0 +1,65 @@
+// Handoff.cpp
+#include "Handoff.h"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventWakeup::EventWakeup() {
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+EventWakeup::~EventWakeup() {
+    if (fd >= 0) ::close(fd);
+}
+
+void EventWakeup::Signal() {
+    uint64_t one = 1;
+    ssize_t ignored = ::write(fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool EventWakeup::Wait(int timeoutMs) {
+    pollfd entry{ fd, POLLIN, 0 };
+    int ready;
+    do { ready = poll(&entry, 1, timeoutMs); } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) return false;
+    Clear();
+    return true;
+}
+
+void EventWakeup::Clear() {
+    uint64_t count;
+    ssize_t ignored = ::read(fd, &count, sizeof(count));
+    (void)ignored;
+}
+
+bool MakeInboundMessage(const ProtocolMessage& message, uint64_t connectionId, InboundMessage& out) {
+    out.connectionId = connectionId;
+    out.type = message.type;
+    out.argCount = 0;
+    out.textLength = 0;
+    out.text[0] = '\0';
+    switch (message.type) {
+    case MessageType::ATTACK:
+        if (!ParseField(message.GetField(1), out.args[0]) || !ParseField(message.GetField(2), out.args[1])) return false;
+        out.argCount = 2;
+        break;
+    case MessageType::PROTOCOL:
+        if (!ParseField(message.GetField(1), out.args[0])) return false;
+        out.argCount = 1;
+        break;
+    case MessageType::CONNECT_REQUEST: {
+        std::string_view name = message.GetRest(1);
+        size_t length = name.size() < static_cast<size_t>(InboundMessage::MAX_TEXT) ? name.size() : InboundMessage::MAX_TEXT;
+        std::memcpy(out.text, name.data(), length);
+        out.text[length] = '\0';
+        out.textLength = static_cast<uint8_t>(length);
+        break;
+    }
+    default:
+        break;
+    }
+    return true;
+}
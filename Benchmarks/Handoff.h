@@ -0,0 +1,159 @@
+// Handoff.h
+#pragma once
+#include "MessageCodec.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Moves parsed messages from a network thread to the thread that runs a session's game, without
+// locks: a bounded single-producer/single-consumer ring, plus an eventfd the consumer sleeps on
+// when the ring is empty. The consumer drains whatever has arrived in one pass, and the producer
+// only makes the eventfd syscall when the consumer is actually asleep.
+// Only HandoffBenchmarks uses it: the server's reactors run each session on the thread that reads
+// its sockets, so no message crosses threads there. It is kept to measure against Form1's locked
+// queue, and for a server that splits network and game threads.
+
+const size_t HANDOFF_CACHE_LINE = 64;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread. Capacity must be
+// a power of two. Each side keeps a cached copy of the other's index and rereads the shared one
+// only when the cached value says the ring is full (producer) or empty (consumer), so the index
+// cache lines move between cores about once per batch rather than once per message.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+public:
+    // Producer only. False (nothing stored) when the ring is full.
+    bool TryPush(const T& item) {
+        size_t tail = producer.tail.load(std::memory_order_relaxed);
+        if (tail - producer.cachedHead == Capacity) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            if (tail - producer.cachedHead == Capacity) return false;
+        }
+        slots[tail & (Capacity - 1)] = item;
+        producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls handle(const T&) for up to 'maxItems' items in order and frees their
+    // slots in one store at the end; returns how many it handled.
+    template <typename Handle>
+    size_t PopBatch(Handle handle, size_t maxItems = Capacity) {
+        size_t head = consumer.head.load(std::memory_order_relaxed);
+        if (consumer.cachedTail == head) {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            if (consumer.cachedTail == head) return 0;
+        }
+        size_t available = consumer.cachedTail - head;
+        size_t count = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < count; ++i) handle(slots[(head + i) & (Capacity - 1)]);
+        consumer.head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Either side; a snapshot that may be stale by the time it returns.
+    bool IsEmpty() const {
+        return producer.tail.load(std::memory_order_acquire) == consumer.head.load(std::memory_order_acquire);
+    }
+    static size_t GetCapacity() { return Capacity; }
+
+private:
+    struct alignas(HANDOFF_CACHE_LINE) ProducerSide {
+        std::atomic<size_t> tail{ 0 };
+        size_t cachedHead = 0;
+    };
+    struct alignas(HANDOFF_CACHE_LINE) ConsumerSide {
+        std::atomic<size_t> head{ 0 };
+        size_t cachedTail = 0;
+    };
+    ProducerSide producer;
+    ConsumerSide consumer;
+    alignas(HANDOFF_CACHE_LINE) T slots[Capacity];
+};
+
+// An eventfd as a wakeup: Signal() from any thread, Wait() from the one that sleeps on it. It can
+// also be added to an epoll set through GetFd().
+class EventWakeup {
+public:
+    EventWakeup();
+    ~EventWakeup();
+    EventWakeup(const EventWakeup&) = delete;
+    EventWakeup& operator=(const EventWakeup&) = delete;
+
+    int GetFd() const { return fd; }
+    void Signal();
+    // Blocks until signalled or 'timeoutMs' passes (-1: no limit) and clears the signal. False on
+    // timeout.
+    bool Wait(int timeoutMs);
+    void Clear(); // Consumes a pending signal, if any, without blocking
+
+private:
+    int fd = -1;
+};
+
+// A message as the network thread parsed it, self-contained so the game thread never touches the
+// connection's input buffer: the command, its numeric arguments and at most one short text field.
+struct InboundMessage {
+    static const int MAX_ARGS = 2;
+    static const int MAX_TEXT = 31;
+
+    uint64_t connectionId = 0;
+    uint64_t postedTicks = 0; // When posted, on whichever clock the poster reads; for handoff latency
+    MessageType type = MessageType::UNKNOWN;
+    uint8_t argCount = 0;
+    uint8_t textLength = 0;
+    int args[MAX_ARGS] = { 0, 0 };
+    char text[MAX_TEXT + 1] = {};
+};
+
+// Fills 'out' from a parsed line: ATTACK's row and column and PROTOCOL's version as args,
+// CONNECT_REQUEST's name (cut to MAX_TEXT bytes) as text. False when a numeric argument the
+// command needs is missing or not a number.
+bool MakeInboundMessage(const ProtocolMessage& message, uint64_t connectionId, InboundMessage& out);
+
+// One network thread hands messages to one game thread. Post never blocks: a full ring means the
+// game thread has fallen Capacity messages behind, and the caller decides what to drop.
+template <size_t Capacity>
+class MessageHandoff {
+public:
+    // Network thread.
+    bool Post(const InboundMessage& message) {
+        if (!ring.TryPush(message)) return false;
+        // Pairs with the fence in Wait: either this load sees the consumer going to sleep, or the
+        // consumer's recheck sees the message.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false, std::memory_order_relaxed)) {
+            wakeup.Signal();
+            wakeupsSent.store(wakeupsSent.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Game thread: handles everything posted so far, up to 'maxItems', and returns the count.
+    template <typename Handle>
+    size_t Drain(Handle handle, size_t maxItems = Capacity) { return ring.PopBatch(handle, maxItems); }
+
+    // Game thread: sleeps until something is posted or 'timeoutMs' passes. Returns at once when
+    // the ring is not empty.
+    void Wait(int timeoutMs) {
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ring.IsEmpty()) {
+            // The producer saw us asleep and is signalling; a signal that lands after this Clear only
+            // makes the next Wait return early.
+            if (!sleeping.exchange(false, std::memory_order_relaxed)) wakeup.Clear();
+            return;
+        }
+        wakeup.Wait(timeoutMs);
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    int GetWakeupFd() const { return wakeup.GetFd(); }
+    uint64_t GetWakeupsSent() const { return wakeupsSent.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing<InboundMessage, Capacity> ring;
+    alignas(HANDOFF_CACHE_LINE) std::atomic<bool> sleeping{ false };
+    std::atomic<uint64_t> wakeupsSent{ 0 }; // Written by the network thread only
+    EventWakeup wakeup;
+};
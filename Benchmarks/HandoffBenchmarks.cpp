@@ -0,0 +1,181 @@
+// HandoffBenchmarks.cpp
+// Handing received messages from a network thread to a game thread (Handoff.h) against the
+// mutex-protected queue Form1 uses, on the same stream: the ATTACK lines of whole games, which the
+// producer parses and posts and the consumer plays on a GameSession. Two runs per queue:
+//   flood  - the producer posts as fast as it can (throughput; a full ring makes it yield);
+//   paced  - bursts of PACED_BURST lines with a pause between, like moves arriving from clients
+//            (how long a message waits before the game thread handles it, and how often the game
+//            thread has to be woken).
+// POSIX only, like the server.
+#include "BenchHarness.h"
+#include "GameSession.h"
+#include "Handoff.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 31337;
+    const size_t RING_CAPACITY = 1024;
+    const int PACED_BURST = 8;
+    const int PACED_PAUSE_US = 200;
+    const size_t PACED_MESSAGES = 20000;
+    const int WAIT_TIMEOUT_MS = 100; // Like the reactor's tick; only matters if a wakeup were lost
+
+    uint64_t NowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Every accepted move of 'games' games, in the order played, as the lines a client sends.
+    struct MoveStream {
+        std::vector<std::string> lines;
+        std::vector<size_t> gameLengths;
+    };
+
+    MoveStream RecordGames(int games) {
+        MoveStream stream;
+        GameSession game;
+        MessageBuilder out;
+        for (int g = 0; g < games; ++g) {
+            uint64_t seed = mixSeed(BENCH_SEED, static_cast<uint64_t>(g));
+            game.StartNewGame("A", "B", GameMode::PLAYER_VS_PLAYER, seed);
+            std::mt19937 rng(static_cast<unsigned int>(seed));
+            int n = game.GetBoardSize();
+            std::vector<int> cells[2];
+            for (int seat = 0; seat < 2; ++seat) {
+                for (int i = 0; i < n * n; ++i) cells[seat].push_back(i);
+                std::shuffle(cells[seat].begin(), cells[seat].end(), rng);
+            }
+            size_t next[2] = { 0, 0 }, moves = 0;
+            while (!game.IsGameOver()) {
+                int seat = game.GetCurrentTurnState() == GameTurn::PLAYER1 ? 0 : 1;
+                int cell = cells[seat][next[seat]++];
+                if (!game.MakeAttack(cell / n, cell % n).isAccepted()) continue;
+                stream.lines.push_back(out.Begin(MessageType::ATTACK).Add(cell / n).Add(cell % n).GetText());
+                ++moves;
+            }
+            stream.gameLengths.push_back(moves);
+        }
+        return stream;
+    }
+
+    // The game thread's side: replays the recorded games move by move.
+    class GameThread {
+    public:
+        explicit GameThread(const MoveStream& s) : stream(s) { latencies.reserve(s.lines.size()); }
+        void Handle(const InboundMessage& message) {
+            if (played == 0) game.StartNewGame("A", "B", GameMode::PLAYER_VS_PLAYER, mixSeed(BENCH_SEED, static_cast<uint64_t>(gameIndex)));
+            if (message.type == MessageType::ATTACK && game.MakeAttack(message.args[0], message.args[1]).isAccepted()) ++accepted;
+            if (++played == stream.gameLengths[gameIndex]) { played = 0; ++gameIndex; }
+            latencies.push_back(NowNs() - message.postedTicks);
+            ++handled;
+        }
+        size_t handled = 0, accepted = 0, sleeps = 0;
+        std::vector<uint64_t> latencies;
+
+    private:
+        const MoveStream& stream;
+        GameSession game;
+        size_t gameIndex = 0, played = 0;
+    };
+
+    // What the network thread does with each line before handing it over.
+    bool ParseLine(const std::string& line, InboundMessage& message) {
+        ProtocolMessage parsed;
+        if (!ParseMessage(line, parsed) || !MakeInboundMessage(parsed, 1, message)) return false;
+        message.postedTicks = NowNs();
+        return true;
+    }
+
+    template <typename Post>
+    void Produce(const MoveStream& stream, size_t count, bool paced, Post post) {
+        InboundMessage message;
+        for (size_t i = 0; i < count; ++i) {
+            if (paced && i % PACED_BURST == 0 && i > 0) std::this_thread::sleep_for(std::chrono::microseconds(PACED_PAUSE_US));
+            if (ParseLine(stream.lines[i], message)) post(message);
+        }
+    }
+
+    // The lock-free handoff; the game thread drains all that has arrived, then sleeps on the eventfd.
+    void RunHandoff(const MoveStream& stream, size_t count, bool paced, GameThread& consumer) {
+        MessageHandoff<RING_CAPACITY> handoff;
+        std::thread game([&]() {
+            while (consumer.handled < count) {
+                if (handoff.Drain([&](const InboundMessage& message) { consumer.Handle(message); }) == 0) {
+                    ++consumer.sleeps;
+                    handoff.Wait(WAIT_TIMEOUT_MS);
+                }
+            }
+        });
+        Produce(stream, count, paced, [&](const InboundMessage& message) {
+            while (!handoff.Post(message)) std::this_thread::yield();
+        });
+        game.join();
+    }
+
+    // The baseline: one lock per message on each side and a notify per post, as Form1's receive
+    // thread and UI timer do (less the timer).
+    void RunMutexQueue(const MoveStream& stream, size_t count, bool paced, GameThread& consumer) {
+        std::mutex lock;
+        std::condition_variable posted;
+        std::deque<InboundMessage> queue;
+        std::thread game([&]() {
+            while (consumer.handled < count) {
+                std::unique_lock<std::mutex> held(lock);
+                if (queue.empty()) {
+                    ++consumer.sleeps;
+                    posted.wait(held, [&]() { return !queue.empty(); });
+                }
+                InboundMessage message = queue.front();
+                queue.pop_front();
+                held.unlock();
+                consumer.Handle(message);
+            }
+        });
+        Produce(stream, count, paced, [&](const InboundMessage& message) {
+            { std::lock_guard<std::mutex> held(lock); queue.push_back(message); }
+            posted.notify_one();
+        });
+        game.join();
+    }
+
+    uint64_t Percentile(std::vector<uint64_t>& values, double fraction) {
+        if (values.empty()) return 0;
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+        return values[index];
+    }
+
+    template <typename Run>
+    void Measure(const char* name, const MoveStream& stream, size_t count, bool paced, Run run) {
+        GameThread consumer(stream);
+        BenchTimer timer; // The producer is this thread, and the game thread does not allocate
+        BenchResult result;
+        result.name = name;
+        timer.Start();
+        run(stream, count, paced, consumer);
+        timer.StopInto(result, static_cast<long long>(consumer.handled));
+        if (!paced) PrintBenchResult(result);
+        else std::printf("%-40s %12lld msgs\n", name, result.operations);
+        uint64_t p50 = Percentile(consumer.latencies, 0.5), p99 = Percentile(consumer.latencies, 0.99);
+        std::printf("%-40s %10.1f us p50 %10.1f us p99 %8.3f sleeps/msg%s\n", "  handoff latency", p50 / 1000.0, p99 / 1000.0,
+            consumer.handled ? static_cast<double>(consumer.sleeps) / static_cast<double>(consumer.handled) : 0.0,
+            consumer.accepted == consumer.handled ? "" : "  (moves rejected: stream out of order)");
+    }
+}
+
+void RunAllHandoffBenchmarks(int games) {
+    MoveStream stream = RecordGames(games);
+    size_t flood = stream.lines.size();
+    size_t paced = std::min(flood, PACED_MESSAGES);
+    Measure("SPSC ring + eventfd, flood", stream, flood, false, RunHandoff);
+    Measure("mutex queue + condvar, flood", stream, flood, false, RunMutexQueue);
+    Measure("SPSC ring + eventfd, paced", stream, paced, true, RunHandoff);
+    Measure("mutex queue + condvar, paced", stream, paced, true, RunMutexQueue);
+}
@@ -0,0 +1,111 @@
+// MatchmakingBenchmarks.cpp
+// The server's Matchmaker (Server/Matchmaker.h): the cost of its operations with tens of
+// thousands of players waiting, and the pairing delays it produces for a stream of arrivals played
+// on a simulated clock (so the delays depend only on the seed, not on this machine).
+#include "BenchHarness.h"
+#include "Matchmaker.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 4242;
+    const int WAITING = 50000;
+    const int BATCH = 1024;
+
+    // Ratings 0, 2, 4, ... in buckets one point wide, never widening: nobody is paired, so all
+    // WAITING players stay queued while odd ratings (no partner) and even ones (a partner) arrive.
+    void MeasureOperations(int rounds) {
+        MatchmakerOptions options;
+        options.bucketWidth = 1;
+        options.widenEvery = std::chrono::milliseconds(0);
+        Matchmaker matchmaker(options);
+        Matchmaker::Clock::time_point now;
+        Matchmaker::Match match;
+        for (int i = 0; i < WAITING; ++i) matchmaker.Enqueue(static_cast<uint64_t>(i + 1), 2 * i, now, match);
+        std::mt19937 rng(BENCH_SEED);
+        std::vector<int> picks(BATCH);
+        for (int& pick : picks) pick = static_cast<int>(rng() % WAITING);
+
+        BenchTimer timer;
+        BenchResult queued; queued.name = "Enqueue + Cancel, 50000 waiting";
+        BenchResult paired; paired.name = "Enqueue (paired) + requeue, 50000 waiting";
+        uint64_t nextId = WAITING + 1;
+        for (int round = 0; round < rounds; ++round) {
+            timer.Start();
+            for (int pick : picks) {
+                uint64_t id = nextId++;
+                matchmaker.Enqueue(id, 2 * pick + 1, now, match);
+                matchmaker.Cancel(id);
+            }
+            timer.StopInto(queued, BATCH);
+            timer.Start();
+            for (int pick : picks) {
+                if (matchmaker.Enqueue(nextId++, 2 * pick, now, match)) matchmaker.Enqueue(match.first, 2 * pick, now, match); // Puts the partner back
+            }
+            timer.StopInto(paired, BATCH);
+        }
+        PrintBenchResult(queued);
+        PrintBenchResult(paired);
+        if (matchmaker.GetWaitingCount() != static_cast<size_t>(WAITING)) std::printf("  unexpected waiting count %zu\n", matchmaker.GetWaitingCount());
+    }
+
+    // Poisson arrivals with normally distributed ratings; Expire runs every tick like
+    // SessionHost::OnTick. Waits are measured on the simulated clock.
+    void SimulateArrivals(int players) {
+        const double ARRIVALS_PER_SECOND = 500.0;
+        const std::chrono::milliseconds TICK(100);
+        MatchmakerOptions options;
+        options.bucketWidth = 25;
+        options.widenEvery = std::chrono::milliseconds(1000);
+        options.computerAfter = std::chrono::milliseconds(20000);
+        Matchmaker matchmaker(options);
+        std::mt19937 rng(BENCH_SEED);
+        std::exponential_distribution<double> gap(ARRIVALS_PER_SECOND);
+        std::normal_distribution<double> rating(DEFAULT_RATING, 300.0);
+
+        typedef Matchmaker::Clock Clock;
+        Clock::time_point start, now, nextTick = start + TICK;
+        std::vector<Clock::time_point> arrived(static_cast<size_t>(players) + 1);
+        std::vector<double> waits;
+        waits.reserve(static_cast<size_t>(players));
+        std::vector<Matchmaker::Match> due;
+        size_t computerMatches = 0, peakWaiting = 0;
+        auto record = [&](const Matchmaker::Match& match) {
+            waits.push_back(std::chrono::duration<double>(now - arrived[match.first]).count());
+            if (match.second == Matchmaker::COMPUTER) ++computerMatches;
+            else waits.push_back(std::chrono::duration<double>(now - arrived[match.second]).count());
+        };
+
+        BenchTimer timer;
+        BenchResult result; result.name = "simulated arrivals, per player";
+        timer.Start();
+        for (int i = 1; i <= players; ++i) {
+            Clock::time_point at = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+            while (nextTick <= at) { // Ticks due before this arrival
+                now = nextTick;
+                matchmaker.Expire(now, due);
+                for (const Matchmaker::Match& match : due) record(match);
+                due.clear();
+                nextTick += TICK;
+            }
+            now = at;
+            arrived[static_cast<size_t>(i)] = now;
+            Matchmaker::Match match;
+            if (matchmaker.Enqueue(static_cast<uint64_t>(i), static_cast<int>(rating(rng)), now, match)) record(match);
+            peakWaiting = std::max(peakWaiting, matchmaker.GetWaitingCount());
+        }
+        timer.StopInto(result, players);
+        PrintBenchResult(result);
+        std::sort(waits.begin(), waits.end());
+        auto at = [&](double q) { return waits.empty() ? 0.0 : waits[static_cast<size_t>(q * static_cast<double>(waits.size() - 1))]; };
+        std::printf("%-40s %8.3f s p50 %8.3f s p90 %8.3f s p99 %6zu peak waiting %5.2f%% vs computer\n", "  pairing delay", at(0.5), at(0.9), at(0.99),
+            peakWaiting, waits.empty() ? 0.0 : 100.0 * static_cast<double>(computerMatches) / static_cast<double>(waits.size()));
+    }
+}
+
+void RunAllMatchmakingBenchmarks(int games) {
+    MeasureOperations(std::max(1, games / 20));
+    SimulateArrivals(std::max(1000, games * 50));
+}
@@ -0,0 +1,190 @@
+// MetricsBenchmarks.cpp
+// Cost of the server's metrics (Server/Metrics.h) on the move path: what a reactor thread does
+// for one ATTACK line - read it, parse it, MakeAttack, and send a GAME_DELTA to each seat.
+// Socket calls vary by far more than the metrics cost, so the two are measured apart: the metrics'
+// cost per move is the difference between the path with and without them with the sockets left
+// out, each game played both ways in turn. The budget is a share of the path a server move
+// actually takes, socket calls included, measured over local socket pairs (which still lack epoll
+// and TCP, so the real share is smaller). The share of the socket-free path is printed too; it is
+// several times larger, as the socket calls are most of a move. `--check-metrics` exits non-zero
+// when the share of the socket path is over METRICS_BUDGET. POSIX only, like the server.
+#include "BenchHarness.h"
+#include "GameSession.h"
+#include "Metrics.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <random>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 2024;
+    const int ROUNDS = 9;               // The median round's difference counts
+    const double METRICS_BUDGET = 0.01; // Of the move path over socket pairs
+    const int DRAIN_EVERY = 32;         // The clients read their updates in batches of this many
+
+    // The counters and histograms one reactor thread and its SessionHost keep.
+    struct MoveMetrics {
+        LatencyHistogram dispatchLatency, attackLatency, sendLatency;
+        std::atomic<uint64_t> linesReceived{ 0 }, movesPlayed{ 0 }, bytesSent{ 0 };
+    };
+
+    // Both seats shoot their cells in a shuffled order. With sockets, seat s sends its ATTACK
+    // lines on inbound[s] and reads its updates from outbound[s] (index 0 is the server's end);
+    // without, lines come from memory and updates go to a buffer that is dropped.
+    class MovePath {
+    public:
+        explicit MovePath(bool sockets) : useSockets(sockets) {
+            for (int seat = 0; useSockets && seat < 2; ++seat) {
+                if (socketpair(AF_UNIX, SOCK_STREAM, 0, inbound[seat]) != 0 || socketpair(AF_UNIX, SOCK_STREAM, 0, outbound[seat]) != 0)
+                    std::fprintf(stderr, "socketpair failed\n");
+            }
+        }
+        ~MovePath() {
+            for (int seat = 0; useSockets && seat < 2; ++seat) {
+                for (int end = 0; end < 2; ++end) { close(inbound[seat][end]); close(outbound[seat][end]); }
+            }
+        }
+        MovePath(const MovePath&) = delete;
+        MovePath& operator=(const MovePath&) = delete;
+
+        // The same seed gives the same fleets and the same shots.
+        void NewGame(uint64_t seed) {
+            game.StartNewGame("A", "B", GameMode::PLAYER_VS_PLAYER, seed);
+            std::mt19937 rng(static_cast<unsigned int>(seed));
+            int n = game.GetBoardSize();
+            for (int seat = 0; seat < 2; ++seat) {
+                std::vector<int> cells(static_cast<size_t>(n) * n);
+                for (size_t i = 0; i < cells.size(); ++i) cells[i] = static_cast<int>(i);
+                std::shuffle(cells.begin(), cells.end(), rng);
+                lines[seat].clear();
+                for (int cell : cells) lines[seat] += "ATTACK " + std::to_string(cell / n) + " " + std::to_string(cell % n) + "\n";
+                next[seat] = 0;
+                if (!useSockets) continue;
+                char discard[4096];
+                while (recv(inbound[seat][0], discard, sizeof(discard), MSG_DONTWAIT) > 0) {} // The last game's unused shots
+                send(inbound[seat][1], lines[seat].data(), lines[seat].size(), 0);
+            }
+            seq = 0;
+        }
+        bool IsGameOver() const { return game.IsGameOver(); }
+
+        // One move of the player to move; 'metrics' null for the bare path.
+        void Move(MoveMetrics* metrics) {
+            int seat = game.GetCurrentTurnState() == GameTurn::PLAYER1 ? 0 : 1;
+            size_t end = lines[seat].find('\n', next[seat]);
+            size_t length = end - next[seat];
+            if (useSockets) recv(inbound[seat][0], line, length + 1, MSG_WAITALL);
+            else lines[seat].copy(line, length + 1, next[seat]);
+            next[seat] = end + 1;
+            if (!metrics) { Dispatch(length, nullptr); return; }
+            AddToCounter(metrics->linesReceived, 1);
+            ScopedLatency timing(metrics->dispatchLatency);
+            Dispatch(length, metrics);
+        }
+
+    private:
+        bool useSockets;
+        GameSession game;
+        std::string lines[2];
+        size_t next[2] = { 0, 0 };
+        int inbound[2][2] = { { -1, -1 }, { -1, -1 } };
+        int outbound[2][2] = { { -1, -1 }, { -1, -1 } };
+        int unread[2] = { 0, 0 }; // Updates sent and not yet drained
+        char line[32];
+        MessageBuilder out;
+        std::string message;
+        unsigned int seq = 0;
+
+        void Dispatch(size_t length, MoveMetrics* metrics) {
+            ProtocolMessage parsed;
+            int r = 0, c = 0;
+            if (!ParseMessage(std::string_view(line, length), parsed) || !ParseField(parsed.GetField(1), r) || !ParseField(parsed.GetField(2), c)) return;
+            AttackEvent event;
+            if (metrics) {
+                ScopedLatency timing(metrics->attackLatency);
+                event = game.MakeAttack(r, c);
+            }
+            else event = game.MakeAttack(r, c);
+            if (!event.isAccepted()) return;
+            if (metrics) AddToCounter(metrics->movesPlayed, 1);
+            ++seq;
+            for (int receiver = 0; receiver < 2; ++receiver) {
+                BuildGameDelta(out, MakeGameDelta(event, seq, receiver + 1));
+                message = out.GetText(); // Reactor::Send's copy into the connection's buffer
+                message += '\n';
+                if (!metrics) { Send(receiver); continue; }
+                ScopedLatency timing(metrics->sendLatency);
+                AddToCounter(metrics->bytesSent, Send(receiver));
+            }
+        }
+
+        size_t Send(int seat) {
+            if (!useSockets) { message.clear(); return 0; }
+            ssize_t sent = send(outbound[seat][0], message.data(), message.size(), MSG_NOSIGNAL);
+            if (++unread[seat] == DRAIN_EVERY) {
+                char buffer[16384];
+                while (recv(outbound[seat][1], buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {}
+                unread[seat] = 0;
+            }
+            return sent > 0 ? static_cast<size_t>(sent) : 0;
+        }
+    };
+
+    void PlayGame(MovePath& path, uint64_t seed, MoveMetrics* metrics, BenchTimer& timer, BenchResult& result) {
+        path.NewGame(seed);
+        timer.Start();
+        long long played = 0;
+        while (!path.IsGameOver()) { path.Move(metrics); ++played; }
+        timer.StopInto(result, played);
+    }
+
+    void Report(const char* name, double nsPerMove, long long moves) {
+        BenchResult result;
+        result.name = name;
+        result.operations = moves;
+        result.totalNs = nsPerMove * static_cast<double>(moves);
+        PrintBenchResult(result);
+    }
+
+    // Prints the paths and returns the metrics' share of the move path over socket pairs.
+    double MeasureOverhead(int games) {
+        MovePath inProcess(false), withSockets(true);
+        MoveMetrics metrics;
+        BenchTimer timer;
+        std::vector<BenchResult> bare(ROUNDS), instrumented(ROUNDS);
+        std::vector<double> differences(ROUNDS);
+        for (int round = 0; round < ROUNDS; ++round) {
+            for (int g = 0; g < games; ++g) { // Alternating which goes first, so neither gets the warmer caches
+                uint64_t seed = mixSeed(BENCH_SEED, static_cast<uint64_t>(g));
+                if (g & 1) PlayGame(inProcess, seed, &metrics, timer, instrumented[round]);
+                PlayGame(inProcess, seed, nullptr, timer, bare[round]);
+                if (!(g & 1)) PlayGame(inProcess, seed, &metrics, timer, instrumented[round]);
+            }
+            differences[round] = instrumented[round].NsPerOp() - bare[round].NsPerOp();
+        }
+        std::vector<double> sorted = differences;
+        std::nth_element(sorted.begin(), sorted.begin() + ROUNDS / 2, sorted.end());
+        double overhead = sorted[ROUNDS / 2];
+        int median = static_cast<int>(std::find(differences.begin(), differences.end(), overhead) - differences.begin());
+        Report("move path without sockets", bare[median].NsPerOp(), bare[median].operations);
+        Report("move path without sockets + metrics", instrumented[median].NsPerOp(), instrumented[median].operations);
+        BenchResult full;
+        for (int g = 0; g < games; ++g) PlayGame(withSockets, mixSeed(BENCH_SEED, static_cast<uint64_t>(g)), nullptr, timer, full);
+        Report("move path over socket pairs", full.NsPerOp(), full.operations);
+        double share = overhead / full.NsPerOp();
+        double bareShare = overhead / bare[median].NsPerOp();
+        std::printf("%-40s %+.1f ns/move, %.2f%% of the path over socket pairs (budget %.0f%%), %.2f%% without sockets  %s\n",
+            "metrics overhead", overhead, 100.0 * share, 100.0 * METRICS_BUDGET, 100.0 * bareShare, share <= METRICS_BUDGET ? "ok" : "FAILED");
+        return share;
+    }
+}
+
+void RunAllMetricsBenchmarks(int games) {
+    MeasureOverhead(games);
+}
+
+bool RunMetricsCheck() {
+    return MeasureOverhead(2000) <= METRICS_BUDGET;
+}
@@ -0,0 +1,101 @@
+// PlayerBenchmarks.cpp
+// Per-call cost of the Player operations the game loop and the network code run on every
+// setup or move: placement, attacks on the own board, tracking updates and board strings.
+#include "BenchHarness.h"
+#include "BattleShipGame.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 12345;
+
+    void AddDefaultFleet(Player& player) {
+        for (ShipTypeId type : DEFAULT_FLEET) player.addShipDefinition(type);
+    }
+}
+
+void RunAllPlayerBenchmarks(int games) {
+    const int N = Player::BOARD_SIZE;
+    GameRandom rng(BENCH_SEED);
+    std::mt19937 shotRng(BENCH_SEED);
+    std::vector<int> cells(Player::CELL_COUNT);
+    for (int i = 0; i < Player::CELL_COUNT; ++i) cells[i] = i;
+    BenchTimer timer;
+
+    Player defender("Defender");
+    Player attacker("Attacker");
+    Player mirror("Mirror");
+    Player crowded("Crowded"); // Three classic fleets (51 of 100 cells), where placement has to backtrack
+    AddDefaultFleet(defender);
+    AddDefaultFleet(attacker);
+    for (int i = 0; i < 3; ++i) AddDefaultFleet(crowded);
+
+    BenchResult randomPlacement; randomPlacement.name = "Player::placeShipsRandomly";
+    BenchResult crowdedPlacement; crowdedPlacement.name = "Player::placeShipsRandomly 3 fleets";
+    BenchResult placement; placement.name = "Player::placeShip";
+    BenchResult attacks; attacks.name = "Player::receiveAttack";
+    BenchResult tracking; tracking.name = "Player::processAttackResult";
+    BenchResult roundTrip; roundTrip.name = "Player board string round trip";
+    BenchResult deltaSync; deltaSync.name = "Player::applyBoardDelta";
+    std::vector<BoardCellDelta> deltas(Player::CELL_COUNT);
+
+    for (int g = 0; g < games; ++g) {
+        // placeShip: every ship of the fleet at a legal spot (each call first lifts the previous placement)
+        for (int i = 0; i < DEFAULT_FLEET_COUNT; ++i) {
+            int size = SHIP_TYPES[DEFAULT_FLEET[i]].size;
+            timer.Start();
+            attacker.placeShip(i, 2 * i, g % (N - size + 1), true);
+            timer.StopInto(placement);
+        }
+
+        defender.initializeBoards();
+        timer.Start();
+        defender.placeShipsRandomly(rng);
+        timer.StopInto(randomPlacement);
+
+        crowded.initializeBoards();
+        timer.Start();
+        crowded.placeShipsRandomly(rng);
+        timer.StopInto(crowdedPlacement);
+
+        // The own board out to a string and back in, as a Form1 client does with every GAME_UPDATE
+        timer.Start();
+        mirror.setOwnBoardFromString(defender.getOwnBoardAsString());
+        timer.StopInto(roundTrip);
+        mirror.setSyncSeq(0);
+
+        // Every cell once, in a fixed random order: receiveAttack on the defender, then the
+        // attacker records each result on its tracking board
+        std::shuffle(cells.begin(), cells.end(), shotRng);
+        std::vector<char> results(Player::CELL_COUNT);
+        timer.Start();
+        for (int i = 0; i < Player::CELL_COUNT; ++i) {
+            AttackResult result = defender.receiveAttack(cells[i] / N, cells[i] % N);
+            results[i] = result.isHit() ? HIT_CHAR : MISS_CHAR;
+        }
+        timer.StopInto(attacks, Player::CELL_COUNT);
+
+        // The same shots reaching the mirror one changed cell at a time, as GAME_DELTA does
+        for (int i = 0; i < Player::CELL_COUNT; ++i) {
+            deltas[i].seq = static_cast<unsigned int>(i + 1);
+            deltas[i].cell = cells[i];
+            deltas[i].state = results[i];
+        }
+        timer.Start();
+        for (int i = 0; i < Player::CELL_COUNT; ++i) mirror.applyBoardDelta(deltas[i]);
+        timer.StopInto(deltaSync, Player::CELL_COUNT);
+
+        attacker.initializeBoards();
+        timer.Start();
+        for (int i = 0; i < Player::CELL_COUNT; ++i) attacker.processAttackResult(cells[i] / N, cells[i] % N, results[i], defender);
+        timer.StopInto(tracking, Player::CELL_COUNT);
+    }
+    PrintBenchResult(randomPlacement);
+    PrintBenchResult(crowdedPlacement);
+    PrintBenchResult(placement);
+    PrintBenchResult(attacks);
+    PrintBenchResult(tracking);
+    PrintBenchResult(roundTrip);
+    PrintBenchResult(deltaSync);
+}
@@ -0,0 +1,158 @@
+// ProtocolBenchmarks.cpp
+// Throughput of the protocol codec (MessageCodec.h, Protocol.h): tokenizing and dispatching the
+// lines a host receives, and parsing and building the updates it sends, each into a reused
+// MessageBuilder as SessionHost does.
+#include "BenchHarness.h"
+#include "Protocol.h"
+#include <random>
+#include <vector>
+
+namespace {
+    const unsigned int BENCH_SEED = 777;
+    const int LINES = 1024; // Messages per timed batch
+
+    // Stands in for SessionHost: every handler reads its fields the way the real one does.
+    class CountingHandler {
+    public:
+        typedef MessageDispatcher<CountingHandler, int&> Dispatcher;
+        static Dispatcher MakeDispatcher() {
+            Dispatcher table;
+            table.On(MessageType::CONNECT_REQUEST, &CountingHandler::OnName)
+                .On(MessageType::READY, &CountingHandler::OnCommand)
+                .On(MessageType::ATTACK, &CountingHandler::OnAttack, 2)
+                .On(MessageType::PROTOCOL, &CountingHandler::OnProtocol, 1)
+                .On(MessageType::RESYNC, &CountingHandler::OnCommand)
+                .On(MessageType::GAME_DELTA, &CountingHandler::OnDelta, 8);
+            return table;
+        }
+        long long checksum = 0;
+
+    private:
+        void OnName(const ProtocolMessage& message, int& handled) { checksum += static_cast<long long>(message.GetRest(1).size()); ++handled; }
+        void OnCommand(const ProtocolMessage& message, int& handled) { checksum += static_cast<int>(message.type); ++handled; }
+        void OnAttack(const ProtocolMessage& message, int& handled) {
+            int r = 0, c = 0;
+            if (ParseField(message.fields[1], r) && ParseField(message.fields[2], c)) checksum += r * 32 + c;
+            ++handled;
+        }
+        void OnProtocol(const ProtocolMessage& message, int& handled) {
+            int version = 0;
+            if (ParseField(message.fields[1], version)) checksum += version;
+            ++handled;
+        }
+        void OnDelta(const ProtocolMessage& message, int& handled) {
+            GameDelta delta;
+            if (ParseGameDelta(message, delta)) checksum += delta.seq;
+            ++handled;
+        }
+    };
+
+    // Mostly ATTACK lines, as on a busy host, with the rest of the client commands mixed in.
+    std::vector<std::string> MakeClientLines(std::mt19937& rng) {
+        std::vector<std::string> lines;
+        MessageBuilder out;
+        for (int i = 0; i < LINES; ++i) {
+            int kind = static_cast<int>(rng() % 16);
+            if (kind == 0) lines.push_back("CONNECT_REQUEST Player " + std::to_string(i));
+            else if (kind == 1) lines.push_back("READY");
+            else if (kind == 2) lines.push_back("RESYNC");
+            else if (kind == 3) lines.push_back("PROTOCOL 2");
+            else if (kind == 4) lines.push_back("CHAT hello"); // Unknown: looked up and dropped
+            else lines.push_back(out.Begin(MessageType::ATTACK).Add(static_cast<int>(rng() % 10)).Add(static_cast<int>(rng() % 10)).GetText());
+        }
+        return lines;
+    }
+
+    GameDelta MakeDelta(std::mt19937& rng, unsigned int seq) {
+        GameDelta delta;
+        delta.seq = seq;
+        delta.attackerId = 1 + static_cast<int>(rng() % 2);
+        delta.row = static_cast<int>(rng() % 10);
+        delta.col = static_cast<int>(rng() % 10);
+        const char results[] = { MISS_CHAR, HIT_CHAR, SUNK_RESULT_CHAR };
+        delta.result = results[rng() % 3];
+        delta.sunkShipIndex = delta.result == SUNK_RESULT_CHAR ? static_cast<int>(rng() % DEFAULT_FLEET_COUNT) : NO_SHIP_INDEX;
+        delta.nextTurnId = 1 + static_cast<int>(rng() % 2);
+        return delta;
+    }
+
+    void PrintRate(const BenchResult& result) {
+        PrintBenchResult(result);
+        double ns = result.NsPerOp();
+        std::printf("%-40s %12.2f M messages/s\n", ("  " + result.name).c_str(), ns > 0.0 ? 1000.0 / ns : 0.0);
+    }
+
+    // Runs 'body' over every line of a batch, 'rounds' times; one timer read per batch.
+    template <typename Body>
+    void TimeBatches(BenchResult& result, int rounds, int count, Body body) {
+        BenchTimer timer;
+        for (int round = 0; round < rounds; ++round) {
+            timer.Start();
+            for (int i = 0; i < count; ++i) body(i);
+            timer.StopInto(result, count);
+        }
+    }
+}
+
+void RunAllProtocolBenchmarks(int games) {
+    std::mt19937 rng(BENCH_SEED);
+    int rounds = games;
+
+    std::vector<std::string> clientLines = MakeClientLines(rng);
+    const CountingHandler::Dispatcher dispatcher = CountingHandler::MakeDispatcher();
+    CountingHandler handler;
+    int handled = 0;
+    BenchResult dispatch; dispatch.name = "ParseMessage + dispatch, client lines";
+    TimeBatches(dispatch, rounds, LINES, [&](int i) {
+        ProtocolMessage message;
+        if (ParseMessage(clientLines[i], message)) dispatcher.Dispatch(handler, message, handled);
+    });
+    PrintRate(dispatch);
+
+    std::vector<std::string> deltaLines;
+    MessageBuilder out;
+    for (int i = 0; i < LINES; ++i) { BuildGameDelta(out, MakeDelta(rng, static_cast<unsigned int>(i + 1))); deltaLines.push_back(out.GetText()); }
+    BenchResult parseDelta; parseDelta.name = "ParseMessage + ParseGameDelta";
+    TimeBatches(parseDelta, rounds, LINES, [&](int i) {
+        ProtocolMessage message;
+        GameDelta delta;
+        if (ParseMessage(deltaLines[i], message) && ParseGameDelta(message, delta)) handler.checksum += delta.row;
+    });
+    PrintRate(parseDelta);
+
+    std::vector<GameDelta> deltas;
+    for (int i = 0; i < LINES; ++i) deltas.push_back(MakeDelta(rng, static_cast<unsigned int>(i + 1)));
+    BenchResult buildDelta; buildDelta.name = "BuildGameDelta";
+    TimeBatches(buildDelta, rounds, LINES, [&](int i) {
+        BuildGameDelta(out, deltas[i]);
+        handler.checksum += static_cast<long long>(out.GetText().size());
+    });
+    PrintRate(buildDelta);
+
+    // Full-state updates for a 10x10 game in progress, as SessionHost::SendFullState builds them.
+    std::string boards[2] = { std::string(100, WATER_CHAR), std::string(100, WATER_CHAR) };
+    for (int cell = 0; cell < 100; cell += 3) boards[cell & 1][cell] = (cell % 7) ? MISS_CHAR : HIT_CHAR;
+    std::string action = "Host attacked (4,5): HIT! Now Guest's turn.";
+    GameUpdate update;
+    update.seq = 42;
+    update.turnId = 2;
+    update.player1Board = boards[0];
+    update.player2Board = boards[1];
+    update.action = action;
+    BenchResult buildUpdate; buildUpdate.name = "BuildGameSnapshot 10x10";
+    TimeBatches(buildUpdate, rounds / 4 + 1, LINES, [&](int) {
+        BuildGameSnapshot(out, update);
+        handler.checksum += static_cast<long long>(out.GetText().size());
+    });
+    PrintRate(buildUpdate);
+
+    std::string snapshotLine = out.GetText();
+    BenchResult parseUpdate; parseUpdate.name = "ParseMessage + ParseGameUpdate 10x10";
+    TimeBatches(parseUpdate, rounds / 4 + 1, LINES, [&](int) {
+        ProtocolMessage message;
+        GameUpdate parsed;
+        if (ParseMessage(snapshotLine, message) && ParseGameUpdate(message, parsed)) handler.checksum += parsed.turnId;
+    });
+    PrintRate(parseUpdate);
+    if (handler.checksum == 42) std::printf("\n"); // Keeps the work observable
+}
@@ -0,0 +1,91 @@
+// RuleChecks.cpp
+// `Benchmarks --check-rules`: the outcomes the game logic promises for moves and fleets it
+// rejects. Prints one line per case and exits non-zero if any fails.
+#include "BattleShipGame.h"
+#include <cstdio>
+#include <string>
+
+namespace {
+    const uint64_t CHECK_SEED = 31337;
+
+    bool Report(const std::string& name, bool ok) {
+        std::printf("%-64s %s\n", name.c_str(), ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // The same cell fired at twice by the same player: ALREADY_TARGETED, and still that player's turn.
+    bool CheckRepeatedShot() {
+        BattleshipGameLogic logic;
+        logic.StartNewGame("Host", "Guest", GameMode::PLAYER_VS_PLAYER, CHECK_SEED);
+        GameTurn first = logic.GetCurrentTurnState();
+        AttackEvent shot = logic.MakeAttack(4, 4);
+        AttackEvent reply = logic.MakeAttack(4, 4); // The other player may fire at the same cell of its own target
+        AttackEvent again = logic.MakeAttack(4, 4);
+        bool ok = shot.isAccepted() && reply.isAccepted() && logic.GetCurrentTurnState() == first;
+        ok &= again.outcome == AttackOutcome::ALREADY_TARGETED && again.attackerId == shot.attackerId && !again.isAccepted();
+        ok &= logic.GetCurrentTurnState() == first && logic.GetLastAttack().outcome == reply.outcome;
+        return Report("same cell fired at twice -> ALREADY_TARGETED, turn kept", ok);
+    }
+
+    bool CheckOutOfRangeShot() {
+        BattleshipGameLogic logic;
+        logic.StartNewGame("Host", "Guest", GameMode::PLAYER_VS_PLAYER, CHECK_SEED);
+        GameTurn first = logic.GetCurrentTurnState();
+        AttackEvent below = logic.MakeAttack(-1, 0);
+        AttackEvent beyond = logic.MakeAttack(0, BOARD_SIZE_CONST);
+        bool ok = below.outcome == AttackOutcome::INVALID && beyond.outcome == AttackOutcome::INVALID;
+        return Report("shot off the board -> INVALID, turn kept", ok && logic.GetCurrentTurnState() == first);
+    }
+
+    // Ships come from SHIP_TYPES only; anything else is refused rather than made up.
+    bool CheckShipTypes() {
+        Player player;
+        bool ok = player.addShipDefinition(CRUISER) && !player.addShipDefinition(NO_SHIP_TYPE)
+            && !player.addShipDefinition(SHIP_TYPE_COUNT) && !player.addShipDefinition(-1) && player.getShipCount() == 1;
+        ok &= std::string(player.getShip(0).getName()) == "Cruiser" && player.getShip(0).getSize() == 3;
+        for (int i = 1; i < MAX_FLEET_SIZE; ++i) ok &= player.addShipDefinition(DESTROYER);
+        ok &= !player.addShipDefinition(DESTROYER); // Full
+        return Report("unknown ship types and a full fleet refused", ok);
+    }
+
+    BoardCellDelta OwnCell(unsigned int seq, int cell, char state, int shipIndex = NO_SHIP_INDEX) {
+        BoardCellDelta delta;
+        delta.seq = seq; delta.cell = cell; delta.state = state; delta.shipIndex = shipIndex;
+        return delta;
+    }
+
+    // A mirror with no ships placed records the ship a delta names, and refuses a different one later.
+    bool CheckDeltaShipIndex() {
+        Player mirror("Client");
+        bool ok = mirror.applyBoardDelta(OwnCell(1, 7, HIT_CHAR, 2)) == BoardSyncResult::APPLIED && mirror.getShipIndexAt(0, 7) == 2;
+        ok &= mirror.applyBoardDelta(OwnCell(2, 7, HIT_CHAR, 3)) == BoardSyncResult::INVALID;
+        ok &= mirror.applyBoardDelta(OwnCell(2, 8, MISS_CHAR, 1)) == BoardSyncResult::INVALID; // A ship on a miss
+        ok &= mirror.applyBoardDelta(OwnCell(2, 8, SHIP_CHAR, MAX_FLEET_SIZE)) == BoardSyncResult::INVALID;
+        ok &= mirror.applyBoardDelta(OwnCell(2, 7, WATER_CHAR)) == BoardSyncResult::APPLIED && mirror.getShipIndexAt(0, 7) == NO_SHIP_INDEX;
+        return Report("board delta records the ship it names", ok && mirror.getSyncSeq() == 2);
+    }
+
+    // The cells of a placed ship cannot turn to water or a miss, which would part the ship from its cells.
+    bool CheckDeltaOnPlacedShip() {
+        Player player;
+        bool ok = player.addShipDefinition(DESTROYER) && player.placeShip(0, 0, 0, true);
+        ok &= player.applyBoardDelta(OwnCell(1, 0, WATER_CHAR)) == BoardSyncResult::INVALID;
+        ok &= player.applyBoardDelta(OwnCell(1, 0, MISS_CHAR)) == BoardSyncResult::INVALID;
+        ok &= player.applyBoardDelta(OwnCell(1, 5, SHIP_CHAR, 0)) == BoardSyncResult::INVALID; // Placed on other cells
+        ok &= player.getOwnShipMask().test(0) && player.getShipIndexAt(0, 0) == 0 && player.getSyncSeq() == 0;
+        ok &= player.applyBoardDelta(OwnCell(1, 0, HIT_CHAR)) == BoardSyncResult::APPLIED;
+        ok &= player.applyBoardDelta(OwnCell(2, 1, HIT_CHAR, 0)) == BoardSyncResult::APPLIED && player.getShip(0).isSunk();
+        player.setOwnBoardFromString(std::string(Player::CELL_COUNT, WATER_CHAR));
+        ok &= player.getOwnShipMask().test(0) && player.getOwnShipMask().test(1) && player.getShipIndexAt(0, 1) == 0;
+        return Report("board delta keeps a placed ship's cells ship cells", ok);
+    }
+}
+
+bool RunRuleChecks() {
+    bool ok = CheckRepeatedShot();
+    ok &= CheckOutOfRangeShot();
+    ok &= CheckShipTypes();
+    ok &= CheckDeltaShipIndex();
+    ok &= CheckDeltaOnPlacedShip();
+    return ok;
+}
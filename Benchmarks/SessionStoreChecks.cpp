@@ -0,0 +1,315 @@
+// SessionStoreChecks.cpp
+// `Benchmarks --check-session-store`: crash injection for the server's SessionStore. A child
+// process plays computer games and keeps them in a store, and is killed (SIGKILL) at a random step
+// of a store operation, or after a random time. The parent then opens the file as a restarted
+// server would and checks that the free list and the live slots are exactly the slots ever used,
+// and that every live slot holds either the last state of its game the child finished writing or
+// the one it was writing, which must restore into a game that plays on exactly like the original.
+// The next child carries on with the games the parent found, so every round is also a restart.
+// Then times Open on stores with few and many live sessions, which must take about as long.
+// Exits non-zero if any check fails. POSIX only, like the server.
+#include "BenchHarness.h"
+#include "GameSession.h"
+#include "SessionStore.h"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const unsigned int CHECK_SEED = 4242;
+    const int BOARD = 10;
+    const uint32_t STORE_SLOTS = 64;
+    const uint32_t MAX_LIVE = 48;       // The child leaves some slots free, so Allocate reuses them
+    const int STEP_KILL_ROUNDS = 300;   // Killed at a chosen step of a store operation
+    const int TIMED_KILL_ROUNDS = 60;   // Killed after a chosen time
+    const int MAX_STEP = 3000;          // A round runs a few hundred operations at most
+    const int CHILD_OPERATIONS = 2000;  // A child that is not killed stops after this many
+    const uint32_t OPEN_SIZES[] = { 1000, 100000 };
+    const int OPEN_ROUNDS = 50;
+
+    enum : uint32_t { OP_NONE, OP_ALLOCATE, OP_WRITE, OP_RELEASE };
+
+    // What the child has done, in memory shared with the parent, so it survives the child: each
+    // slot as of the last store operation that returned, and the one in progress if any.
+    struct LedgerSlot {
+        uint64_t sessionId;
+        uint32_t seq;     // Moves played in the game as last written
+        uint32_t written; // The game has been written at least once
+        uint32_t live;
+    };
+    struct Ledger {
+        uint32_t op;
+        uint32_t slot;    // OP_WRITE, OP_RELEASE
+        uint32_t seq;     // OP_WRITE
+        uint64_t sessionId; // OP_ALLOCATE
+        uint64_t nextSessionId;
+        LedgerSlot slots[STORE_SLOTS];
+    };
+
+    Ledger* ledger = nullptr;
+    long stepsLeft = 0;
+
+    void CountStep() {
+        if (--stepsLeft == 0) std::raise(SIGKILL);
+    }
+
+    // The ledger's stores must not move across the store calls they describe.
+    void Fence() { std::atomic_signal_fence(std::memory_order_seq_cst); }
+
+    uint64_t GameSeed(uint64_t sessionId) { return mixSeed(CHECK_SEED, sessionId); }
+
+    // Game 'sessionId' after 'moves' moves; both seats are computers, so it only depends on these.
+    bool PlayTo(GameSession& game, uint64_t sessionId, uint32_t moves) {
+        game.StartNewGame("Host", "Guest", GameMode::COMPUTER_VS_COMPUTER, GameSeed(sessionId));
+        for (uint32_t i = 0; i < moves; ++i) {
+            if (game.IsGameOver() || !game.MakeComputerMove().isAccepted()) return false;
+        }
+        return true;
+    }
+
+    bool Write(SessionStore& store, uint32_t slot, GameSession& game, uint32_t seq) {
+        GameSnapshot snapshot;
+        if (!game.SaveSnapshot(snapshot)) return false;
+        ledger->slot = slot; ledger->seq = seq; Fence();
+        ledger->op = OP_WRITE; Fence();
+        bool ok = store.Write(slot, snapshot, seq);
+        Fence();
+        ledger->slots[slot].seq = seq; ledger->slots[slot].written = 1; Fence();
+        ledger->op = OP_NONE; Fence();
+        return ok;
+    }
+
+    void Release(SessionStore& store, uint32_t slot) {
+        ledger->slot = slot; Fence();
+        ledger->op = OP_RELEASE; Fence();
+        store.Release(slot);
+        Fence();
+        ledger->slots[slot].live = 0; Fence();
+        ledger->op = OP_NONE; Fence();
+    }
+
+    // Plays on from what the store holds until killed (or done). Exits 0 when done, 1 on error.
+    [[noreturn]] void RunChild(const std::string& path, unsigned int seed, long killStep) {
+        SessionStore store;
+        std::string error;
+        if (!store.Open(path, STORE_SLOTS, error)) { std::fprintf(stderr, "child: %s\n", error.c_str()); _exit(1); }
+        std::unique_ptr<GameSession> games[STORE_SLOTS];
+        for (uint32_t slot = 0; slot < STORE_SLOTS; ++slot) {
+            if (!ledger->slots[slot].live) continue;
+            SessionStore::StoredSession stored;
+            if (!store.Load(slot, stored)) { Release(store, slot); continue; } // Allocated, never written
+            games[slot] = std::make_unique<GameSession>(BOARD);
+            if (!games[slot]->RestoreSnapshot(stored.snapshot, stored.names[0], stored.names[1])) _exit(1);
+        }
+        stepsLeft = killStep;
+        if (killStep > 0) store.SetStepHook(CountStep);
+        GameRandom rng(seed);
+        const std::string names[2] = { "Host", "Guest" };
+        for (int operation = 0; operation < CHILD_OPERATIONS; ++operation) {
+            std::vector<uint32_t> live;
+            for (uint32_t slot = 0; slot < STORE_SLOTS; ++slot) if (games[slot]) live.push_back(slot);
+            uint32_t choice = rng.nextBelow(100);
+            if (live.empty() || (choice < 15 && live.size() < MAX_LIVE)) {
+                uint64_t id = ledger->nextSessionId;
+                ledger->sessionId = id; ledger->nextSessionId = id + 1; Fence();
+                ledger->op = OP_ALLOCATE; Fence();
+                const uint64_t tokens[2] = { rng.next(), rng.next() };
+                uint32_t slot = store.Allocate(id, names, tokens, 0);
+                Fence();
+                if (slot == SessionStore::NO_SLOT) _exit(1);
+                ledger->slots[slot] = LedgerSlot{ id, 0, 0, 1 }; Fence();
+                ledger->op = OP_NONE; Fence();
+                games[slot] = std::make_unique<GameSession>(BOARD);
+                PlayTo(*games[slot], id, 0);
+                if (!Write(store, slot, *games[slot], 0)) _exit(1);
+                continue;
+            }
+            uint32_t slot = live[rng.nextBelow(static_cast<uint32_t>(live.size()))];
+            GameSession& game = *games[slot];
+            if (choice < 20) { Release(store, slot); games[slot].reset(); continue; } // Abandoned
+            if (!game.MakeComputerMove().isAccepted()) _exit(1);
+            if (game.IsGameOver()) { Release(store, slot); games[slot].reset(); continue; }
+            if (!Write(store, slot, game, ledger->slots[slot].seq + 1)) _exit(1);
+        }
+        store.SetStepHook(nullptr);
+        _exit(0);
+    }
+
+    struct Findings {
+        int rounds = 0;
+        int killed = 0;
+        int undone = 0;     // Opens that undid an Allocate or Release in progress
+        int tornWrites = 0; // A Write in progress left the previous state as the newest
+        int newWrites = 0;  // A Write in progress had finished its copy
+        int restored = 0;   // Live games restored and played out
+        int failures = 0;
+    };
+
+    bool Fail(Findings& findings, int round, const std::string& what) {
+        if (findings.failures++ < 10) std::printf("  round %d: %s\n", round, what.c_str());
+        return false;
+    }
+
+    // 'stored' must be game 'sessionId' after 'seq' moves, and play on from there like it.
+    bool CheckGame(const SessionStore::StoredSession& stored, uint64_t sessionId, uint32_t seq) {
+        GameSession original(BOARD), copy(BOARD);
+        GameSnapshot expected;
+        if (!PlayTo(original, sessionId, seq) || !original.SaveSnapshot(expected) || expected.size != stored.snapshot.size
+            || std::memcmp(expected.bytes, stored.snapshot.bytes, expected.size) != 0) return false;
+        if (!copy.RestoreSnapshot(stored.snapshot, stored.names[0], stored.names[1])) return false;
+        while (!original.IsGameOver()) {
+            AttackEvent a = original.MakeComputerMove(), b = copy.MakeComputerMove();
+            if (a.row != b.row || a.col != b.col || a.outcome != b.outcome) return false;
+        }
+        return copy.IsGameOver();
+    }
+
+    // Opens the store as a restarted server would, checks it against the ledger, and brings the
+    // ledger up to date with how the interrupted operation turned out.
+    bool CheckStore(const std::string& path, int round, Findings& findings) {
+        SessionStore store;
+        std::string error;
+        if (!store.Open(path, STORE_SLOTS, error)) return Fail(findings, round, error);
+        if (store.WasRecovered()) findings.undone++;
+        if (!store.CheckFreeList(error)) return Fail(findings, round, error);
+        bool ok = true;
+        int unrecorded = 0;
+        for (uint32_t slot = 0; slot < STORE_SLOTS; ++slot) {
+            LedgerSlot& expected = ledger->slots[slot];
+            bool inFlight = ledger->op != OP_NONE && ledger->slot == slot;
+            bool live = store.IsLive(slot);
+            SessionStore::StoredSession stored;
+            bool loaded = store.Load(slot, stored);
+            if (live && !expected.live) { // Only the slot of an Allocate the child never saw return
+                if (ledger->op != OP_ALLOCATE || loaded || ++unrecorded > 1) ok = Fail(findings, round, "slot " + std::to_string(slot) + " is live but was never allocated");
+                else expected = LedgerSlot{ ledger->sessionId, 0, 0, 1 };
+                continue;
+            }
+            if (!live) {
+                if (expected.live && !(inFlight && ledger->op == OP_RELEASE)) ok = Fail(findings, round, "slot " + std::to_string(slot) + " was freed");
+                expected.live = 0;
+                continue;
+            }
+            bool writing = inFlight && ledger->op == OP_WRITE;
+            if (!loaded) {
+                if (expected.written) ok = Fail(findings, round, "slot " + std::to_string(slot) + " lost its game"); // Even in the middle of a write
+                expected.written = 0;
+                continue;
+            }
+            if (stored.sessionId != expected.sessionId || stored.sessionId >= store.GetNextSessionId()) {
+                ok = Fail(findings, round, "slot " + std::to_string(slot) + " holds another session");
+                continue;
+            }
+            bool committed = expected.written && stored.seq == expected.seq;
+            bool pending = writing && stored.seq == ledger->seq;
+            if (!committed && !pending) {
+                ok = Fail(findings, round, "slot " + std::to_string(slot) + " holds move " + std::to_string(stored.seq) + ", expected " + std::to_string(expected.seq));
+                continue;
+            }
+            if (writing) (pending ? findings.newWrites : findings.tornWrites)++;
+            if (!CheckGame(stored, stored.sessionId, stored.seq)) ok = Fail(findings, round, "slot " + std::to_string(slot) + " does not restore to its game");
+            findings.restored++;
+            expected.seq = stored.seq;
+            expected.written = 1;
+        }
+        ledger->op = OP_NONE;
+        return ok;
+    }
+
+    bool RunCrashRounds(const std::string& path) {
+        Findings findings;
+        GameRandom rng(CHECK_SEED);
+        for (int round = 0; round < STEP_KILL_ROUNDS + TIMED_KILL_ROUNDS; ++round) {
+            bool timed = round >= STEP_KILL_ROUNDS;
+            long killStep = timed ? 0 : 1 + static_cast<long>(rng.nextBelow(MAX_STEP));
+            unsigned int childSeed = rng.next();
+            std::fflush(stdout);
+            pid_t child = fork();
+            if (child < 0) { std::printf("  fork failed\n"); return false; }
+            if (child == 0) RunChild(path, childSeed, killStep);
+            if (timed) {
+                usleep(rng.nextBelow(20000));
+                kill(child, SIGKILL);
+            }
+            int status = 0;
+            waitpid(child, &status, 0);
+            findings.rounds++;
+            if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL) findings.killed++;
+            else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) { Fail(findings, round, "child failed"); continue; }
+            CheckStore(path, round, findings);
+        }
+        std::printf("%-48s %4d of %d rounds killed, %d failures  %s\n", "session store crash injection", findings.killed, findings.rounds,
+            findings.failures, findings.failures == 0 ? "ok" : "FAILED");
+        std::printf("  %d pending allocations/releases undone, %d interrupted writes kept the old state, %d the new; %d games restored and played out\n",
+            findings.undone, findings.tornWrites, findings.newWrites, findings.restored);
+        return findings.failures == 0 && findings.killed > 0 && findings.undone > 0 && findings.tornWrites > 0;
+    }
+
+    // How long a restarted server takes to map a store with 'live' sessions, and to read one back.
+    bool TimeOpen(const std::string& path, uint32_t live, double& openNs) {
+        SessionStore store;
+        std::string error;
+        std::remove(path.c_str());
+        if (!store.Open(path, live, error)) { std::printf("  %s\n", error.c_str()); return false; }
+        GameSession game(BOARD);
+        PlayTo(game, 1, 30);
+        GameSnapshot snapshot;
+        game.SaveSnapshot(snapshot);
+        const std::string names[2] = { "Host", "Guest" };
+        const uint64_t tokens[2] = { 1, 2 };
+        for (uint32_t i = 0; i < live; ++i) {
+            uint32_t slot = store.Allocate(i + 1, names, tokens, 0);
+            if (slot == SessionStore::NO_SLOT || !store.Write(slot, snapshot, 30)) return false;
+        }
+        store.Close();
+        std::vector<double> times;
+        for (int round = 0; round < OPEN_ROUNDS; ++round) {
+            BenchTimer timer;
+            timer.Start();
+            SessionStore reopened;
+            SessionStore::StoredSession stored;
+            bool ok = reopened.Open(path, live, error) && reopened.GetLiveCount() == live && reopened.Load(live / 2, stored);
+            times.push_back(timer.StopNs());
+            if (!ok) return false;
+        }
+        std::sort(times.begin(), times.end());
+        openNs = times[times.size() / 2];
+        BenchResult result;
+        result.name = "SessionStore Open + Load, " + std::to_string(live) + " live";
+        result.operations = 1;
+        result.totalNs = openNs;
+        PrintBenchResult(result);
+        std::remove(path.c_str());
+        return true;
+    }
+}
+
+bool RunSessionStoreChecks() {
+    std::string path = "/tmp/battleship-store-check-" + std::to_string(getpid()) + ".bss";
+    std::remove(path.c_str());
+    void* shared = mmap(nullptr, sizeof(Ledger), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) return false;
+    ledger = static_cast<Ledger*>(shared);
+    std::memset(ledger, 0, sizeof(Ledger));
+    ledger->nextSessionId = 1;
+    bool ok = RunCrashRounds(path);
+    std::remove(path.c_str());
+    munmap(shared, sizeof(Ledger));
+    ledger = nullptr;
+
+    // Flat: many more sessions may cost a little more (the mapping is bigger) but nowhere near in proportion.
+    double fewNs = 0.0, manyNs = 0.0;
+    bool timed = TimeOpen(path, OPEN_SIZES[0], fewNs) && TimeOpen(path, OPEN_SIZES[1], manyNs);
+    bool flat = timed && manyNs < 10.0 * fewNs + 100000.0;
+    std::printf("%-48s %.1f us vs %.1f us  %s\n", "session store startup, 100x the sessions", fewNs / 1000.0, manyNs / 1000.0, flat ? "ok" : "FAILED");
+    return ok && flat;
+}
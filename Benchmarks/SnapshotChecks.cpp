@@ -0,0 +1,102 @@
+// SnapshotChecks.cpp
+// `Benchmarks --check-snapshots`: a game saved with SaveSnapshot at any move and restored into
+// another BattleshipGameLogic must show the same boards, turn and last attack, and computer
+// players must go on to play exactly the same moves as in the original game. Also reports the
+// snapshot size and save/restore cost per board size. Exits non-zero if any case fails.
+#include "BenchHarness.h"
+#include "BattleShipGame.h"
+#include "ComputerPlayer.h"
+#include <cstdio>
+
+namespace {
+    const unsigned int CHECK_SEED = 777;
+    const int CHECK_GAMES = 300;
+    const int TIMED_ROUNDS = 20000;
+
+    template <int N>
+    bool SamePosition(const BasicBattleshipGameLogic<N>& a, const BasicBattleshipGameLogic<N>& b) {
+        const BasicPlayer<N>* pa[2] = { a.GetPlayer1(), a.GetPlayer2() };
+        const BasicPlayer<N>* pb[2] = { b.GetPlayer1(), b.GetPlayer2() };
+        for (int p = 0; p < 2; ++p) {
+            if (pa[p]->getOwnShipMask() != pb[p]->getOwnShipMask() || pa[p]->getOwnHitMask() != pb[p]->getOwnHitMask()
+                || pa[p]->getOwnMissMask() != pb[p]->getOwnMissMask() || pa[p]->getTrackingHitMask() != pb[p]->getTrackingHitMask()
+                || pa[p]->getTrackingMissMask() != pb[p]->getTrackingMissMask() || pa[p]->isDefeated() != pb[p]->isDefeated()) return false;
+            for (int i = 0; i < pa[p]->getShipCount(); ++i) {
+                if (pa[p]->getShip(i).getHitMask() != pb[p]->getShip(i).getHitMask()) return false;
+            }
+        }
+        const AttackEvent& la = a.GetLastAttack();
+        const AttackEvent& lb = b.GetLastAttack();
+        return a.GetCurrentTurnState() == b.GetCurrentTurnState() && a.GetSeed() == b.GetSeed()
+            && la.attackerId == lb.attackerId && la.row == lb.row && la.col == lb.col && la.outcome == lb.outcome
+            && la.sunkShipIndex == lb.sunkShipIndex && la.gameOver == lb.gameOver;
+    }
+
+    // Plays game 'index' to a chosen move, snapshots it into 'copy', then plays both to the end side by side.
+    template <int N>
+    bool CheckGame(int index, GameMode mode, BasicBattleshipGameLogic<N>& original, BasicBattleshipGameLogic<N>& copy, GameRandom& rng) {
+        original.StartNewGame("Host", "Guest", mode, mixSeed(CHECK_SEED, static_cast<uint64_t>(index)));
+        copy.StartNewGame("Other", "Names", GameMode::PLAYER_VS_PLAYER, 0); // Different kind of players to start with
+        int stopAt = static_cast<int>(rng.nextBelow(N * N));
+        for (int move = 0; move < stopAt && !original.IsGameOver(); ++move) {
+            if (original.IsComputerTurn()) original.MakeComputerMove();
+            else { int cell = static_cast<int>(rng.nextBelow(N * N)); original.MakeAttack(cell / N, cell % N); }
+        }
+        GameSnapshot snapshot;
+        if (!original.SaveSnapshot(snapshot) || !copy.RestoreSnapshot(snapshot, "Host", "Guest") || !SamePosition(original, copy)) return false;
+        while (!original.IsGameOver()) {
+            AttackEvent a, b;
+            if (original.IsComputerTurn()) { a = original.MakeComputerMove(); b = copy.MakeComputerMove(); }
+            else { int cell = static_cast<int>(rng.nextBelow(N * N)); a = original.MakeAttack(cell / N, cell % N); b = copy.MakeAttack(cell / N, cell % N); }
+            if (a.row != b.row || a.col != b.col || a.outcome != b.outcome) return false;
+        }
+        return SamePosition(original, copy) && original.GetLastActionMessage() == copy.GetLastActionMessage();
+    }
+
+    template <int N>
+    bool CheckBoardSize() {
+        std::string size = std::to_string(N) + "x" + std::to_string(N);
+        BasicBattleshipGameLogic<N> original, copy;
+        GameRandom rng(CHECK_SEED);
+        const GameMode modes[] = { GameMode::PLAYER_VS_PLAYER, GameMode::PLAYER_VS_COMPUTER, GameMode::COMPUTER_VS_COMPUTER };
+        const char* modeNames[] = { "PvP", "PvC", "CvC" };
+        bool ok = true;
+        for (int m = 0; m < 3; ++m) {
+            int failures = 0;
+            for (int g = 0; g < CHECK_GAMES; ++g) if (!CheckGame(g, modes[m], original, copy, rng)) failures++;
+            std::printf("%-48s %4d of %d games differ  %s\n", ("snapshot round trip " + std::string(modeNames[m]) + " " + size).c_str(),
+                failures, CHECK_GAMES, failures == 0 ? "ok" : "FAILED");
+            ok &= failures == 0;
+        }
+
+        // Cost of a mid-game save and restore onto an existing game.
+        original.StartNewGame("Host", "Guest", GameMode::PLAYER_VS_COMPUTER, CHECK_SEED);
+        for (int move = 0; move < N * N / 2 && !original.IsGameOver(); ++move) {
+            if (original.IsComputerTurn()) original.MakeComputerMove();
+            else { int cell = static_cast<int>(rng.nextBelow(N * N)); original.MakeAttack(cell / N, cell % N); }
+        }
+        GameSnapshot snapshot;
+        original.SaveSnapshot(snapshot);
+        copy.RestoreSnapshot(snapshot, "Host", "Guest");
+        BenchResult save; save.name = "SaveSnapshot " + size + " (" + std::to_string(snapshot.size) + " bytes)";
+        BenchResult restore; restore.name = "RestoreSnapshot " + size;
+        BenchTimer timer;
+        timer.Start();
+        for (int i = 0; i < TIMED_ROUNDS; ++i) original.SaveSnapshot(snapshot);
+        timer.StopInto(save, TIMED_ROUNDS);
+        timer.Start();
+        for (int i = 0; i < TIMED_ROUNDS; ++i) copy.RestoreSnapshot(snapshot, "Host", "Guest");
+        timer.StopInto(restore, TIMED_ROUNDS);
+        PrintBenchResult(save);
+        PrintBenchResult(restore);
+        return ok && restore.allocations == 0;
+    }
+}
+
+bool RunSnapshotChecks() {
+    bool ok = CheckBoardSize<10>();
+    ok &= CheckBoardSize<15>();
+    ok &= CheckBoardSize<20>();
+    ok &= CheckBoardSize<32>();
+    return ok;
+}
@@ -0,0 +1,48 @@
+// TargetingBenchmarks.cpp
+// Cost of one ComputerPlayer decision and the shots it needs to sink a randomly placed fleet, per
+// board size, for probability-density targeting and for random fire.
+#include "BenchHarness.h"
+#include "BattleShipGame.h"
+#include "ComputerPlayer.h"
+
+namespace {
+    const unsigned int BENCH_SEED = 12345;
+
+    template <int N>
+    void RunTargetingBenchmarks(int games, ComputerStrategy strategy) {
+        GameRandom rng(BENCH_SEED);
+        std::string label = (strategy == ComputerStrategy::RANDOM ? "random " : "") + std::to_string(N) + "x" + std::to_string(N);
+        BenchResult decisions; decisions.name = "makeStrategicMove " + label;
+        BenchTimer timer;
+        long long shots = 0;
+        for (int g = 0; g < games; ++g) {
+            BasicPlayer<N> defender("Defender");
+            BasicComputerPlayer<N> attacker("Computer");
+            attacker.setStrategy(strategy);
+            for (ShipTypeId type : DEFAULT_FLEET) { defender.addShipDefinition(type); attacker.addShipDefinition(type); }
+            defender.placeShipsRandomly(rng);
+            while (!defender.isDefeated()) {
+                int r = 0, c = 0;
+                timer.Start();
+                bool moved = attacker.makeStrategicMove(defender, rng, r, c);
+                timer.StopInto(decisions);
+                if (!moved) break;
+                AttackResult result = defender.receiveAttack(r, c);
+                attacker.processAttackResult(r, c, result.isHit() ? HIT_CHAR : MISS_CHAR, defender);
+                if (result.outcome == AttackOutcome::SUNK) attacker.onOpponentShipSunk(r, c, result.shipIndex, defender.getShip(result.shipIndex).getSize());
+                shots++;
+            }
+        }
+        PrintBenchResult(decisions);
+        std::printf("%-40s %12.2f shots/game\n", ("  fleet sunk after " + label).c_str(), games > 0 ? static_cast<double>(shots) / games : 0.0);
+    }
+}
+
+void RunAllTargetingBenchmarks(int games) {
+    RunTargetingBenchmarks<10>(games, ComputerStrategy::PROBABILITY_DENSITY);
+    RunTargetingBenchmarks<15>(games / 10 + 1, ComputerStrategy::PROBABILITY_DENSITY);
+    RunTargetingBenchmarks<20>(games / 20 + 1, ComputerStrategy::PROBABILITY_DENSITY);
+    RunTargetingBenchmarks<32>(games / 100 + 1, ComputerStrategy::PROBABILITY_DENSITY);
+    RunTargetingBenchmarks<10>(games, ComputerStrategy::RANDOM);
+    RunTargetingBenchmarks<32>(games / 10 + 1, ComputerStrategy::RANDOM);
+}
@@ -0,0 +1,72 @@
+// main.cpp (Benchmarks)
+#include "BenchHarness.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+void RunAllPlayerBenchmarks(int games);
+void RunAllBoardSizeBenchmarks(int games);
+void RunAllTargetingBenchmarks(int games);
+void RunAllProtocolBenchmarks(int games);
+#ifndef _WIN32 // Server metrics, message handoff and matchmaking; the server is POSIX only
+void RunAllMetricsBenchmarks(int games);
+void RunAllHandoffBenchmarks(int games);
+void RunAllMatchmakingBenchmarks(int games);
+#endif
+bool RunAllocationChecks();
+bool RunSnapshotChecks();
+bool RunRuleChecks();
+#ifndef _WIN32
+bool RunMetricsCheck();
+bool RunSessionStoreChecks();
+#endif
+
+namespace {
+    // One object per reported case, for tracking regressions between builds.
+    bool WriteJson(const std::string& path, int games) {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) return false;
+        std::fprintf(out, "{\"games\":%d,\"results\":[", games);
+        const std::vector<BenchResult>& results = ReportedBenchResults();
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& result = results[i];
+            std::fprintf(out, "%s\n{\"name\":\"%s\",\"operations\":%lld,\"nsPerOp\":%.2f,\"allocsPerOp\":%.3f,\"bytesPerOp\":%.1f}",
+                i ? "," : "", result.name.c_str(), result.operations, result.NsPerOp(), result.AllocsPerOp(), result.BytesPerOp());
+        }
+        std::fputs("\n]}\n", out);
+        return std::fclose(out) == 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int games = 2000;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--check-allocs") return RunAllocationChecks() ? 0 : 1;
+        if (arg == "--check-snapshots") return RunSnapshotChecks() ? 0 : 1;
+        if (arg == "--check-rules") return RunRuleChecks() ? 0 : 1;
+#ifndef _WIN32
+        if (arg == "--check-metrics") return RunMetricsCheck() ? 0 : 1;
+        if (arg == "--check-session-store") return RunSessionStoreChecks() ? 0 : 1;
+#endif
+        if (arg == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else games = std::atoi(argv[i]);
+    }
+    if (games <= 0) games = 2000;
+    std::printf("Battleship core benchmarks (%d games per case)\n", games);
+    RunAllPlayerBenchmarks(games);
+    RunAllBoardSizeBenchmarks(games);
+    RunAllTargetingBenchmarks(games);
+    RunAllProtocolBenchmarks(games);
+#ifndef _WIN32
+    RunAllMetricsBenchmarks(games);
+    RunAllHandoffBenchmarks(games);
+    RunAllMatchmakingBenchmarks(games);
+#endif
+    if (!jsonPath.empty() && !WriteJson(jsonPath, games)) {
+        std::fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// CoroutineHost.cpp
+#include "CoroutineHost.h"
+#include <cstdio>
+
+CoroutineHost::CoroutineHost(Reactor& r, int size, uint64_t seed, bool log) : reactor(r), boardSize(size), seedBase(seed), logGames(log) {
+    reactor.SetHandler(*this);
+}
+
+CoroutineHost::~CoroutineHost() = default;
+
+void CoroutineHost::OnOpen(Connection& conn) {
+    Client* client = new Client(timers);
+    client->conn = &conn;
+    conn.userData = client;
+    AddToCounter(stats.connectionsAccepted, 1);
+    Greet(*client);
+}
+
+void CoroutineHost::OnLine(Connection& conn, std::string_view line) {
+    Client& client = ClientOf(conn);
+    if (!client.inbox->IsAwaited() && client.inbox->GetQueuedCount() >= MAX_QUEUED_LINES) { reactor.Close(conn); return; }
+    client.inbox->Push(InboxEvent::Kind::LINE, client.seat, line);
+}
+
+// The coroutine waiting on this connection's lines learns of it and finishes; the client outlives
+// that, so the coroutine may still use it.
+void CoroutineHost::OnClose(Connection& conn) {
+    Client* client = static_cast<Client*>(conn.userData);
+    if (!client) return;
+    if (lobby == client) {
+        lobby = nullptr;
+        stats.waitingPlayers.store(0, std::memory_order_relaxed);
+    }
+    client->inbox->Push(InboxEvent::Kind::CLOSED, client->seat);
+    delete client;
+    conn.userData = nullptr;
+}
+
+void CoroutineHost::OnTick() {
+    timers.Fire(Clock::now());
+}
+
+CoroutineHost::Clock::time_point CoroutineHost::TurnDeadline() const {
+    return turnTimeout.count() > 0 ? Clock::now() + turnTimeout : Clock::time_point::max();
+}
+
+// From connect to CONNECT_REQUEST; then the client waits in the lobby, or is paired with the one
+// waiting there and their game starts.
+DetachedTask CoroutineHost::Greet(Client& client) {
+    Clock::time_point deadline = Clock::now() + HANDSHAKE_TIMEOUT;
+    while (true) {
+        InboxEvent event = co_await client.own.Next(deadline);
+        if (event.kind == InboxEvent::Kind::CLOSED) co_return;
+        if (event.kind == InboxEvent::Kind::TIMEOUT) { reactor.Close(*client.conn); co_return; }
+        ProtocolMessage message;
+        if (!ParseMessage(event.line, message)) continue;
+        if (message.type == MessageType::CONNECT_REQUEST) {
+            client.name = ToToken(message.GetRest(1));
+            break;
+        }
+        int version = 0;
+        if (message.type == MessageType::PROTOCOL && ParseField(message.GetField(1), version) && version >= PROTOCOL_V2) {
+            client.protocolVersion = PROTOCOL_V2;
+            reactor.Send(*client.conn, out.Begin(MessageType::PROTOCOL_OK).Add(PROTOCOL_V2).GetText());
+        }
+        else if (message.type == MessageType::READY) client.ready = true; // Remembered until paired
+        else if (message.type == MessageType::DISCONNECT) { reactor.Close(*client.conn); co_return; }
+    }
+    client.queuedTicks = MetricsTicks();
+    if (!lobby) {
+        lobby = &client; // What it sends from now on queues in client.own until it is paired
+        stats.waitingPlayers.store(1, std::memory_order_relaxed);
+        co_return;
+    }
+    Client& first = *lobby;
+    lobby = nullptr;
+    stats.waitingPlayers.store(0, std::memory_order_relaxed);
+    Play(SetUpGame(first, client));
+}
+
+CoroutineHost::Game& CoroutineHost::SetUpGame(Client& first, Client& second) {
+    auto game = std::make_unique<Game>(boardSize, timers);
+    game->id = nextGameId++;
+    Client* pair[2] = { &first, &second };
+    uint64_t now = MetricsTicks();
+    for (int i = 0; i < 2; ++i) {
+        Client& client = *pair[i];
+        stats.pairingLatency.Record(now - client.queuedTicks);
+        game->seats[i] = &client;
+        client.game = game.get();
+        client.seat = i;
+        client.inbox = &game->inbox;
+        client.own.MoveTo(game->inbox, i); // READY and anything else sent while waiting
+    }
+    Game& ref = *game;
+    games[game->id] = std::move(game);
+    stats.activeSessions.fetch_add(1, std::memory_order_relaxed);
+    return ref;
+}
+
+// One session from WELCOME to its end, in protocol order. Every way out goes through EndGame.
+DetachedTask CoroutineHost::Play(Game& g) {
+    // WELCOME <host name> <your name> <your player id>; the client is always player 2 on the wire.
+    for (int i = 0; i < 2; ++i) reactor.Send(*g.seats[i]->conn, out.Begin(MessageType::WELCOME).Add(g.seats[1 - i]->name).Add(g.seats[i]->name).Add(2).GetText());
+
+    bool ready[2] = { g.seats[0]->ready, g.seats[1]->ready };
+    Clock::time_point deadline = Clock::now() + HANDSHAKE_TIMEOUT;
+    while (!ready[0] || !ready[1]) {
+        InboxEvent event = co_await g.inbox.Next(deadline);
+        if (event.kind != InboxEvent::Kind::LINE) { EndGame(g); co_return; }
+        ProtocolMessage message;
+        if (!ParseMessage(event.line, message)) continue;
+        if (message.type == MessageType::READY) ready[event.seat] = true;
+        else if (message.type == MessageType::DISCONNECT) { EndGame(g, event.seat); co_return; }
+    }
+
+    g.game.StartNewGame(g.seats[0]->name, g.seats[1]->name, GameMode::PLAYER_VS_PLAYER, mixSeed(seedBase, g.id));
+    if (logGames) {
+        std::printf("session %llu: %s vs %s, seed %016llx\n", static_cast<unsigned long long>(g.id),
+            g.seats[0]->name.c_str(), g.seats[1]->name.c_str(), static_cast<unsigned long long>(g.game.GetSeed()));
+    }
+    g.started = true;
+    AddToCounter(stats.gamesStarted, 1);
+    SendGameUpdates(g, false);
+
+    deadline = TurnDeadline();
+    while (!g.game.IsGameOver()) {
+        InboxEvent event = co_await g.inbox.Next(deadline);
+        if (event.kind != InboxEvent::Kind::LINE) { EndGame(g); co_return; } // A player left, or the mover ran out of time
+        ProtocolMessage message;
+        if (!ParseMessage(event.line, message)) continue;
+        if (message.type == MessageType::DISCONNECT) { EndGame(g, event.seat); co_return; }
+        if (message.type == MessageType::RESYNC) { SendFullState(g, event.seat); continue; }
+        int mover = g.game.GetCurrentTurnState() == GameTurn::PLAYER1 ? 0 : 1;
+        int r = 0, c = 0;
+        if (message.type != MessageType::ATTACK || event.seat != mover) continue; // Out-of-turn shots are ignored
+        if (!ParseField(message.GetField(1), r) || !ParseField(message.GetField(2), c)) continue;
+        AttackEvent attack;
+        {
+            ScopedLatency timing(stats.attackLatency);
+            attack = g.game.MakeAttack(r, c);
+        }
+        if (attack.isAccepted()) {
+            AddToCounter(stats.movesPlayed, 1);
+            deadline = TurnDeadline();
+        }
+        SendGameUpdates(g, attack.isAccepted()); // Also answers rejected moves, so the client re-enables its grid
+    }
+    AddToCounter(stats.gamesFinished, 1);
+
+    // Over; the boards stay up (RESYNC is still answered) until a player leaves.
+    while (true) {
+        InboxEvent event = co_await g.inbox.Next(Clock::now() + HANDSHAKE_TIMEOUT);
+        if (event.kind != InboxEvent::Kind::LINE) break;
+        ProtocolMessage message;
+        if (!ParseMessage(event.line, message)) continue;
+        if (message.type == MessageType::DISCONNECT) { EndGame(g, event.seat); co_return; }
+        if (message.type == MessageType::RESYNC) SendFullState(g, event.seat);
+    }
+    EndGame(g);
+}
+
+// v1 seats get a full GAME_UPDATE after every change. v2 seats get a GAME_DELTA for an accepted
+// move and a GAME_SNAPSHOT otherwise (game start, rejected move).
+void CoroutineHost::SendGameUpdates(Game& g, bool moveAccepted) {
+    if (!g.started) return;
+    if (moveAccepted) ++g.seq;
+    for (int seat = 0; seat < 2; ++seat) {
+        BuildSeatUpdate(out, g.game, g.seq, seat, g.seats[seat]->protocolVersion, moveAccepted, views);
+        reactor.Send(*g.seats[seat]->conn, out.GetText());
+    }
+}
+
+// The game from one seat's view: GAME_UPDATE for v1, GAME_SNAPSHOT for v2.
+void CoroutineHost::SendFullState(Game& g, int seat) {
+    if (!g.started) return;
+    BuildSeatState(out, g.game, g.seq, seat, g.seats[seat]->protocolVersion, views);
+    reactor.Send(*g.seats[seat]->conn, out.GetText());
+}
+
+// Called from Play only, as its last act: the game (and its inbox) are gone when this returns.
+void CoroutineHost::EndGame(Game& g, int leavingSeat) {
+    Connection* conns[2];
+    for (int seat = 0; seat < 2; ++seat) { // Detached first: closing one reaches OnClose at once
+        Client& client = *g.seats[seat];
+        conns[seat] = client.conn;
+        client.game = nullptr;
+        client.inbox = &client.own;
+    }
+    for (int seat = 0; seat < 2; ++seat) {
+        if (seat != leavingSeat) reactor.Send(*conns[seat], "DISCONNECT"); // The remaining client resets, as after a host disconnect
+        reactor.Close(*conns[seat]);
+    }
+    if (g.started && !g.game.IsGameOver()) AddToCounter(stats.gamesFinished, 1);
+    stats.activeSessions.fetch_sub(1, std::memory_order_relaxed);
+    games.erase(g.id);
+}
@@ -0,0 +1,85 @@
+// CoroutineHost.h
+#pragma once
+#include "Reactor.h"
+#include "GameSession.h"
+#include "GameUpdates.h"
+#include "Protocol.h"
+#include "SessionCoroutine.h"
+#include "SessionHost.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// The service SessionHost provides, players paired in arrival order (no matchmaking, journal or
+// spectators), with each session written as one coroutine that reads like the protocol: send
+// WELCOME, await both READYs, then await the mover's ATTACK, play it and answer, until the game is
+// over. Greet does the same for a connection until it has sent CONNECT_REQUEST. A coroutine that
+// waits is a heap frame, not a thread, so one reactor thread carries thousands of sessions: the
+// reactor resumes a coroutine when a line for it arrives, and OnTick resumes those whose deadline
+// has passed (a handshake not finished, a turn not played) so the session can end.
+class CoroutineHost : public ReactorHandler {
+public:
+    CoroutineHost(Reactor& reactor, int boardSize, uint64_t seedBase, bool logGames = false);
+    ~CoroutineHost() override;
+
+    void OnOpen(Connection& conn) override;
+    void OnLine(Connection& conn, std::string_view line) override;
+    void OnClose(Connection& conn) override;
+    void OnTick() override;
+
+    // How long a player may take over a move before the game is abandoned (0: no limit); before
+    // the reactor runs.
+    void SetTurnTimeout(std::chrono::milliseconds timeout) { turnTimeout = timeout; }
+    const SessionHostStats& GetStats() const { return stats; }
+
+    static constexpr std::chrono::seconds HANDSHAKE_TIMEOUT{ 60 }; // Connect to CONNECT_REQUEST, and WELCOME to both READYs
+    static const size_t MAX_QUEUED_LINES = 64; // From a connection nothing is waiting on yet
+
+private:
+    typedef InboxTimers::Clock Clock;
+    struct Game;
+    struct Client { // Connection::userData
+        explicit Client(InboxTimers& timers) : own(timers) {}
+        Connection* conn = nullptr;
+        std::string name;
+        int protocolVersion = PROTOCOL_V1;
+        bool ready = false;        // READY seen before the game was set up
+        uint64_t queuedTicks = 0;  // MetricsTicks() at CONNECT_REQUEST
+        Inbox own;                 // Greet's, and what arrives while waiting for an opponent
+        Inbox* inbox = &own;       // Where this connection's lines go: 'own', then its game's
+        Game* game = nullptr;
+        int seat = 0;
+    };
+    struct Game {
+        Game(int boardSize, InboxTimers& timers) : game(boardSize), inbox(timers) {}
+        uint64_t id = 0;
+        GameSession game;
+        Client* seats[2] = { nullptr, nullptr }; // seats[0] is logic player 1
+        Inbox inbox;
+        bool started = false;
+        unsigned int seq = 0;
+    };
+
+    Reactor& reactor;
+    int boardSize;
+    uint64_t seedBase;
+    bool logGames;
+    std::chrono::milliseconds turnTimeout{ 0 };
+    uint64_t nextGameId = 1;
+    InboxTimers timers;
+    Client* lobby = nullptr; // Sent CONNECT_REQUEST, no opponent yet
+    std::unordered_map<uint64_t, std::unique_ptr<Game>> games;
+    SessionHostStats stats;
+    MessageBuilder out;
+    GameViewBoards views;
+
+    DetachedTask Greet(Client& client);
+    DetachedTask Play(Game& game);
+    Game& SetUpGame(Client& first, Client& second);
+    void SendGameUpdates(Game& game, bool moveAccepted);
+    void SendFullState(Game& game, int seat);
+    void EndGame(Game& game, int leavingSeat = -1); // The leaving seat is closed without a DISCONNECT
+    Clock::time_point TurnDeadline() const;
+    static Client& ClientOf(Connection& conn) { return *static_cast<Client*>(conn.userData); }
+};
@@ -0,0 +1,47 @@
+// GameUpdates.cpp
+#include "GameUpdates.h"
+
+namespace {
+    void HideShips(std::string& board) {
+        for (char& cell : board) if (cell == SHIP_CHAR) cell = WATER_CHAR;
+    }
+
+    // Player 'viewer' (1 or 2) sees the other board with unhit ships hidden, and its own as it is
+    // unless 'hideOwn' (a spectator).
+    void BuildView(MessageBuilder& out, const GameSession& game, unsigned int seq, int viewer, bool hideOwn, bool snapshot, GameViewBoards& boards) {
+        boards.first = game.GetOwnBoardAsString(3 - viewer);
+        boards.second = game.GetOwnBoardAsString(viewer);
+        HideShips(boards.first);
+        if (hideOwn) HideShips(boards.second);
+        std::string winner = game.IsGameOver() ? game.GetWinnerString() : std::string();
+        GameUpdate update;
+        update.seq = seq;
+        update.turnId = WireTurnId(game.GetCurrentTurnState(), viewer) == 2 ? 2 : 1;
+        update.player1Board = boards.first;
+        update.player2Board = boards.second;
+        update.action = game.GetLastActionMessage();
+        update.gameOver = game.IsGameOver();
+        update.winner = winner;
+        if (snapshot) BuildGameSnapshot(out, update);
+        else BuildGameUpdate(out, update);
+    }
+}
+
+std::string ToToken(std::string_view text) {
+    std::string token(text);
+    for (char& ch : token) if (ch == ' ') ch = '_';
+    return token.empty() ? std::string("Player") : token;
+}
+
+void BuildSeatState(MessageBuilder& out, const GameSession& game, unsigned int seq, int seat, int protocolVersion, GameViewBoards& boards) {
+    BuildView(out, game, seq, seat + 1, false, protocolVersion >= PROTOCOL_V2, boards);
+}
+
+void BuildSeatUpdate(MessageBuilder& out, const GameSession& game, unsigned int seq, int seat, int protocolVersion, bool moveAccepted, GameViewBoards& boards) {
+    if (moveAccepted && protocolVersion >= PROTOCOL_V2) BuildGameDelta(out, MakeGameDelta(game.GetLastAttack(), seq, seat + 1));
+    else BuildSeatState(out, game, seq, seat, protocolVersion, boards);
+}
+
+void BuildSpectatorState(MessageBuilder& out, const GameSession& game, unsigned int seq, GameViewBoards& boards) {
+    BuildView(out, game, seq, 2, true, true, boards);
+}
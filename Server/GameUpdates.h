@@ -0,0 +1,29 @@
+// GameUpdates.h
+#pragma once
+#include "GameSession.h"
+#include "Protocol.h"
+#include <string>
+#include <string_view>
+
+// The messages a host sends about a game, shared by SessionHost and CoroutineHost so both put the
+// same bytes on the wire. 'seat' is 0 or 1 (logic player seat + 1).
+
+// Names travel as single protocol tokens (WELCOME splits on spaces); an empty name is "Player".
+std::string ToToken(std::string_view text);
+
+// Boards the builders below fill; a host keeps one so their capacity is reused.
+struct GameViewBoards {
+    std::string first;
+    std::string second;
+};
+
+// The game from one seat's view: the opponent's board with unhit ships hidden, then the seat's
+// own board. GAME_SNAPSHOT for a v2 seat, GAME_UPDATE for v1.
+void BuildSeatState(MessageBuilder& out, const GameSession& game, unsigned int seq, int seat, int protocolVersion, GameViewBoards& boards);
+
+// What a seat is sent after a change: a v2 seat gets the GAME_DELTA of an accepted move (numbered
+// 'seq'), anything else the full state above.
+void BuildSeatUpdate(MessageBuilder& out, const GameSession& game, unsigned int seq, int seat, int protocolVersion, bool moveAccepted, GameViewBoards& boards);
+
+// The GAME_SNAPSHOT a spectator is sent: player 2's view with both fleets hidden.
+void BuildSpectatorState(MessageBuilder& out, const GameSession& game, unsigned int seq, GameViewBoards& boards);
@@ -0,0 +1,256 @@
+// JournalReplay.cpp (battleship-replay)
+// Replays battleship-server journals (see GameJournal.h), read through a read-only memory mapping.
+// Every game is rebuilt from its recorded seed and fleets and each recorded move must reproduce
+// its recorded outcome; the tool reports games, moves, mismatches and replay speed. With
+// --game ID it prints that game as it stood after --move K (default: its last move) instead;
+// --solve adds an exact endgame analysis (EndgameSolver) of that position for the player to move.
+#include "GameJournal.h"
+#include "EndgameSolver.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct ReplayOptions {
+        std::vector<std::string> paths;
+        bool showGame = false; // --game given
+        uint64_t gameId = 0;
+        long long moveIndex = -1; // -1 = all moves
+        bool solve = false;       // --solve: analyse the shown position
+        double solveMs = 5000.0;  // --solve-ms
+        EndgameLimits limits;     // Set from solveMs by ParseOptions
+    };
+
+    struct ReplayTotals {
+        uint64_t games = 0;
+        uint64_t finished = 0;  // Ended by a GAME_END marked finished
+        uint64_t abandoned = 0; // Ended by a GAME_END marked abandoned
+        uint64_t open = 0;      // No GAME_END before the end of the file or a restart of the id
+        uint64_t moves = 0;
+        uint64_t mismatched = 0; // Replays that did not reproduce the record
+        uint64_t orphanMoves = 0; // Moves or ends for a game id with no game start
+        uint64_t truncatedFiles = 0;
+    };
+
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() {
+            if (data && size) munmap(const_cast<uint8_t*>(data), size);
+            if (fd >= 0) close(fd);
+        }
+        bool Open(const std::string& path) {
+            fd = open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (fd < 0 || fstat(fd, &info) != 0) return false;
+            size = static_cast<size_t>(info.st_size);
+            if (size == 0) return true;
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) { size = 0; return false; }
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const uint8_t*>(mapped);
+            return true;
+        }
+        const uint8_t* GetData() const { return data; }
+        size_t GetSize() const { return size; }
+
+    private:
+        int fd = -1;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct PendingGame {
+        JournalGameStart start;
+        std::vector<JournalMove> moves;
+    };
+
+    template <int N>
+    void PrintGame(const BasicBattleshipGameLogic<N>& logic, size_t movesPlayed) {
+        std::printf("%s vs %s, %dx%d, seed %016llx, after %zu move(s)\n", logic.GetPlayer1()->getName().c_str(),
+            logic.GetPlayer2()->getName().c_str(), N, N, static_cast<unsigned long long>(logic.GetSeed()), movesPlayed);
+        std::printf("%s\n", logic.GetLastActionMessage().c_str());
+        for (int r = 0; r < N; ++r) {
+            std::string line;
+            for (int c = 0; c < N; ++c) line += logic.GetPlayer1()->getOwnBoardCell(r, c);
+            line += "   ";
+            for (int c = 0; c < N; ++c) line += logic.GetPlayer2()->getOwnBoardCell(r, c);
+            std::printf("%s\n", line.c_str());
+        }
+    }
+
+    // Best shot for the player to move, from what the shots so far have shown. The journal knows
+    // the real fleets, so sunk ships' cells are blocked exactly (the AI has to work them out).
+    template <int N>
+    void PrintEndgameAnalysis(const BasicBattleshipGameLogic<N>& logic, const JournalMove* next, const EndgameLimits& limits) {
+        if (logic.IsGameOver()) { std::printf("Endgame: the game is over.\n"); return; }
+        bool player1ToMove = logic.GetCurrentTurnState() == GameTurn::PLAYER1;
+        const BasicPlayer<N>& defender = player1ToMove ? *logic.GetPlayer2() : *logic.GetPlayer1();
+        typename BasicPlayer<N>::Board hits = defender.getOwnHitMask(), blocked = defender.getOwnMissMask();
+        int sizes[MAX_ENDGAME_SHIPS];
+        int afloat = 0;
+        for (int i = 0; i < defender.getShipCount(); ++i) {
+            const Ship& ship = defender.getShip(i);
+            if (!ship.isSunk()) {
+                if (afloat == MAX_ENDGAME_SHIPS) { std::printf("Endgame: more than %d ships afloat.\n", MAX_ENDGAME_SHIPS); return; }
+                sizes[afloat++] = ship.getSize();
+                continue;
+            }
+            for (int k = 0; k < ship.getCellCount(); ++k) {
+                int cell = BasicPlayer<N>::Board::cellIndex(ship.getCell(k).row, ship.getCell(k).col);
+                hits.reset(cell);
+                blocked.set(cell);
+            }
+        }
+        BasicEndgameSolver<N> solver(limits);
+        EndgameResult result;
+        auto begin = std::chrono::steady_clock::now();
+        bool solved = solver.solve(hits, blocked, sizes, afloat, result);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        std::printf("Endgame for %s: %d ship(s) afloat, %zu%s layout(s), %llu node(s), %llu table hit(s), %.1f ms\n",
+            (player1ToMove ? logic.GetPlayer1() : logic.GetPlayer2())->getName().c_str(), afloat, result.layouts,
+            result.layouts > limits.maxLayouts ? "+" : "", static_cast<unsigned long long>(result.nodes),
+            static_cast<unsigned long long>(result.tableHits), ms);
+        if (solved) std::printf("  best shot (%d,%d), %.3f expected shots to finish\n", result.row, result.col, result.expectedShots);
+        else std::printf("  not solved within the limits\n");
+        if (next) std::printf("  played (%d,%d)\n", next->row, next->col);
+    }
+
+    // One reusable game per board size, so replaying millions of games does not reallocate players.
+    class GameReplayer {
+    public:
+        // 'solveLimits' (print only): also analyse the endgame of the printed position.
+        bool Replay(const PendingGame& game, size_t moveCount, bool print, const EndgameLimits* solveLimits = nullptr) {
+            switch (game.start.boardSize) {
+            case 10: return ReplaySized(game, moveCount, print, solveLimits, game10);
+            case 15: return ReplaySized(game, moveCount, print, solveLimits, game15);
+            case 20: return ReplaySized(game, moveCount, print, solveLimits, game20);
+            case 32: return ReplaySized(game, moveCount, print, solveLimits, game32);
+            default: return false;
+            }
+        }
+
+    private:
+        BasicBattleshipGameLogic<10> game10;
+        BasicBattleshipGameLogic<15> game15;
+        BasicBattleshipGameLogic<20> game20;
+        BasicBattleshipGameLogic<32> game32;
+
+        template <int N>
+        bool ReplaySized(const PendingGame& game, size_t moveCount, bool print, const EndgameLimits* solveLimits, BasicBattleshipGameLogic<N>& logic) {
+            bool ok = ReplayGame(game.start, game.moves.data(), moveCount, logic);
+            if (print && logic.GetPlayer1() && logic.GetPlayer2()) {
+                PrintGame(logic, moveCount);
+                if (ok && solveLimits) PrintEndgameAnalysis(logic, moveCount < game.moves.size() ? &game.moves[moveCount] : nullptr, *solveLimits);
+            }
+            return ok;
+        }
+    };
+
+    // Replays one journal file; returns false when --game was found and printed (nothing more to do).
+    bool ReplayFile(const uint8_t* data, size_t size, const ReplayOptions& options, GameReplayer& replayer, ReplayTotals& totals) {
+        JournalReader reader(data, size);
+        std::unordered_map<uint64_t, PendingGame> inProgress;
+        bool printed = false;
+        auto finish = [&](PendingGame& game) {
+            if (options.showGame) {
+                if (game.start.gameId != options.gameId || printed) return;
+                size_t moves = (options.moveIndex >= 0 && static_cast<size_t>(options.moveIndex) < game.moves.size())
+                    ? static_cast<size_t>(options.moveIndex) : game.moves.size();
+                if (!replayer.Replay(game, moves, true, options.solve ? &options.limits : nullptr)) std::printf("Replay does not match the journal.\n");
+                printed = true;
+                return;
+            }
+            totals.games++;
+            totals.moves += game.moves.size();
+            if (!replayer.Replay(game, game.moves.size(), false)) totals.mismatched++;
+        };
+
+        JournalRecord record;
+        while (!printed && reader.Next(record)) {
+            if (record.type == JournalRecordType::GAME_START) {
+                auto it = inProgress.find(record.start.gameId);
+                if (it != inProgress.end()) { totals.open++; finish(it->second); it->second.moves.clear(); }
+                else it = inProgress.emplace(record.start.gameId, PendingGame()).first;
+                it->second.start = record.start;
+                continue;
+            }
+            uint64_t gameId = (record.type == JournalRecordType::MOVE) ? record.move.gameId : record.end.gameId;
+            auto it = inProgress.find(gameId);
+            if (it == inProgress.end()) { totals.orphanMoves++; continue; }
+            if (record.type == JournalRecordType::MOVE) { it->second.moves.push_back(record.move); continue; }
+            if (record.end.finished) totals.finished++; else totals.abandoned++;
+            finish(it->second);
+            inProgress.erase(it);
+        }
+        if (!printed && reader.IsTruncated()) totals.truncatedFiles++;
+        for (auto& entry : inProgress) {
+            if (printed) break;
+            totals.open++;
+            finish(entry.second);
+        }
+        return !printed;
+    }
+
+    bool ParseOptions(int argc, char* argv[], ReplayOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--game" && hasValue) { options.gameId = std::strtoull(argv[++i], nullptr, 10); options.showGame = true; }
+            else if (arg == "--move" && hasValue) options.moveIndex = std::atoll(argv[++i]);
+            else if (arg == "--solve") options.solve = true;
+            else if (arg == "--solve-ms" && hasValue) options.solveMs = std::atof(argv[++i]);
+            else if (!arg.empty() && arg[0] == '-') return false;
+            else options.paths.push_back(arg);
+        }
+        // Offline there is time for far more than the AI allows itself; the clock is the search limit.
+        options.limits.maxLayouts = 1 << 16;
+        options.limits.maxNodes = 0;
+        options.limits.timeBudgetMs = options.solveMs;
+        options.limits.tableBytes = 64 << 20;
+        return !options.paths.empty() && (options.showGame || !options.solve);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::printf("Usage: battleship-replay JOURNAL... [--game ID [--move K] [--solve [--solve-ms MS]]]\n");
+        return 2;
+    }
+    GameReplayer replayer;
+    ReplayTotals totals;
+    size_t bytes = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (const std::string& path : options.paths) {
+        MappedFile file;
+        if (!file.Open(path)) { std::fprintf(stderr, "battleship-replay: cannot read %s\n", path.c_str()); return 1; }
+        JournalReader check(file.GetData(), file.GetSize());
+        if (!check.IsValid()) { std::fprintf(stderr, "battleship-replay: %s is not a game journal\n", path.c_str()); return 1; }
+        bytes += file.GetSize();
+        if (!ReplayFile(file.GetData(), file.GetSize(), options, replayer, totals)) return 0;
+    }
+    if (options.showGame) {
+        std::fprintf(stderr, "battleship-replay: game %llu not found\n", static_cast<unsigned long long>(options.gameId));
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::printf("games=%llu finished=%llu abandoned=%llu open=%llu moves=%llu mismatched=%llu orphan=%llu truncated_files=%llu\n",
+        static_cast<unsigned long long>(totals.games), static_cast<unsigned long long>(totals.finished),
+        static_cast<unsigned long long>(totals.abandoned), static_cast<unsigned long long>(totals.open),
+        static_cast<unsigned long long>(totals.moves), static_cast<unsigned long long>(totals.mismatched),
+        static_cast<unsigned long long>(totals.orphanMoves), static_cast<unsigned long long>(totals.truncatedFiles));
+    std::printf("bytes=%zu bytes/move=%.1f elapsed=%.3fs games/s=%.0f moves/s=%.0f\n", bytes,
+        totals.moves ? static_cast<double>(bytes) / totals.moves : 0.0, elapsed,
+        elapsed > 0 ? totals.games / elapsed : 0.0, elapsed > 0 ? totals.moves / elapsed : 0.0);
+    return totals.mismatched == 0 ? 0 : 1;
+}
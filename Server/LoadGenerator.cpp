@@ -0,0 +1,354 @@
+// LoadGenerator.cpp (battleship-loadgen)
+// Loopback load test for battleship-server: every bot speaks the WinForms client protocol
+// (CONNECT_REQUEST, READY, ATTACK) and plays random untried cells until the game ends,
+// then reconnects for another game. With --protocol 2 the bots negotiate GAME_SNAPSHOT /
+// GAME_DELTA updates instead of full GAME_UPDATEs. With --rating-spread each bot sends a random
+// RATING first, for testing the server's matchmaking. With --spectators, that many more connections
+// SPECTATE the bots' games and only count what they receive. With --resume a bot whose connection
+// drops mid-game (the server was killed or stopped) keeps connecting until the server is back and
+// RESUMEs its game, for testing a server with a session store. Reports moves/sec, games/sec,
+// bytes/move, how long bots waited from CONNECT_REQUEST to WELCOME, and spectator messages/sec.
+#include "Protocol.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct LoadOptions {
+        std::string host = "127.0.0.1";
+        int port = 12345;
+        int clients = 1000; // Must be even: the server pairs bots two by two
+        int threads = 1;
+        int durationSeconds = 10;
+        unsigned int seed = 1;
+        int protocol = PROTOCOL_V1;
+        int ratingSpread = -1; // >= 0: bots send RATING DEFAULT_RATING +- up to this
+        int spectators = 0;
+        bool resume = false;
+    };
+
+    const int MAX_RESUME_ATTEMPTS = 16; // RESUMEs answered with DISCONNECT (another server thread) before a bot gives up on its game
+
+    struct LoadCounters {
+        std::atomic<uint64_t> moves{ 0 };
+        std::atomic<uint64_t> gameEnds{ 0 }; // Both bots of a game see its end
+        std::atomic<uint64_t> errors{ 0 };
+        std::atomic<uint64_t> bytesReceived{ 0 };
+        std::atomic<uint64_t> resyncs{ 0 };
+        std::atomic<uint64_t> spectatorMessages{ 0 };
+        std::atomic<uint64_t> spectatorBytes{ 0 };
+        std::atomic<uint64_t> resumed{ 0 };
+    };
+
+    struct Bot {
+        int fd = -1;
+        int index = 0;
+        std::string inBuffer;
+        std::string opponentBoard; // Tracking view: 'X' / 'O' for cells already shot
+        int boardSize = 0;
+        unsigned int seq = 0; // Last GAME_SNAPSHOT / GAME_DELTA sequence number
+        std::chrono::steady_clock::time_point connectSent;
+        bool welcomed = false;
+        bool spectator = false; // Index >= LoadOptions::clients
+        bool resuming = false;  // Sent RESUME instead of CONNECT_REQUEST
+    };
+
+    // What a bot sends to RESUME its game (from SESSION).
+    struct ResumeKey {
+        unsigned int slot = 0;
+        unsigned int generation = 0;
+        uint64_t token = 0;
+        int attempts = 0;
+    };
+
+    int ConnectBot(const LoadOptions& options) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options.port));
+        inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { ::close(fd); return -1; }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd;
+    }
+
+    bool SendLine(int fd, std::string_view line) {
+        std::string data(line);
+        data += '\n';
+        size_t sent = 0;
+        while (sent < data.size()) { // Lines are tiny; a blocking send is fine on loopback
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) { if (n < 0 && errno == EINTR) continue; return false; }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    class LoadThread {
+    public:
+        LoadThread(const LoadOptions& o, LoadCounters& c, int firstIndex, int count, int firstSpectator, int spectators, unsigned int seed)
+            : options(o), counters(c), rng(seed) {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            for (int i = 0; i < count; ++i) StartBot(firstIndex + i);
+            for (int i = 0; i < spectators; ++i) StartBot(options.clients + firstSpectator + i);
+        }
+        ~LoadThread() {
+            for (auto& entry : bots) ::close(entry.first);
+            ::close(epollFd);
+        }
+
+        void Run(const std::atomic<bool>& stop) {
+            epoll_event events[256];
+            while (!stop.load(std::memory_order_relaxed)) {
+                int n = epoll_wait(epollFd, events, 256, 50);
+                for (int i = 0; i < n; ++i) {
+                    auto it = bots.find(events[i].data.fd);
+                    if (it != bots.end()) HandleReadable(it->second);
+                }
+                due.swap(restart); // StartBot may queue a bot again, for a server not back yet
+                for (int index : due) StartBot(index);
+                due.clear();
+            }
+        }
+        const std::vector<double>& GetPairingSeconds() const { return pairingSeconds; }
+
+    private:
+        const LoadOptions& options;
+        LoadCounters& counters;
+        std::mt19937 rng;
+        int epollFd = -1;
+        std::unordered_map<int, Bot> bots;
+        std::vector<int> restart;
+        std::vector<int> due;
+        std::unordered_map<int, ResumeKey> resumeKeys; // By bot index, with --resume
+        MessageBuilder out;
+        std::vector<double> pairingSeconds; // CONNECT_REQUEST to WELCOME, per game played
+
+        void StartBot(int index) {
+            int fd = ConnectBot(options);
+            if (fd < 0 && resumeKeys.count(index)) { restart.push_back(index); return; } // Try again after the next wait
+            if (fd < 0) { counters.errors.fetch_add(1); return; }
+            Bot& bot = bots[fd];
+            bot.fd = fd;
+            bot.index = index;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            bot.spectator = index >= options.clients;
+            if (bot.spectator) { // Follows whichever game is newest on its server thread
+                if (!SendLine(fd, MessageTypeName(MessageType::SPECTATE))) Retire(bot, true);
+                return;
+            }
+            if (options.protocol >= PROTOCOL_V2 && !SendLine(fd, out.Begin(MessageType::PROTOCOL).Add(PROTOCOL_V2).GetText())) { Retire(bot, true); return; }
+            auto key = resumeKeys.find(index);
+            if (key != resumeKeys.end()) {
+                bot.resuming = true;
+                const ResumeKey& k = key->second;
+                if (!SendLine(fd, out.Begin(MessageType::RESUME).Add(k.slot).Add(k.generation).Add(k.token).GetText())) Retire(bot, false, true);
+                return;
+            }
+            if (options.ratingSpread >= 0) {
+                int rating = DEFAULT_RATING + std::uniform_int_distribution<int>(-options.ratingSpread, options.ratingSpread)(rng);
+                if (!SendLine(fd, out.Begin(MessageType::RATING).Add(rating).GetText())) { Retire(bot, true); return; }
+            }
+            bot.connectSent = std::chrono::steady_clock::now();
+            if (!SendLine(fd, out.Begin(MessageType::CONNECT_REQUEST).Add("bot" + std::to_string(index)).GetText())
+                || !SendLine(fd, MessageTypeName(MessageType::READY))) Retire(bot, true);
+        }
+
+        // 'mayResume': the bot comes back for its game (with --resume, if it has had a SESSION).
+        void Retire(Bot& bot, bool error, bool mayResume = false) {
+            if (error) counters.errors.fetch_add(1);
+            int index = bot.index;
+            if (!mayResume) resumeKeys.erase(index);
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, bot.fd, nullptr);
+            ::close(bot.fd);
+            bots.erase(bot.fd);
+            restart.push_back(index);
+        }
+
+        void HandleReadable(Bot& bot) {
+            char buffer[8192];
+            ssize_t got = ::recv(bot.fd, buffer, sizeof(buffer), 0);
+            if (got <= 0) {
+                if (resumeKeys.count(bot.index)) Retire(bot, false, true); // The server went away mid-game
+                else Retire(bot, true);
+                return;
+            }
+            (bot.spectator ? counters.spectatorBytes : counters.bytesReceived).fetch_add(static_cast<uint64_t>(got), std::memory_order_relaxed);
+            bot.inBuffer.append(buffer, static_cast<size_t>(got));
+            size_t start = 0, end;
+            while ((end = bot.inBuffer.find('\n', start)) != std::string::npos) {
+                std::string_view line(bot.inBuffer.data() + start, end - start);
+                start = end + 1;
+                if (!HandleLine(bot, line)) return; // Bot retired; its buffer is gone
+            }
+            bot.inBuffer.erase(0, start);
+        }
+
+        // Returns false once the bot has been retired.
+        bool HandleLine(Bot& bot, std::string_view line) {
+            ProtocolMessage message;
+            if (!ParseMessage(line, message)) return true;
+            if (bot.spectator) {
+                if (message.type == MessageType::DISCONNECT) { Retire(bot, false); return false; }
+                if (message.type == MessageType::GAME_DELTA || message.type == MessageType::GAME_SNAPSHOT) counters.spectatorMessages.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            switch (message.type) {
+            case MessageType::DISCONNECT:
+                if (bot.resuming && !bot.welcomed) { // Not this thread's game, or gone; try another connection
+                    auto key = resumeKeys.find(bot.index);
+                    Retire(bot, false, key != resumeKeys.end() && ++key->second.attempts < MAX_RESUME_ATTEMPTS);
+                }
+                else Retire(bot, false);
+                return false;
+            case MessageType::SERVER_SHUTDOWN: Retire(bot, false, true); return false;
+            case MessageType::SESSION: return HandleSession(bot, message);
+            case MessageType::WELCOME:
+                if (bot.resuming) {
+                    if (!bot.welcomed) counters.resumed.fetch_add(1, std::memory_order_relaxed);
+                    resumeKeys[bot.index].attempts = 0;
+                }
+                else if (!bot.welcomed) pairingSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - bot.connectSent).count());
+                bot.welcomed = true;
+                return true;
+            case MessageType::GAME_DELTA: return HandleDelta(bot, message);
+            case MessageType::GAME_UPDATE: case MessageType::GAME_SNAPSHOT: return HandleUpdate(bot, message);
+            default: return true;
+            }
+        }
+
+        bool HandleSession(Bot& bot, const ProtocolMessage& message) {
+            ResumeKey key;
+            if (!options.resume || message.GetArgCount() < 3 || !ParseField(message.fields[1], key.slot)
+                || !ParseField(message.fields[2], key.generation) || !ParseField(message.fields[3], key.token)) return true;
+            resumeKeys[bot.index] = key;
+            return true;
+        }
+
+        bool HandleUpdate(Bot& bot, const ProtocolMessage& message) {
+            GameUpdate update;
+            if (!ParseGameUpdate(message, update)) { Retire(bot, true); return false; }
+            if (message.type == MessageType::GAME_SNAPSHOT) bot.seq = update.seq;
+            bot.opponentBoard.assign(update.player1Board);
+            bot.boardSize = 0;
+            while ((bot.boardSize + 1) * (bot.boardSize + 1) <= static_cast<int>(bot.opponentBoard.size())) ++bot.boardSize;
+            if (update.gameOver) { counters.gameEnds.fetch_add(1); Retire(bot, false); return false; }
+            if (update.turnId != 2) return true; // Opponent's turn
+            return Attack(bot);
+        }
+
+        bool HandleDelta(Bot& bot, const ProtocolMessage& message) {
+            GameDelta delta;
+            if (!ParseGameDelta(message, delta) || bot.boardSize <= 0) { Retire(bot, true); return false; }
+            if (delta.seq != bot.seq + 1) { // Missed an update: ask for a snapshot
+                counters.resyncs.fetch_add(1, std::memory_order_relaxed);
+                if (!SendLine(bot.fd, MessageTypeName(MessageType::RESYNC))) { Retire(bot, true); return false; }
+                return true;
+            }
+            bot.seq = delta.seq;
+            if (delta.attackerId == 2) bot.opponentBoard[delta.row * bot.boardSize + delta.col] = (delta.result == MISS_CHAR) ? MISS_CHAR : HIT_CHAR;
+            if (delta.gameOver) { counters.gameEnds.fetch_add(1); Retire(bot, false); return false; }
+            if (delta.nextTurnId != 2) return true;
+            return Attack(bot);
+        }
+
+        bool Attack(Bot& bot) {
+            const std::string& board = bot.opponentBoard;
+            int n = bot.boardSize;
+            std::vector<int> untried;
+            untried.reserve(board.size());
+            for (size_t i = 0; i < board.size(); ++i) if (board[i] != HIT_CHAR && board[i] != MISS_CHAR) untried.push_back(static_cast<int>(i));
+            if (untried.empty() || n <= 0) { Retire(bot, true); return false; }
+            int cell = untried[std::uniform_int_distribution<size_t>(0, untried.size() - 1)(rng)];
+            if (!SendLine(bot.fd, out.Begin(MessageType::ATTACK).Add(cell / n).Add(cell % n).GetText())) { Retire(bot, true); return false; }
+            counters.moves.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    };
+
+    bool ParseOptions(int argc, char* argv[], LoadOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--host" && hasValue) options.host = argv[++i];
+            else if (arg == "--port" && hasValue) options.port = std::atoi(argv[++i]);
+            else if (arg == "--clients" && hasValue) options.clients = std::atoi(argv[++i]);
+            else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+            else if (arg == "--duration" && hasValue) options.durationSeconds = std::atoi(argv[++i]);
+            else if (arg == "--protocol" && hasValue) options.protocol = std::atoi(argv[++i]);
+            else if (arg == "--rating-spread" && hasValue) options.ratingSpread = std::atoi(argv[++i]);
+            else if (arg == "--spectators" && hasValue) options.spectators = std::atoi(argv[++i]);
+            else if (arg == "--resume") options.resume = true;
+            else if (arg == "--seed" && hasValue) options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            else return false;
+        }
+        return options.clients > 0 && options.threads > 0 && options.durationSeconds > 0 && options.spectators >= 0
+            && (options.protocol == PROTOCOL_V1 || options.protocol == PROTOCOL_V2);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::printf("Usage: battleship-loadgen [--host H] [--port P] [--clients N] [--threads T] [--duration SEC] [--seed S] [--protocol 1|2] [--rating-spread R] [--spectators N] [--resume]\n");
+        return 2;
+    }
+    if (options.clients % 2 != 0) options.clients++;
+    LoadCounters counters;
+    std::atomic<bool> stop{ false };
+    std::vector<std::unique_ptr<LoadThread>> loaders;
+    int perThread = options.clients / options.threads;
+    int spectatorsPerThread = options.spectators / options.threads;
+    for (int t = 0; t < options.threads; ++t) {
+        bool last = (t == options.threads - 1);
+        int count = last ? options.clients - perThread * t : perThread;
+        int spectators = last ? options.spectators - spectatorsPerThread * t : spectatorsPerThread;
+        loaders.push_back(std::make_unique<LoadThread>(options, counters, perThread * t, count, spectatorsPerThread * t, spectators, options.seed + t));
+    }
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (auto& loader : loaders) { LoadThread* l = loader.get(); threads.emplace_back([l, &stop]() { l->Run(stop); }); }
+    std::this_thread::sleep_for(std::chrono::seconds(options.durationSeconds));
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t moves = counters.moves.load();
+    std::printf("protocol=%d clients=%d duration=%.1fs moves=%llu games=%llu errors=%llu resyncs=%llu moves/s=%.0f games/s=%.1f bytes/move=%.0f\n",
+        options.protocol, options.clients, elapsed, static_cast<unsigned long long>(moves),
+        static_cast<unsigned long long>(counters.gameEnds.load() / 2), static_cast<unsigned long long>(counters.errors.load()),
+        static_cast<unsigned long long>(counters.resyncs.load()), moves / elapsed, counters.gameEnds.load() / 2.0 / elapsed,
+        moves ? static_cast<double>(counters.bytesReceived.load()) / moves : 0.0);
+    if (options.spectators > 0) {
+        std::printf("spectators=%d messages=%llu msgs/s=%.0f MB/s=%.1f\n", options.spectators, static_cast<unsigned long long>(counters.spectatorMessages.load()),
+            counters.spectatorMessages.load() / elapsed, counters.spectatorBytes.load() / elapsed / 1e6);
+    }
+    if (options.resume) std::printf("resumed=%llu\n", static_cast<unsigned long long>(counters.resumed.load()));
+    std::vector<double> pairing;
+    for (auto& loader : loaders) pairing.insert(pairing.end(), loader->GetPairingSeconds().begin(), loader->GetPairingSeconds().end());
+    if (!pairing.empty()) {
+        std::sort(pairing.begin(), pairing.end());
+        auto at = [&](double q) { return 1000.0 * pairing[static_cast<size_t>(q * static_cast<double>(pairing.size() - 1))]; };
+        std::printf("pairing: %zu welcomes p50=%.2fms p90=%.2fms p99=%.2fms max=%.2fms\n", pairing.size(), at(0.5), at(0.9), at(0.99), pairing.back() * 1000.0);
+    }
+    return counters.moves.load() > 0 ? 0 : 1;
+}
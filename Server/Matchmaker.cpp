@@ -0,0 +1,105 @@
+// Matchmaker.cpp
+#include "Matchmaker.h"
+#include <iterator>
+
+Matchmaker::Matchmaker(const MatchmakerOptions& o) : options(o) {}
+
+int Matchmaker::BucketOf(int rating) const {
+    if (options.bucketWidth <= 0) return 0;
+    int bucket = rating / options.bucketWidth;
+    return (rating < 0 && rating % options.bucketWidth != 0) ? bucket - 1 : bucket; // Round down for negative ratings too
+}
+
+int Matchmaker::RadiusOf(const Ticket& ticket, Clock::time_point now) const {
+    if (options.widenEvery.count() <= 0 || now <= ticket.enqueued) return 0;
+    return static_cast<int>((now - ticket.enqueued) / options.widenEvery);
+}
+
+// Only the nearest occupied bucket on each side is a candidate, which keeps this O(log n). A
+// farther player is not lost: once their range reaches this far, it also covers the nearer
+// player in between. A candidate fits when either player's range covers the distance; the nearer
+// wins, then the one who has waited longer.
+uint64_t Matchmaker::FindPartner(uint64_t id, int bucket, int radius, Clock::time_point now) const {
+    uint64_t best = COMPUTER;
+    int bestDistance = 0;
+    Clock::time_point bestEnqueued;
+    auto consider = [&](std::map<int, uint64_t>::const_iterator it) {
+        if (it->second == id) return;
+        const Ticket& other = tickets.at(it->second);
+        int distance = it->first > bucket ? it->first - bucket : bucket - it->first;
+        if (distance > radius && distance > RadiusOf(other, now)) return;
+        if (best == COMPUTER || distance < bestDistance || (distance == bestDistance && other.enqueued < bestEnqueued)) {
+            best = it->second;
+            bestDistance = distance;
+            bestEnqueued = other.enqueued;
+        }
+    };
+    auto above = waitingByBucket.lower_bound(bucket);
+    if (above != waitingByBucket.end() && above->first == bucket) { consider(above); ++above; }
+    if (above != waitingByBucket.end()) consider(above);
+    auto below = waitingByBucket.lower_bound(bucket);
+    if (below != waitingByBucket.begin()) consider(std::prev(below));
+    return best;
+}
+
+bool Matchmaker::Enqueue(uint64_t id, int rating, Clock::time_point now, Match& match) {
+    if (id == COMPUTER || tickets.count(id)) return false;
+    int bucket = BucketOf(rating);
+    uint64_t partner = FindPartner(id, bucket, 0, now);
+    if (partner != COMPUTER) {
+        Remove(partner);
+        match.first = partner;
+        match.second = id;
+        return true;
+    }
+    Ticket& ticket = tickets[id];
+    ticket.bucket = bucket;
+    ticket.enqueued = now;
+    waitingByBucket[bucket] = id;
+    Schedule(id, ticket, now);
+    return false;
+}
+
+bool Matchmaker::Cancel(uint64_t id) {
+    if (!tickets.count(id)) return false;
+    Remove(id);
+    return true;
+}
+
+void Matchmaker::Expire(Clock::time_point now, std::vector<Match>& matches) {
+    while (!events.empty() && events.begin()->first <= now) {
+        uint64_t id = events.begin()->second;
+        events.erase(events.begin());
+        Ticket& ticket = tickets.at(id);
+        if (options.computerAfter.count() > 0 && now - ticket.enqueued >= options.computerAfter) {
+            Remove(id);
+            matches.push_back(Match{ id, COMPUTER });
+            continue;
+        }
+        uint64_t partner = FindPartner(id, ticket.bucket, RadiusOf(ticket, now), now);
+        if (partner == COMPUTER) { Schedule(id, ticket, now); continue; }
+        Match match;
+        bool older = ticket.enqueued <= tickets.at(partner).enqueued;
+        match.first = older ? id : partner;
+        match.second = older ? partner : id;
+        Remove(id);
+        Remove(partner);
+        matches.push_back(match);
+    }
+}
+
+void Matchmaker::Remove(uint64_t id) {
+    auto it = tickets.find(id);
+    events.erase(std::make_pair(it->second.nextEvent, id));
+    waitingByBucket.erase(it->second.bucket);
+    tickets.erase(it);
+}
+
+// The ticket's next widening or its timeout, whichever comes first; nothing when neither applies.
+void Matchmaker::Schedule(uint64_t id, Ticket& ticket, Clock::time_point now) {
+    Clock::time_point next = Clock::time_point::max();
+    if (options.widenEvery.count() > 0 && options.bucketWidth > 0) next = ticket.enqueued + options.widenEvery * (RadiusOf(ticket, now) + 1);
+    if (options.computerAfter.count() > 0 && ticket.enqueued + options.computerAfter < next) next = ticket.enqueued + options.computerAfter;
+    ticket.nextEvent = next;
+    if (next != Clock::time_point::max()) events.insert(std::make_pair(next, id));
+}
@@ -0,0 +1,65 @@
+// Matchmaker.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Pairs waiting players into matches. Ratings are grouped into buckets of bucketWidth points (0:
+// one bucket for everyone); players in the same bucket are paired as soon as the second arrives.
+// A player who waits widens the range they accept by one bucket every widenEvery, and after
+// computerAfter gets a computer opponent instead (0: never). Because a bucket is emptied as soon
+// as a second player reaches it, each bucket holds at most one waiting player, and finding a
+// partner is a lookup of the nearest occupied buckets either side: every operation is O(log n) in
+// the number of waiting players.
+// Not thread-safe; each reactor thread has its own.
+struct MatchmakerOptions {
+    int bucketWidth = 0;
+    std::chrono::milliseconds widenEvery{ 5000 };  // 0: never widen
+    std::chrono::milliseconds computerAfter{ 0 };  // 0: wait for a human as long as it takes
+};
+
+class Matchmaker {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static const uint64_t COMPUTER = 0; // Match::second for a computer opponent; not a valid ticket id
+
+    struct Match {
+        uint64_t first = 0;  // Waited longer
+        uint64_t second = 0; // COMPUTER when first timed out
+    };
+
+    explicit Matchmaker(const MatchmakerOptions& options = MatchmakerOptions());
+
+    // Pairs ticket 'id' (any value but COMPUTER, unique among those waiting) with a waiting player
+    // whose range covers it and returns true, or queues it and returns false.
+    bool Enqueue(uint64_t id, int rating, Clock::time_point now, Match& match);
+    bool Cancel(uint64_t id); // False if 'id' is not waiting
+    // Widens every range that is due and appends the matches that makes, and the computer matches
+    // of players who have waited computerAfter, to 'matches'. Call it every tick.
+    void Expire(Clock::time_point now, std::vector<Match>& matches);
+
+    size_t GetWaitingCount() const { return tickets.size(); }
+    bool IsWaiting(uint64_t id) const { return tickets.count(id) != 0; }
+
+private:
+    struct Ticket {
+        int bucket = 0;
+        Clock::time_point enqueued;
+        Clock::time_point nextEvent;
+    };
+
+    MatchmakerOptions options;
+    std::unordered_map<uint64_t, Ticket> tickets;
+    std::map<int, uint64_t> waitingByBucket;                     // At most one ticket per bucket
+    std::set<std::pair<Clock::time_point, uint64_t>> events;     // Next widening or timeout of each ticket
+
+    int BucketOf(int rating) const;
+    int RadiusOf(const Ticket& ticket, Clock::time_point now) const; // Buckets either side it accepts
+    uint64_t FindPartner(uint64_t id, int bucket, int radius, Clock::time_point now) const; // COMPUTER if none
+    void Remove(uint64_t id);
+    void Schedule(uint64_t id, Ticket& ticket, Clock::time_point now);
+};
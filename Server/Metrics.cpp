@@ -0,0 +1,164 @@
+// Metrics.cpp
+#include "Metrics.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    const int EXPORTED_FIRST_BUCKET = 8; // Histogram buckets below this are folded into it
+    const int EXPORTED_LAST_BUCKET = 40; // ...and those above go to +Inf only
+    const int REQUEST_TIMEOUT_MS = 500;  // A scraper that does not send its request in time is dropped
+    const size_t MAX_REQUEST_BYTES = 4096;
+
+    double Calibrate() {
+#ifdef METRICS_HAVE_TSC
+        auto wallBegin = std::chrono::steady_clock::now();
+        uint64_t ticksBegin = MetricsTicks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t ticks = MetricsTicks() - ticksBegin;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallBegin).count();
+        return seconds > 0.0 ? static_cast<double>(ticks) / seconds : 1e9;
+#else
+        return static_cast<double>(std::chrono::steady_clock::period::den) / std::chrono::steady_clock::period::num;
+#endif
+    }
+
+    std::string FormatValue(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        return buffer;
+    }
+
+    bool WaitFor(int fd, short events, int timeoutMs) {
+        pollfd entry{ fd, events, 0 };
+        int ready;
+        do ready = poll(&entry, 1, timeoutMs); while (ready < 0 && errno == EINTR);
+        return ready > 0;
+    }
+}
+
+double MetricsTicksPerSecond() {
+    static const double ticksPerSecond = Calibrate();
+    return ticksPerSecond;
+}
+
+double LatencyQuantileSeconds(const std::vector<const LatencyHistogram*>& histograms, double q) {
+    uint64_t counts[LatencyHistogram::BUCKETS] = {};
+    uint64_t total = 0;
+    for (const LatencyHistogram* histogram : histograms) {
+        for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) counts[bucket] += histogram->GetCount(bucket);
+    }
+    for (uint64_t count : counts) total += count;
+    if (total == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    while (bucket < LatencyHistogram::BUCKETS - 1 && (cumulative += counts[bucket]) < rank) ++bucket;
+    return static_cast<double>(1ULL << bucket) / MetricsTicksPerSecond();
+}
+
+void PrometheusText::BeginFamily(const char* name, const char* type, const char* help) {
+    text += "# HELP "; text += name; text += ' '; text += help; text += '\n';
+    text += "# TYPE "; text += name; text += ' '; text += type; text += '\n';
+}
+
+void PrometheusText::Sample(const char* name, const std::string& labels, double value) {
+    text += name;
+    if (!labels.empty()) { text += '{'; text += labels; text += '}'; }
+    text += ' '; text += FormatValue(value); text += '\n';
+}
+
+void PrometheusText::Histogram(const char* name, const std::string& labels, const LatencyHistogram& histogram) {
+    double secondsPerTick = 1.0 / MetricsTicksPerSecond();
+    std::string prefix = labels.empty() ? std::string() : labels + ",";
+    uint64_t cumulative = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+        cumulative += histogram.GetCount(bucket);
+        if (bucket < EXPORTED_FIRST_BUCKET || bucket > EXPORTED_LAST_BUCKET) continue;
+        text += name; text += "_bucket{"; text += prefix;
+        text += "le=\""; text += FormatValue(static_cast<double>(1ULL << bucket) * secondsPerTick); text += "\"} ";
+        text += std::to_string(cumulative); text += '\n';
+    }
+    text += name; text += "_bucket{"; text += prefix; text += "le=\"+Inf\"} "; text += std::to_string(cumulative); text += '\n';
+    std::string suffixed = std::string(name) + "_sum";
+    Sample(suffixed.c_str(), labels, static_cast<double>(histogram.GetSumTicks()) * secondsPerTick);
+    suffixed = std::string(name) + "_count";
+    Sample(suffixed.c_str(), labels, static_cast<double>(cumulative));
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    if (clientFd >= 0) close(clientFd);
+    if (listenFd >= 0) close(listenFd);
+}
+
+bool MetricsEndpoint::Listen(int port, std::string& error) {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) { error = std::string("metrics socket: ") + std::strerror(errno); return false; }
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listenFd, 16) < 0) {
+        error = std::string("metrics port: ") + std::strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool MetricsEndpoint::AcceptRequest(int timeoutMs, bool& wantsMetrics) {
+    while (listenFd >= 0 && WaitFor(listenFd, POLLIN, timeoutMs)) {
+        clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) return false;
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES && WaitFor(clientFd, POLLIN, REQUEST_TIMEOUT_MS)) {
+            ssize_t got = recv(clientFd, buffer, sizeof(buffer), 0);
+            if (got <= 0) break;
+            request.append(buffer, static_cast<size_t>(got));
+        }
+        if (request.compare(0, 4, "GET ") == 0) {
+            size_t end = request.find(' ', 4);
+            std::string path = request.substr(4, end == std::string::npos ? std::string::npos : end - 4);
+            wantsMetrics = path == "/metrics" || path == "/";
+            return true;
+        }
+        close(clientFd); // Not HTTP, or too slow; wait for the next one
+        clientFd = -1;
+        timeoutMs = 0;
+    }
+    return false;
+}
+
+void MetricsEndpoint::Reply(const char* status, const std::string& body) {
+    std::string response = std::string("HTTP/1.0 ") + status + "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+        + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) { sent += static_cast<size_t>(n); continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && WaitFor(clientFd, POLLOUT, REQUEST_TIMEOUT_MS)) continue;
+        break;
+    }
+    close(clientFd);
+    clientFd = -1;
+}
+
+bool WriteMetricsFile(const std::string& path, const std::string& body) {
+    std::string temporary = path + ".tmp";
+    std::FILE* out = std::fopen(temporary.c_str(), "w");
+    if (!out) return false;
+    bool ok = std::fwrite(body.data(), 1, body.size(), out) == body.size();
+    ok &= std::fclose(out) == 0;
+    return ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+}
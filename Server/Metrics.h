@@ -0,0 +1,126 @@
+// Metrics.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define METRICS_HAVE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define METRICS_HAVE_TSC 1
+#endif
+
+// Timestamps for latency metrics: the time-stamp counter where there is one (a few ns, no
+// syscall), steady_clock otherwise. Only differences are meaningful; MetricsTicksPerSecond()
+// converts them when the metrics are exported.
+inline uint64_t MetricsTicks() {
+#ifdef METRICS_HAVE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+double MetricsTicksPerSecond(); // Calibrated against steady_clock on first use (about 20 ms)
+
+// Every LATENCY_SAMPLE_EVERY-th event of a kind is timed; counters count every event.
+const uint32_t LATENCY_SAMPLE_EVERY = 32; // A power of two
+
+// Latency distribution in power-of-two buckets of MetricsTicks: bucket b holds durations below
+// 2^b ticks (and at least 2^(b-1)). Written by one thread only, so updates are plain relaxed
+// stores rather than locked read-modify-writes; other threads read it for export.
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 48;
+
+    bool ShouldSample() { return (++sampleTick & (LATENCY_SAMPLE_EVERY - 1)) == 0; } // Owner thread only
+    void Record(uint64_t ticks) {
+#if defined(__GNUC__) || defined(__clang__)
+        int bits = ticks ? 64 - __builtin_clzll(ticks) : 0;
+#else
+        int bits = 0;
+        while (bits < 64 && (ticks >> bits) != 0) ++bits;
+#endif
+        int bucket = bits < BUCKETS ? bits : BUCKETS - 1;
+        counts[bucket].store(counts[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sumTicks.store(sumTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    }
+    uint64_t GetCount(int bucket) const { return counts[bucket].load(std::memory_order_relaxed); }
+    uint64_t GetSumTicks() const { return sumTicks.load(std::memory_order_relaxed); }
+
+private:
+    uint32_t sampleTick = 0;
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> sumTicks{ 0 };
+};
+
+// Quantile 'q' (0 to 1) of the histograms' samples taken together, in seconds: the upper bound of
+// the bucket it falls in, so it is accurate to within a factor of two. 0 when there are none.
+double LatencyQuantileSeconds(const std::vector<const LatencyHistogram*>& histograms, double q);
+
+// Times its own scope into 'histogram' when this is a sampled event.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& h) : histogram(h.ShouldSample() ? &h : nullptr), begin(histogram ? MetricsTicks() : 0) {}
+    ~ScopedLatency() { if (histogram) histogram->Record(MetricsTicks() - begin); }
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram;
+    uint64_t begin;
+};
+
+// Single-writer counter update (see LatencyHistogram).
+inline void AddToCounter(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Builds a Prometheus text exposition (version 0.0.4). Each metric family is declared once with
+// BeginFamily, then gets one sample (or histogram) per label set.
+class PrometheusText {
+public:
+    void BeginFamily(const char* name, const char* type, const char* help); // type: counter, gauge or histogram
+    void Sample(const char* name, const std::string& labels, double value); // labels: `thread="0"` or empty
+    void Histogram(const char* name, const std::string& labels, const LatencyHistogram& histogram); // In seconds
+    const std::string& GetText() const { return text; }
+
+private:
+    std::string text;
+};
+
+// Serves the exposition at http://127.0.0.1:<port>/metrics, one request at a time, from the thread
+// that calls Serve. Loopback only: the metrics are for a local scraper or agent.
+class MetricsEndpoint {
+public:
+    MetricsEndpoint() = default;
+    ~MetricsEndpoint();
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    bool Listen(int port, std::string& error);
+    bool IsListening() const { return listenFd >= 0; }
+    // Waits up to 'timeoutMs' for a scrape, answers it (and any others already waiting) with
+    // build(), and returns. Anything but GET /metrics or GET / gets a 404.
+    template <typename BuildText>
+    void Serve(int timeoutMs, BuildText build) {
+        bool wantsMetrics = false;
+        while (AcceptRequest(timeoutMs, wantsMetrics)) {
+            if (wantsMetrics) Reply("200 OK", build());
+            else Reply("404 Not Found", "not found\n");
+            timeoutMs = 0;
+        }
+    }
+
+private:
+    int listenFd = -1;
+    int clientFd = -1; // The request being answered
+    bool AcceptRequest(int timeoutMs, bool& wantsMetrics);
+    void Reply(const char* status, const std::string& body);
+};
+
+// Writes the exposition to 'path' through a temporary file and a rename, so readers never see
+// half a dump.
+bool WriteMetricsFile(const std::string& path, const std::string& body);
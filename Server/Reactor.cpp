@@ -0,0 +1,243 @@
+// Reactor.cpp
+#include "Reactor.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+Reactor::Reactor() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+Reactor::~Reactor() {
+    for (auto& entry : connections) ::close(entry.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+bool Reactor::Listen(const std::string& address, int port, std::string& error) {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) { error = std::string("socket: ") + std::strerror(errno); return false; }
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)); // Kernel spreads accepts across reactors
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) { error = "invalid listen address: " + address; return false; }
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { error = std::string("bind: ") + std::strerror(errno); return false; }
+    if (listen(listenFd, SOMAXCONN) < 0) { error = std::string("listen: ") + std::strerror(errno); return false; }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    return true;
+}
+
+void Reactor::Stop() {
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void Reactor::Run() {
+    running = true;
+    epoll_event events[256];
+    while (running) {
+        int n = epoll_wait(epollFd, events, 256, TICK_INTERVAL_MS);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) { running = false; continue; }
+            if (fd == listenFd) { AcceptAll(); continue; }
+            auto it = connections.find(fd);
+            if (it == connections.end() || it->second->closing) continue;
+            Connection& conn = *it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) { Close(conn); continue; }
+            if (events[i].events & EPOLLIN) HandleReadable(conn);
+            if (!conn.closing && (events[i].events & EPOLLOUT)) FlushWrites(conn);
+            CloseFailedWrites();
+        }
+        handler->OnTick();
+        CloseFailedWrites();
+        ReapClosed();
+    }
+    for (auto& entry : connections) if (!entry.second->closing) Close(*entry.second);
+    ReapClosed();
+}
+
+void Reactor::AcceptAll() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or a transient error; the listener stays registered
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // One short line per move
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->id = nextConnectionId++;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        Connection& ref = *conn;
+        connections[fd] = std::move(conn);
+        stats.connections.store(connections.size(), std::memory_order_relaxed);
+        handler->OnOpen(ref);
+    }
+}
+
+// Dispatches each chunk's lines before reading the next, so a peer that keeps sending without a
+// newline is cut off at MAX_LINE_LENGTH rather than growing inBuffer for as long as it can write.
+void Reactor::HandleReadable(Connection& conn) {
+    char buffer[16384];
+    while (!conn.closing) {
+        ssize_t got = ::recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            conn.inBuffer.append(buffer, static_cast<size_t>(got));
+            DispatchLines(conn);
+            if (conn.inBuffer.size() > MAX_LINE_LENGTH) Close(conn); // No protocol line is this long
+            continue;
+        }
+        if (got < 0 && errno == EINTR) continue;
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) Close(conn); // Its lines have been dispatched already
+        break;
+    }
+}
+
+void Reactor::DispatchLines(Connection& conn) {
+    size_t start = 0;
+    while (!conn.closing) {
+        size_t end = conn.inBuffer.find('\n', start);
+        if (end == std::string::npos) break;
+        size_t lineEnd = (end > start && conn.inBuffer[end - 1] == '\r') ? end - 1 : end;
+        AddToCounter(stats.linesReceived, 1);
+        {
+            ScopedLatency timing(stats.dispatchLatency);
+            handler->OnLine(conn, std::string_view(conn.inBuffer.data() + start, lineEnd - start));
+        }
+        start = end + 1;
+    }
+    conn.inBuffer.erase(0, start);
+}
+
+void Reactor::Send(Connection& conn, std::string_view line) {
+    if (conn.closing) return;
+    if (!conn.sharedOut.empty()) { SendShared(conn, SharedBuffer::MakeLine(line)); return; } // Keeps it behind what is queued
+    conn.outBuffer.append(line.data(), line.size());
+    conn.outBuffer.push_back('\n');
+    queuedBytes += line.size() + 1;
+    if (!conn.writeArmed) FlushWrites(conn);
+    else stats.queuedBytes.store(queuedBytes, std::memory_order_relaxed);
+}
+
+void Reactor::SendShared(Connection& conn, const SharedBuffer& line) {
+    if (conn.closing || line.IsEmpty()) return;
+    conn.sharedOut.push_back(line);
+    conn.sharedBytes += line.GetSize();
+    queuedBytes += line.GetSize();
+    if (!conn.writeArmed) FlushWrites(conn);
+    else stats.queuedBytes.store(queuedBytes, std::memory_order_relaxed);
+}
+
+// outBuffer first, then the shared buffers in order, gathered into one sendmsg.
+void Reactor::FlushWrites(Connection& conn) {
+    size_t sent = 0;
+    bool failed = false;
+    {
+        ScopedLatency timing(stats.sendLatency);
+        while (GetQueuedBytes(conn) > 0) {
+            iovec parts[MAX_WRITE_PARTS];
+            int count = 0;
+            if (!conn.outBuffer.empty()) parts[count++] = iovec{ &conn.outBuffer[0], conn.outBuffer.size() };
+            size_t offset = conn.sharedOffset;
+            for (auto it = conn.sharedOut.begin(); it != conn.sharedOut.end() && count < MAX_WRITE_PARTS; ++it, offset = 0) {
+                parts[count++] = iovec{ const_cast<char*>(it->GetData()) + offset, it->GetSize() - offset };
+            }
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = static_cast<size_t>(count);
+            ssize_t n = ::sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+            if (n > 0) { sent += static_cast<size_t>(n); ConsumeSent(conn, static_cast<size_t>(n)); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            failed = true;
+            break;
+        }
+    }
+    AddToCounter(stats.bytesSent, sent);
+    queuedBytes -= sent;
+    stats.queuedBytes.store(queuedBytes, std::memory_order_relaxed);
+    if (failed) { // Closed from Run, not here: a Send must not call back into the handler that made it
+        conn.writeArmed = true; // Nothing more is written
+        failedWrites.push_back(conn.fd);
+        return;
+    }
+    bool needWrite = GetQueuedBytes(conn) > 0;
+    if (needWrite != conn.writeArmed) {
+        conn.writeArmed = needWrite;
+        UpdateInterest(conn);
+    }
+}
+
+void Reactor::ConsumeSent(Connection& conn, size_t sent) {
+    size_t fromOut = sent < conn.outBuffer.size() ? sent : conn.outBuffer.size();
+    conn.outBuffer.erase(0, fromOut);
+    sent -= fromOut;
+    conn.sharedBytes -= sent;
+    while (sent > 0) {
+        size_t left = conn.sharedOut.front().GetSize() - conn.sharedOffset;
+        if (sent < left) { conn.sharedOffset += sent; break; }
+        sent -= left;
+        conn.sharedOut.pop_front();
+        conn.sharedOffset = 0;
+    }
+}
+
+void Reactor::UpdateInterest(Connection& conn) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (conn.writeArmed ? EPOLLOUT : 0u);
+    ev.data.fd = conn.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void Reactor::Close(Connection& conn) {
+    if (conn.closing) return;
+    conn.closing = true;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.fd, nullptr);
+    pendingClose.push_back(conn.fd);
+    handler->OnClose(conn);
+}
+
+void Reactor::CloseFailedWrites() {
+    while (!failedWrites.empty()) { // Closing one can make the handler write to, and fail, another
+        int fd = failedWrites.back();
+        failedWrites.pop_back();
+        auto it = connections.find(fd);
+        if (it != connections.end() && !it->second->closing) Close(*it->second);
+    }
+}
+
+void Reactor::ReapClosed() {
+    if (pendingClose.empty()) return;
+    for (int fd : pendingClose) {
+        auto it = connections.find(fd);
+        if (it != connections.end()) queuedBytes -= GetQueuedBytes(*it->second);
+        connections.erase(fd);
+        ::close(fd);
+    }
+    pendingClose.clear();
+    stats.queuedBytes.store(queuedBytes, std::memory_order_relaxed);
+    stats.connections.store(connections.size(), std::memory_order_relaxed);
+}
@@ -0,0 +1,98 @@
+// Reactor.h
+#pragma once
+#include "Metrics.h"
+#include "SharedBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One TCP connection owned by a Reactor. Lines are '\n'-terminated, like the WinForms client's
+// StreamReader::ReadLine / SendNetMessage pair.
+struct Connection {
+    int fd = -1;
+    uint64_t id = 0;
+    std::string inBuffer;
+    std::string outBuffer;
+    std::deque<SharedBuffer> sharedOut; // Queued after outBuffer; see Reactor::SendShared
+    size_t sharedOffset = 0;            // Bytes of sharedOut.front() already sent
+    size_t sharedBytes = 0;             // Bytes of sharedOut not yet sent
+    bool closing = false;
+    bool writeArmed = false; // EPOLLOUT registered because the output could not be flushed
+    void* userData = nullptr; // Owned by the ReactorHandler
+    int userSeat = 0;
+};
+
+// Counters owned by one reactor thread; other threads only read them for reporting.
+struct ReactorStats {
+    LatencyHistogram dispatchLatency;      // Handling one received line (OnLine), the sends it makes included
+    LatencyHistogram sendLatency;          // Flushing a connection's output to the kernel
+    std::atomic<uint64_t> linesReceived{ 0 };
+    std::atomic<uint64_t> bytesSent{ 0 };
+    std::atomic<uint64_t> queuedBytes{ 0 }; // Output accepted by Send and not yet taken by the kernel
+    std::atomic<uint64_t> connections{ 0 };
+};
+
+class ReactorHandler {
+public:
+    virtual ~ReactorHandler() = default;
+    virtual void OnOpen(Connection& conn) = 0;
+    virtual void OnLine(Connection& conn, std::string_view line) = 0;
+    virtual void OnClose(Connection& conn) = 0; // Called once, before the connection is destroyed
+    virtual void OnTick() {} // Called at least every tick interval from the reactor thread
+};
+
+// Single-threaded epoll loop. Each server thread runs its own Reactor with its own SO_REUSEPORT
+// listener, so connections, sessions and their state never cross threads.
+class Reactor {
+public:
+    Reactor();
+    ~Reactor();
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void SetHandler(ReactorHandler& h) { handler = &h; } // Required before Run()
+    bool Listen(const std::string& address, int port, std::string& error);
+    void Run();  // Returns after Stop()
+    void Stop(); // Thread-safe
+    bool IsRunning() const { return running; } // False while Run closes the connections after Stop()
+
+    void Send(Connection& conn, std::string_view line); // Appends '\n'
+    // Queues a line built once for many connections (SharedBuffer::MakeLine) without copying it;
+    // the output goes out with one sendmsg per flush, shared buffers and all.
+    void SendShared(Connection& conn, const SharedBuffer& line);
+    size_t GetQueuedBytes(const Connection& conn) const { return conn.outBuffer.size() + conn.sharedBytes; }
+    void Close(Connection& conn);
+    size_t ConnectionCount() const { return connections.size(); }
+    const ReactorStats& GetStats() const { return stats; }
+
+    static const size_t MAX_LINE_LENGTH = 4096;
+    static const int TICK_INTERVAL_MS = 100;
+    static const int MAX_WRITE_PARTS = 64; // iovecs per sendmsg
+
+private:
+    ReactorHandler* handler = nullptr;
+    int epollFd = -1;
+    int listenFd = -1;
+    int wakeFd = -1; // eventfd used by Stop()
+    bool running = false;
+    uint64_t nextConnectionId = 1;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::vector<int> pendingClose;
+    std::vector<int> failedWrites; // Connections whose socket failed during a write
+    ReactorStats stats;
+    uint64_t queuedBytes = 0; // Sum of GetQueuedBytes over the connections
+
+    void AcceptAll();
+    void HandleReadable(Connection& conn);
+    void DispatchLines(Connection& conn); // The complete lines in inBuffer, which keeps the rest
+    void FlushWrites(Connection& conn);
+    void ConsumeSent(Connection& conn, size_t sent);
+    void UpdateInterest(Connection& conn);
+    void CloseFailedWrites();
+    void ReapClosed();
+};
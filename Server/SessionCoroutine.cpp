@@ -0,0 +1,54 @@
+// SessionCoroutine.cpp
+#include "SessionCoroutine.h"
+
+void InboxTimers::Fire(Clock::time_point now) {
+    while (!due.empty() && due.begin()->first <= now) { // A resumed coroutine may add or cancel others
+        Inbox* inbox = due.begin()->second;
+        due.erase(due.begin());
+        inbox->timerSet = false;
+        inbox->Push(InboxEvent::Kind::TIMEOUT, 0);
+    }
+}
+
+void Inbox::Push(InboxEvent::Kind kind, int seat, std::string_view line) {
+    if (!waiter) {
+        queued.push_back(Queued{ kind, seat, std::string(line) });
+        return;
+    }
+    CancelTimer();
+    delivered = InboxEvent{ kind, seat, line };
+    hasDelivered = true;
+    std::coroutine_handle<> handle = waiter;
+    waiter = nullptr;
+    handle.resume();
+}
+
+void Inbox::MoveTo(Inbox& other, int seat) {
+    for (Queued& event : queued) other.queued.push_back(Queued{ event.kind, seat, std::move(event.line) });
+    queued.clear();
+}
+
+void Inbox::CancelTimer() {
+    if (!timerSet) return;
+    timers.due.erase(timer);
+    timerSet = false;
+}
+
+void Inbox::NextAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    inbox.waiter = handle;
+    if (deadline == Clock::time_point::max()) return;
+    inbox.timer = inbox.timers.due.emplace(deadline, &inbox);
+    inbox.timerSet = true;
+}
+
+InboxEvent Inbox::NextAwaiter::await_resume() {
+    if (inbox.hasDelivered) {
+        inbox.hasDelivered = false;
+        return inbox.delivered;
+    }
+    Queued& event = inbox.queued.front();
+    inbox.current.swap(event.line);
+    InboxEvent result{ event.kind, event.seat, inbox.current };
+    inbox.queued.pop_front();
+    return result;
+}
@@ -0,0 +1,100 @@
+// SessionCoroutine.h
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <string>
+#include <string_view>
+
+// What CoroutineHost writes its sessions with (C++20 coroutines). Everything here belongs to one
+// reactor thread: a coroutine is only ever resumed by that thread, from a Push or a timer.
+
+// The return type of a coroutine nobody waits for: it runs until its first co_await that has to
+// wait, and frees its own frame when it returns.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return DetachedTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct InboxEvent {
+    enum class Kind : uint8_t { LINE, CLOSED, TIMEOUT };
+    Kind kind = Kind::LINE;
+    int seat = 0;           // Which connection it came from, for an inbox fed by several
+    std::string_view line;  // LINE only; valid until the next co_await on the inbox
+};
+
+class Inbox;
+
+// Deadlines of the inboxes being awaited, fired from the reactor's tick; one per host.
+class InboxTimers {
+public:
+    typedef std::chrono::steady_clock Clock;
+    void Fire(Clock::time_point now); // Resumes, with TIMEOUT, every coroutine whose deadline has passed
+    size_t GetPendingCount() const { return due.size(); }
+
+private:
+    friend class Inbox;
+    std::multimap<Clock::time_point, Inbox*> due;
+};
+
+// The events of one or more connections, in arrival order, for a single coroutine to await:
+//     InboxEvent event = co_await inbox.Next(deadline);
+// A line pushed while the coroutine waits is handed over without a copy; one pushed while it is
+// busy (or not yet waiting) is queued.
+class Inbox {
+public:
+    typedef InboxTimers::Clock Clock;
+    explicit Inbox(InboxTimers& timers) : timers(timers) {}
+    ~Inbox() { CancelTimer(); }
+    Inbox(const Inbox&) = delete;
+    Inbox& operator=(const Inbox&) = delete;
+
+    // Resumes the waiting coroutine, if any, before returning. That coroutine may destroy this
+    // inbox, so the caller must not touch it afterwards.
+    void Push(InboxEvent::Kind kind, int seat, std::string_view line = std::string_view());
+    // Moves what is queued here to the end of 'other', as coming from 'seat'. Resumes nothing: a
+    // coroutine already waiting on 'other' sees them at its next co_await.
+    void MoveTo(Inbox& other, int seat);
+    size_t GetQueuedCount() const { return queued.size(); }
+    bool IsAwaited() const { return static_cast<bool>(waiter); }
+
+    class NextAwaiter {
+    public:
+        NextAwaiter(Inbox& inbox, Clock::time_point deadline) : inbox(inbox), deadline(deadline) {}
+        bool await_ready() const noexcept { return !inbox.queued.empty(); }
+        void await_suspend(std::coroutine_handle<> handle);
+        InboxEvent await_resume();
+    private:
+        Inbox& inbox;
+        Clock::time_point deadline;
+    };
+    // The next event; TIMEOUT if 'deadline' passes first (Clock::time_point::max(): never).
+    NextAwaiter Next(Clock::time_point deadline) { return NextAwaiter(*this, deadline); }
+
+private:
+    struct Queued {
+        InboxEvent::Kind kind;
+        int seat;
+        std::string line;
+    };
+
+    friend class InboxTimers;
+    InboxTimers& timers;
+    std::deque<Queued> queued;
+    std::coroutine_handle<> waiter;
+    InboxEvent delivered; // Handed to the waiter by Push
+    bool hasDelivered = false;
+    std::string current;  // The line of the queued event last returned
+    std::multimap<Clock::time_point, Inbox*>::iterator timer;
+    bool timerSet = false;
+
+    void CancelTimer();
+};
@@ -0,0 +1,528 @@
+// SessionHost.cpp
+#include "SessionHost.h"
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <ctime>
+#include <sys/random.h>
+
+namespace {
+    const char* const COMPUTER_OPPONENT_NAME = "Computer";
+
+    // From the OS's secure random source: a player who knows their own token, and so the state of
+    // any generator that made it, must learn nothing about the other seat's. False if it fails.
+    bool NewResumeTokens(uint64_t (&tokens)[2]) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(tokens);
+        size_t filled = 0;
+        while (filled < sizeof(tokens)) {
+            ssize_t n = getrandom(bytes + filled, sizeof(tokens) - filled, 0);
+            if (n < 0 && errno != EINTR) return false;
+            if (n > 0) filled += static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+// Commands not listed are ignored, as in Form1::ProcessUIMessage.
+SessionHost::Dispatcher SessionHost::MakeDispatcher() {
+    Dispatcher table;
+    table.On(MessageType::CONNECT_REQUEST, &SessionHost::HandleConnectRequest)
+        .On(MessageType::READY, &SessionHost::HandleReady)
+        .On(MessageType::ATTACK, &SessionHost::HandleAttack, 2)
+        .On(MessageType::PROTOCOL, &SessionHost::HandleProtocol, 1)
+        .On(MessageType::RESYNC, &SessionHost::HandleResync)
+        .On(MessageType::DISCONNECT, &SessionHost::HandleDisconnect)
+        .On(MessageType::RATING, &SessionHost::HandleRating, 1)
+        .On(MessageType::SPECTATE, &SessionHost::HandleSpectate)
+        .On(MessageType::RESUME, &SessionHost::HandleResume, 3);
+    return table;
+}
+
+const SessionHost::Dispatcher SessionHost::dispatcher = SessionHost::MakeDispatcher();
+
+SessionHost::SessionHost(Reactor& r, int size, uint64_t seed, bool log) : reactor(r), boardSize(size), seedBase(seed), logGames(log) {
+    reactor.SetHandler(*this);
+}
+
+SessionHost::~SessionHost() = default;
+
+void SessionHost::OnOpen(Connection& conn) {
+    conn.userData = new PlayerState();
+    AddToCounter(stats.connectionsAccepted, 1);
+}
+
+void SessionHost::OnLine(Connection& conn, std::string_view line) {
+    ProtocolMessage message;
+    if (ParseMessage(line, message)) dispatcher.Dispatch(*this, message, conn, StateOf(conn));
+}
+
+void SessionHost::OnClose(Connection& conn) {
+    PlayerState* player = static_cast<PlayerState*>(conn.userData);
+    if (!player) return;
+    if (matchmaker.Cancel(conn.id)) {
+        waitingPlayers.erase(conn.id);
+        stats.waitingPlayers.store(static_cast<int64_t>(matchmaker.GetWaitingCount()), std::memory_order_relaxed);
+    }
+    if (player->spectator) {
+        if (player->watchList) RemoveSpectator(conn);
+        if (player->lagging) laggingSpectators.erase(&conn);
+        stats.spectators.fetch_sub(1, std::memory_order_relaxed);
+    }
+    else if (player->session) EndSession(*player->session, &conn);
+    delete player;
+    conn.userData = nullptr;
+}
+
+void SessionHost::OnTick() {
+    auto now = std::chrono::steady_clock::now();
+    matchmaker.Expire(now, dueMatches);
+    for (const Matchmaker::Match& match : dueMatches) {
+        Connection& first = TakeWaitingPlayer(match.first);
+        if (match.second == Matchmaker::COMPUTER) {
+            AddToCounter(stats.computerMatches, 1);
+            PairPlayers(first, nullptr);
+        }
+        else PairPlayers(first, &TakeWaitingPlayer(match.second));
+    }
+    if (!dueMatches.empty()) stats.waitingPlayers.store(static_cast<int64_t>(matchmaker.GetWaitingCount()), std::memory_order_relaxed);
+    dueMatches.clear();
+    if (!laggingSpectators.empty()) CatchUpSpectators(now);
+    if (store) {
+        ExpireStoredSessions();
+        if (now - lastStoreSync >= storeSyncInterval) {
+            lastStoreSync = now;
+            if (!store->Sync()) std::fprintf(stderr, "battleship-server: session store write failed\n");
+        }
+    }
+    if (!journal || now - lastJournalSync < journalSyncInterval) return;
+    lastJournalSync = now;
+    if (!journal->Sync()) std::fprintf(stderr, "battleship-server: journal write failed\n");
+}
+
+void SessionHost::SetJournal(GameJournalWriter* j, int syncIntervalMs) {
+    journal = j;
+    journalSyncInterval = std::chrono::milliseconds(syncIntervalMs);
+    lastJournalSync = std::chrono::steady_clock::now();
+}
+
+void SessionHost::SetSessionStore(SessionStore* s, int syncIntervalMs) {
+    store = s;
+    storeSyncInterval = std::chrono::milliseconds(syncIntervalMs);
+    lastStoreSync = std::chrono::steady_clock::now();
+    if (!store) return;
+    nextSessionId = std::max(nextSessionId, store->GetNextSessionId()); // Stored sessions keep their ids
+}
+
+void SessionHost::HandleConnectRequest(const ProtocolMessage& message, Connection& conn, PlayerState& player) {
+    if (player.connectRequested) return;
+    player.connectRequested = true;
+    player.name = ToToken(message.GetRest(1));
+    player.queuedTicks = MetricsTicks();
+    Matchmaker::Match match;
+    if (matchmaker.Enqueue(conn.id, player.rating, std::chrono::steady_clock::now(), match)) PairPlayers(TakeWaitingPlayer(match.first), &conn);
+    else waitingPlayers[conn.id] = &conn;
+    stats.waitingPlayers.store(static_cast<int64_t>(matchmaker.GetWaitingCount()), std::memory_order_relaxed);
+}
+
+// Like PROTOCOL, only honoured before CONNECT_REQUEST.
+void SessionHost::HandleRating(const ProtocolMessage& message, Connection&, PlayerState& player) {
+    int rating = 0;
+    if (!player.connectRequested && ParseField(message.fields[1], rating)) player.rating = rating;
+}
+
+Connection& SessionHost::TakeWaitingPlayer(uint64_t id) {
+    auto it = waitingPlayers.find(id);
+    Connection& conn = *it->second;
+    waitingPlayers.erase(it);
+    return conn;
+}
+
+// Instead of CONNECT_REQUEST; a spectator never plays, so it ignores everything a player sends
+// but RESYNC and DISCONNECT. Without a session id it follows this host's games: the newest now,
+// then whichever is paired next after that one ends.
+void SessionHost::HandleSpectate(const ProtocolMessage& message, Connection& conn, PlayerState& player) {
+    if (player.connectRequested) return;
+    player.connectRequested = true;
+    player.spectator = true;
+    stats.spectators.fetch_add(1, std::memory_order_relaxed);
+    unsigned int id = 0;
+    if (message.GetArgCount() >= 1 && !ParseField(message.fields[1], id)) id = 0;
+    player.following = (id == 0);
+    Session* session = nullptr;
+    if (player.following) {
+        for (auto& entry : sessions) if (!session || entry.first > session->id) session = entry.second.get();
+    }
+    else {
+        auto it = sessions.find(id);
+        if (it != sessions.end()) session = it->second.get();
+    }
+    if (session) WatchSession(*session, conn);
+    else if (player.following) AddSpectator(idleFollowers, conn);
+    else {
+        reactor.Send(conn, "DISCONNECT");
+        reactor.Close(conn);
+    }
+}
+
+// Only honoured before CONNECT_REQUEST, so a session never switches protocol mid-game.
+void SessionHost::HandleProtocol(const ProtocolMessage& message, Connection& conn, PlayerState& player) {
+    int version = 0;
+    if (player.connectRequested || !ParseField(message.fields[1], version) || version < PROTOCOL_V2) return;
+    player.protocolVersion = PROTOCOL_V2;
+    reactor.Send(conn, out.Begin(MessageType::PROTOCOL_OK).Add(PROTOCOL_V2).GetText());
+}
+
+void SessionHost::HandleResync(const ProtocolMessage&, Connection& conn, PlayerState& player) {
+    Session* session = player.session;
+    if (!session || !session->started) return;
+    if (player.spectator) SendToSpectator(conn, SpectatorSnapshot(*session));
+    else SendFullState(*session, conn.userSeat);
+}
+
+// Instead of CONNECT_REQUEST, from a player whose connection dropped (the server went down, most
+// likely): puts it back in its seat, bringing the session back from the store first if this run
+// has not seen it yet. Anything else is answered with DISCONNECT, as a host without the game would.
+void SessionHost::HandleResume(const ProtocolMessage& message, Connection& conn, PlayerState& player) {
+    if (player.connectRequested) return;
+    unsigned int slot = 0, generation = 0;
+    uint64_t token = 0;
+    Session* session = nullptr;
+    if (store && ParseField(message.fields[1], slot) && ParseField(message.fields[2], generation) && ParseField(message.fields[3], token)) {
+        auto it = storedSessions.find(slot);
+        if (it == storedSessions.end()) session = RestoreSession(slot, generation, token);
+        else if (store->GetGeneration(slot) == generation) session = it->second;
+    }
+    int seat = -1;
+    for (int i = 0; session && i < 2; ++i) {
+        if (!session->seats[i].conn && session->seats[i].token == token && !(session->vsComputer && i == 1)) seat = i;
+    }
+    if (seat < 0) {
+        reactor.Send(conn, "DISCONNECT");
+        reactor.Close(conn);
+        return;
+    }
+    player.connectRequested = true;
+    player.name = session->seats[seat].name;
+    player.ready = true;
+    player.session = session;
+    conn.userSeat = seat;
+    session->seats[seat].conn = &conn;
+    AddToCounter(stats.playersResumed, 1);
+    reactor.Send(conn, out.Begin(MessageType::WELCOME).Add(session->seats[1 - seat].name).Add(session->seats[seat].name).Add(2).GetText());
+    SendFullState(*session, seat);
+    PlayComputerMoves(*session); // The server may have gone down between a move and the computer's answer
+}
+
+// A session of an earlier run, as its store slot holds it, with both seats empty; null if the slot
+// does not hold that generation's game or 'token' is neither seat's.
+SessionHost::Session* SessionHost::RestoreSession(uint32_t slot, uint32_t generation, uint64_t token) {
+    SessionStore::StoredSession stored;
+    if (!store->Load(slot, stored) || stored.generation != generation || (stored.tokens[0] != token && stored.tokens[1] != token)
+        || sessions.count(stored.sessionId)) return nullptr;
+    auto session = std::make_unique<Session>(boardSize);
+    if (!session->game.RestoreSnapshot(stored.snapshot, stored.names[0], stored.names[1]) || session->game.IsGameOver()) return nullptr; // E.g. another --board-size
+    session->id = stored.sessionId;
+    session->vsComputer = (stored.flags & SessionStore::VS_COMPUTER) != 0;
+    for (int i = 0; i < 2; ++i) {
+        session->seats[i].name = stored.names[i];
+        session->seats[i].ready = true;
+        session->seats[i].token = stored.tokens[i];
+    }
+    session->started = true;
+    session->seq = stored.seq;
+    session->storeSlot = slot;
+    Session& ref = *session;
+    storedSessions[slot] = &ref;
+    sessions[ref.id] = std::move(session);
+    stats.activeSessions.fetch_add(1, std::memory_order_relaxed);
+    AddToCounter(stats.sessionsRestored, 1);
+    return &ref;
+}
+
+// Gives a starting game a slot and tells each player how to RESUME it. A full store (or no random
+// bytes for the tokens) only means the game is not kept.
+void SessionHost::StoreGame(Session& session) {
+    std::string names[2] = { session.seats[0].name, session.seats[1].name };
+    uint64_t tokens[2];
+    if (!NewResumeTokens(tokens)) return;
+    for (int i = 0; i < 2; ++i) session.seats[i].token = tokens[i];
+    uint32_t slot = store->Allocate(session.id, names, tokens, session.vsComputer ? SessionStore::VS_COMPUTER : 0);
+    if (slot == SessionStore::NO_SLOT) return;
+    GameSnapshot snapshot;
+    session.game.SaveSnapshot(snapshot);
+    store->Write(slot, snapshot, session.seq);
+    session.storeSlot = slot;
+    storedSessions[slot] = &session;
+    for (Seat& seat : session.seats) {
+        if (seat.conn) reactor.Send(*seat.conn, out.Begin(MessageType::SESSION).Add(slot).Add(store->GetGeneration(slot)).Add(seat.token).GetText());
+    }
+}
+
+void SessionHost::ReleaseStoredGame(Session& session) {
+    if (session.storeSlot == SessionStore::NO_SLOT) return;
+    store->Release(session.storeSlot);
+    storedSessions.erase(session.storeSlot);
+    session.storeSlot = SessionStore::NO_SLOT;
+}
+
+// Releases the stored sessions of earlier runs that nobody resumed in time, and ends restored ones
+// whose other player has not come back either, STORE_SWEEP_SLOTS slots per tick, so that a store of
+// any size costs nothing at startup and little after it.
+void SessionHost::ExpireStoredSessions() {
+    uint32_t used = store->GetUsedSlotCount();
+    int64_t cutoff = static_cast<int64_t>(std::time(nullptr)) - STORED_SESSION_TIMEOUT.count();
+    for (uint32_t i = 0; i < std::min(used, STORE_SWEEP_SLOTS); ++i) {
+        if (sweepSlot >= used) sweepSlot = 0;
+        uint32_t slot = sweepSlot++;
+        if (!store->IsLive(slot) || store->GetUpdatedAt(slot) >= cutoff) continue;
+        auto it = storedSessions.find(slot);
+        if (it == storedSessions.end()) store->Release(slot);
+        else {
+            Session& session = *it->second;
+            if (session.seats[0].conn && (session.vsComputer || session.seats[1].conn)) continue; // Both players are here
+            EndSession(session, nullptr);
+        }
+        AddToCounter(stats.storedSessionsExpired, 1);
+    }
+}
+
+void SessionHost::HandleDisconnect(const ProtocolMessage&, Connection& conn, PlayerState&) {
+    reactor.Close(conn);
+}
+
+void SessionHost::PairPlayers(Connection& first, Connection* second) {
+    auto session = std::make_unique<Session>(boardSize);
+    session->id = nextSessionId++;
+    session->vsComputer = !second;
+    Connection* pair[2] = { &first, second };
+    uint64_t now = MetricsTicks();
+    for (int i = 0; i < 2; ++i) {
+        if (!pair[i]) {
+            session->seats[i].name = COMPUTER_OPPONENT_NAME;
+            session->seats[i].ready = true;
+            continue;
+        }
+        PlayerState& player = StateOf(*pair[i]);
+        stats.pairingLatency.Record(now - player.queuedTicks);
+        player.session = session.get();
+        pair[i]->userSeat = i;
+        session->seats[i].conn = pair[i];
+        session->seats[i].name = player.name;
+        session->seats[i].ready = player.ready; // READY may arrive before an opponent does
+    }
+    // WELCOME <host name> <your name> <your player id>; the client is always player 2 on the wire.
+    for (int i = 0; i < 2; ++i) {
+        if (pair[i]) reactor.Send(*pair[i], out.Begin(MessageType::WELCOME).Add(session->seats[1 - i].name).Add(session->seats[i].name).Add(2).GetText());
+    }
+    Session& ref = *session;
+    sessions[session->id] = std::move(session);
+    stats.activeSessions.fetch_add(1, std::memory_order_relaxed);
+    while (!idleFollowers.empty()) {
+        Connection& viewer = *idleFollowers.back();
+        RemoveSpectator(viewer);
+        WatchSession(ref, viewer);
+    }
+    if (ref.seats[0].ready && ref.seats[1].ready) StartGame(ref);
+}
+
+void SessionHost::HandleReady(const ProtocolMessage&, Connection& conn, PlayerState& player) {
+    if (player.spectator) return;
+    player.ready = true;
+    Session* session = player.session;
+    if (!session) return; // Remembered until paired
+    session->seats[conn.userSeat].ready = true;
+    if (!session->started && session->seats[0].ready && session->seats[1].ready) StartGame(*session);
+}
+
+void SessionHost::StartGame(Session& session) {
+    GameMode mode = session.vsComputer ? GameMode::PLAYER_VS_COMPUTER : GameMode::PLAYER_VS_PLAYER;
+    session.game.StartNewGame(session.seats[0].name, session.seats[1].name, mode, mixSeed(seedBase, session.id));
+    if (logGames) {
+        std::printf("session %llu: %s vs %s, seed %016llx\n", static_cast<unsigned long long>(session.id),
+            session.seats[0].name.c_str(), session.seats[1].name.c_str(), static_cast<unsigned long long>(session.game.GetSeed()));
+    }
+    if (journal) journal->AppendGameStart(session.id, session.game);
+    session.started = true;
+    AddToCounter(stats.gamesStarted, 1);
+    session.seq = 0;
+    if (store) StoreGame(session);
+    SendGameUpdates(session, false);
+}
+
+void SessionHost::HandleAttack(const ProtocolMessage& message, Connection& conn, PlayerState& player) {
+    Session* session = player.session;
+    if (!session || player.spectator || !session->started || session->game.IsGameOver()) return;
+    GameTurn expected = (conn.userSeat == 0) ? GameTurn::PLAYER1 : GameTurn::PLAYER2;
+    if (session->game.GetCurrentTurnState() != expected) return; // Out-of-turn shots are ignored
+    int r = 0, c = 0;
+    if (!ParseField(message.fields[1], r) || !ParseField(message.fields[2], c)) return;
+
+    AttackEvent event;
+    {
+        ScopedLatency timing(stats.attackLatency);
+        event = session->game.MakeAttack(r, c);
+    }
+    RecordMove(*session, event);
+    SendGameUpdates(*session, event.isAccepted()); // Also answers rejected moves, so the client re-enables its grid
+    PlayComputerMoves(*session);
+}
+
+void SessionHost::PlayComputerMoves(Session& session) {
+    while (!session.game.IsGameOver() && session.game.IsComputerTurn()) { // The computer answers at once
+        AttackEvent event = session.game.MakeComputerMove();
+        if (!event.isAccepted()) break;
+        RecordMove(session, event);
+        SendGameUpdates(session, true);
+    }
+}
+
+void SessionHost::RecordMove(Session& session, const AttackEvent& event) {
+    if (event.isAccepted()) AddToCounter(stats.movesPlayed, 1);
+    if (journal) journal->AppendMove(session.id, event);
+    if (session.game.IsGameOver()) {
+        AddToCounter(stats.gamesFinished, 1);
+        if (journal) journal->AppendGameEnd(session.id, true);
+        ReleaseStoredGame(session);
+    }
+    else if (session.storeSlot != SessionStore::NO_SLOT && event.isAccepted()) {
+        GameSnapshot snapshot;
+        session.game.SaveSnapshot(snapshot);
+        store->Write(session.storeSlot, snapshot, session.seq + 1); // The GAME_DELTA SendGameUpdates numbers next
+    }
+}
+
+// v1 seats get a full GAME_UPDATE after every change. v2 seats get a GAME_DELTA for an accepted
+// move and a GAME_SNAPSHOT otherwise (game start, rejected move).
+void SessionHost::SendGameUpdates(Session& session, bool moveAccepted) {
+    if (moveAccepted) ++session.seq;
+    for (int seat = 0; seat < 2; ++seat) {
+        Connection* conn = session.seats[seat].conn;
+        if (!conn) continue;
+        BuildSeatUpdate(out, session.game, session.seq, seat, StateOf(*conn).protocolVersion, moveAccepted, views);
+        reactor.Send(*conn, out.GetText());
+    }
+    session.spectatorSnapshot = SharedBuffer();
+    if (session.spectators.empty()) return;
+    SharedBuffer line; // Encoded once for every spectator
+    if (moveAccepted) {
+        BuildGameDelta(out, MakeGameDelta(session.game.GetLastAttack(), session.seq, 2));
+        line = SharedBuffer::MakeLine(out.GetText());
+    }
+    else line = SpectatorSnapshot(session);
+    for (Connection* conn : session.spectators) SendToSpectator(*conn, line);
+}
+
+// The game from one seat's view: GAME_UPDATE for v1, GAME_SNAPSHOT for v2.
+void SessionHost::SendFullState(Session& session, int seat) {
+    Connection* conn = session.seats[seat].conn;
+    if (!conn) return;
+    BuildSeatState(out, session.game, session.seq, seat, StateOf(*conn).protocolVersion, views);
+    reactor.Send(*conn, out.GetText());
+}
+
+// The GAME_SNAPSHOT every spectator of 'session' is sent: player 2's view with both fleets hidden.
+const SharedBuffer& SessionHost::SpectatorSnapshot(Session& session) {
+    if (!session.spectatorSnapshot.IsEmpty()) return session.spectatorSnapshot;
+    BuildSpectatorState(out, session.game, session.seq, views);
+    session.spectatorSnapshot = SharedBuffer::MakeLine(out.GetText());
+    return session.spectatorSnapshot;
+}
+
+void SessionHost::SendToSpectator(Connection& conn, const SharedBuffer& line) {
+    PlayerState& viewer = StateOf(conn);
+    if (!viewer.lagging && reactor.GetQueuedBytes(conn) > SPECTATOR_QUEUE_LIMIT) {
+        viewer.lagging = true;
+        viewer.laggingSince = std::chrono::steady_clock::now();
+        laggingSpectators.insert(&conn);
+    }
+    if (viewer.lagging) AddToCounter(stats.spectatorMessagesSkipped, 1);
+    else reactor.SendShared(conn, line);
+}
+
+// A lagging spectator whose queue has drained to half the limit is sent the current snapshot in
+// place of everything it skipped; one that has not drained within SPECTATOR_LAG_TIMEOUT is closed.
+void SessionHost::CatchUpSpectators(std::chrono::steady_clock::time_point now) {
+    std::vector<Connection*> dropped;
+    for (auto it = laggingSpectators.begin(); it != laggingSpectators.end();) {
+        Connection& conn = **it;
+        PlayerState& viewer = StateOf(conn);
+        if (reactor.GetQueuedBytes(conn) <= SPECTATOR_QUEUE_LIMIT / 2) {
+            viewer.lagging = false;
+            it = laggingSpectators.erase(it);
+            if (viewer.session) { // Else a follower between games, which gets the next one whole
+                AddToCounter(stats.spectatorCatchUps, 1);
+                SendWatchStart(*viewer.session, conn);
+            }
+            continue;
+        }
+        if (now - viewer.laggingSince >= SPECTATOR_LAG_TIMEOUT) dropped.push_back(&conn);
+        ++it;
+    }
+    for (Connection* conn : dropped) { // OnClose takes them out of laggingSpectators
+        AddToCounter(stats.spectatorsDropped, 1);
+        reactor.Close(*conn);
+    }
+}
+
+void SessionHost::WatchSession(Session& session, Connection& conn) {
+    PlayerState& viewer = StateOf(conn);
+    viewer.session = &session;
+    AddSpectator(session.spectators, conn);
+    if (!viewer.lagging) SendWatchStart(session, conn); // Else CatchUpSpectators sends it
+}
+
+// WELCOME <player 1> <player 2> 0 (a spectator has no player id), then the game so far.
+void SessionHost::SendWatchStart(Session& session, Connection& conn) {
+    reactor.Send(conn, out.Begin(MessageType::WELCOME).Add(session.seats[0].name).Add(session.seats[1].name).Add(0).GetText());
+    if (session.started) reactor.SendShared(conn, SpectatorSnapshot(session));
+}
+
+void SessionHost::AddSpectator(std::vector<Connection*>& list, Connection& conn) {
+    PlayerState& viewer = StateOf(conn);
+    viewer.watchList = &list;
+    viewer.watchIndex = list.size();
+    list.push_back(&conn);
+}
+
+// Out of its list in O(1), by moving the last one into its place.
+void SessionHost::RemoveSpectator(Connection& conn) {
+    PlayerState& viewer = StateOf(conn);
+    std::vector<Connection*>& list = *viewer.watchList;
+    Connection* last = list.back();
+    list[viewer.watchIndex] = last;
+    StateOf(*last).watchIndex = viewer.watchIndex;
+    list.pop_back();
+    viewer.watchList = nullptr;
+    viewer.session = nullptr;
+}
+
+void SessionHost::EndSession(Session& session, Connection* leaving) {
+    bool stopping = !reactor.IsRunning();
+    if (!stopping) ReleaseStoredGame(session);
+    else storedSessions.erase(session.storeSlot); // The game stays stored for the server's next run
+    for (Seat& seat : session.seats) {
+        if (!seat.conn) continue;
+        StateOf(*seat.conn).session = nullptr;
+        if (seat.conn != leaving) {
+            // The remaining client resets, as after a host disconnect; or learns it may RESUME later.
+            reactor.Send(*seat.conn, stopping ? MessageTypeName(MessageType::SERVER_SHUTDOWN) : "DISCONNECT");
+            reactor.Close(*seat.conn);
+        }
+        seat.conn = nullptr;
+    }
+    SharedBuffer disconnect;
+    while (!session.spectators.empty()) {
+        Connection& viewer = *session.spectators.back();
+        RemoveSpectator(viewer);
+        if (StateOf(viewer).following) { AddSpectator(idleFollowers, viewer); continue; }
+        if (disconnect.IsEmpty()) disconnect = SharedBuffer::MakeLine("DISCONNECT");
+        reactor.SendShared(viewer, disconnect);
+        reactor.Close(viewer);
+    }
+    if (session.started && !session.game.IsGameOver()) {
+        AddToCounter(stats.gamesFinished, 1);
+        if (journal) journal->AppendGameEnd(session.id, false);
+    }
+    stats.activeSessions.fetch_sub(1, std::memory_order_relaxed);
+    sessions.erase(session.id);
+}
@@ -0,0 +1,174 @@
+// SessionHost.h
+#pragma once
+#include "Reactor.h"
+#include "GameJournal.h"
+#include "GameSession.h"
+#include "GameUpdates.h"
+#include "Matchmaker.h"
+#include "Protocol.h"
+#include "SessionStore.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Counters owned by one reactor thread; other threads only read them (relaxed) for reporting.
+struct SessionHostStats {
+    LatencyHistogram attackLatency; // MakeAttack, accepted or not
+    LatencyHistogram pairingLatency; // CONNECT_REQUEST to WELCOME; every pairing, not sampled
+    std::atomic<uint64_t> connectionsAccepted{ 0 };
+    std::atomic<uint64_t> gamesStarted{ 0 };
+    std::atomic<uint64_t> gamesFinished{ 0 };
+    std::atomic<uint64_t> movesPlayed{ 0 };
+    std::atomic<int64_t> activeSessions{ 0 };
+    std::atomic<int64_t> waitingPlayers{ 0 };   // Queued in the matchmaker
+    std::atomic<uint64_t> computerMatches{ 0 }; // Players who waited too long and got a computer opponent
+    std::atomic<int64_t> spectators{ 0 };
+    std::atomic<uint64_t> spectatorMessagesSkipped{ 0 }; // Not sent to a lagging spectator
+    std::atomic<uint64_t> spectatorCatchUps{ 0 };        // Snapshots sent to a lagging spectator instead
+    std::atomic<uint64_t> spectatorsDropped{ 0 };        // Lagged for longer than SPECTATOR_LAG_TIMEOUT
+    std::atomic<uint64_t> sessionsRestored{ 0 };  // Brought back from the session store by a RESUME
+    std::atomic<uint64_t> playersResumed{ 0 };    // RESUMEs honoured
+    std::atomic<uint64_t> storedSessionsExpired{ 0 }; // Left in the store by an earlier run and never resumed
+};
+
+// Hosts many BattleshipGameLogic sessions on one Reactor, speaking the same line protocol as the
+// WinForms host (CONNECT_REQUEST / WELCOME / READY / ATTACK / GAME_UPDATE / DISCONNECT).
+// Every remote client is shown the game the way Form1 shows it to its joining client: the client
+// is always "player 2", and GAME_UPDATE carries the opponent's board first and its own board second.
+// Clients that negotiate PROTOCOL 2 get GAME_SNAPSHOT / GAME_DELTA instead (see Protocol.h).
+// Players are paired by a Matchmaker (by RATING bucket when configured); one who waits too long
+// can be given a computer opponent, which plays logic player 2 on this host.
+// Any number of spectators can watch a session (SPECTATE, see Protocol.h). Each change is encoded
+// once for all of them into a SharedBuffer that every spectator's connection queues, so an added
+// spectator costs a write, not an encode. A spectator whose connection has more than
+// SPECTATOR_QUEUE_LIMIT bytes queued is skipped rather than buffered for: once it has drained, OnTick
+// sends it the game afresh (so a slow spectator sees the game at most once a tick), and it is
+// closed if it stays behind for SPECTATOR_LAG_TIMEOUT. Players never wait on spectators.
+// With a SessionStore every started game is written to it after each move and released when it
+// ends, so when the server is restarted after dying (or being stopped) its players can RESUME.
+// Nothing is read from the store at startup: a session comes back when its first player does, and
+// OnTick walks a few slots per tick to release those nobody came back for.
+class SessionHost : public ReactorHandler {
+public:
+    // Game k of this host is seeded with mixSeed(seedBase, session id); with 'logGames' every
+    // game's seed is printed when it starts, so any game can be replayed from the log.
+    SessionHost(Reactor& reactor, int boardSize, uint64_t seedBase, bool logGames = false);
+    ~SessionHost() override;
+
+    void OnOpen(Connection& conn) override;
+    void OnLine(Connection& conn, std::string_view line) override;
+    void OnClose(Connection& conn) override;
+    void OnTick() override;
+
+    // Records every game of this host in 'journal' (null to stop), syncing it to disk at most
+    // every 'syncIntervalMs' from OnTick. The journal must outlive the host's use of it.
+    void SetJournal(GameJournalWriter* journal, int syncIntervalMs);
+    // Keeps every game of this host in 'store' (null to stop), so that they survive a restart,
+    // syncing it to disk at most every 'syncIntervalMs' from OnTick; before the reactor runs. The
+    // store must outlive the host's use of it.
+    void SetSessionStore(SessionStore* store, int syncIntervalMs);
+    // How players are paired; before the reactor runs. The default pairs them in arrival order.
+    void SetMatchmaking(const MatchmakerOptions& options) { matchmaker = Matchmaker(options); }
+    const SessionHostStats& GetStats() const { return stats; }
+
+    static const size_t SPECTATOR_QUEUE_LIMIT = 64 * 1024;
+    static constexpr std::chrono::seconds SPECTATOR_LAG_TIMEOUT{ 10 };
+    static constexpr std::chrono::seconds STORED_SESSION_TIMEOUT{ 300 }; // A stored game nobody resumes is released after this
+    static constexpr uint32_t STORE_SWEEP_SLOTS = 64; // Stored sessions OnTick looks at for expiry per tick
+
+private:
+    struct Seat {
+        Connection* conn = nullptr;
+        std::string name;
+        bool ready = false;
+        uint64_t token = 0; // To RESUME this seat; with a session store only
+    };
+    struct Session {
+        explicit Session(int boardSize) : game(boardSize) {}
+        uint64_t id = 0;
+        GameSession game;
+        Seat seats[2]; // seats[0] is logic player 1, seats[1] is logic player 2
+        bool started = false;
+        bool vsComputer = false; // seats[1] is the computer and has no connection
+        unsigned int seq = 0; // Last GAME_DELTA sequence number
+        std::vector<Connection*> spectators;
+        SharedBuffer spectatorSnapshot; // Built when first needed after each change; see SpectatorSnapshot
+        uint32_t storeSlot = SessionStore::NO_SLOT;
+    };
+    struct PlayerState { // Connection::userData
+        std::string name;
+        bool ready = false;
+        bool connectRequested = false;
+        int protocolVersion = PROTOCOL_V1;
+        int rating = DEFAULT_RATING;
+        uint64_t queuedTicks = 0; // MetricsTicks() at CONNECT_REQUEST
+        Session* session = nullptr;
+        bool spectator = false;
+        bool following = false; // Spectator that moves on to the next game when this one ends
+        std::vector<Connection*>* watchList = nullptr; // Session::spectators or idleFollowers
+        size_t watchIndex = 0;
+        bool lagging = false; // Spectator skipping updates until its queue drains
+        std::chrono::steady_clock::time_point laggingSince;
+    };
+
+    Reactor& reactor;
+    int boardSize;
+    uint64_t seedBase;
+    bool logGames;
+    uint64_t nextSessionId = 1;
+    Matchmaker matchmaker;
+    std::unordered_map<uint64_t, Connection*> waitingPlayers; // Connected, named, and not yet paired; by Connection::id
+    std::vector<Matchmaker::Match> dueMatches;
+    std::unordered_map<uint64_t, std::unique_ptr<Session>> sessions;
+    std::vector<Connection*> idleFollowers; // Following spectators waiting for the next game
+    std::unordered_set<Connection*> laggingSpectators;
+    SessionHostStats stats;
+    GameJournalWriter* journal = nullptr; // Game ids in the journal are session ids
+    std::chrono::milliseconds journalSyncInterval{ 0 };
+    std::chrono::steady_clock::time_point lastJournalSync;
+    SessionStore* store = nullptr;
+    std::chrono::milliseconds storeSyncInterval{ 0 };
+    std::chrono::steady_clock::time_point lastStoreSync;
+    std::unordered_map<uint32_t, Session*> storedSessions; // Sessions of this run in the store, by slot
+    uint32_t sweepSlot = 0; // Where OnTick's walk over the store goes on from
+
+    MessageBuilder out; // Every message this host sends is built here
+    GameViewBoards views;
+
+    typedef MessageDispatcher<SessionHost, Connection&, PlayerState&> Dispatcher;
+    static const Dispatcher dispatcher;
+    static Dispatcher MakeDispatcher();
+    void HandleConnectRequest(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleReady(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleAttack(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleProtocol(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleResync(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleDisconnect(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleRating(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleSpectate(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    void HandleResume(const ProtocolMessage& message, Connection& conn, PlayerState& player);
+    Session* RestoreSession(uint32_t slot, uint32_t generation, uint64_t token);
+    void StoreGame(Session& session);
+    void ReleaseStoredGame(Session& session);
+    void ExpireStoredSessions();
+    Connection& TakeWaitingPlayer(uint64_t id);
+    void PairPlayers(Connection& first, Connection* second); // Null 'second': a computer opponent
+    void StartGame(Session& session);
+    void RecordMove(Session& session, const AttackEvent& event);
+    void PlayComputerMoves(Session& session);
+    void SendGameUpdates(Session& session, bool moveAccepted);
+    void SendFullState(Session& session, int seat);
+    const SharedBuffer& SpectatorSnapshot(Session& session);
+    void SendToSpectator(Connection& conn, const SharedBuffer& line);
+    void CatchUpSpectators(std::chrono::steady_clock::time_point now);
+    void WatchSession(Session& session, Connection& conn);
+    void SendWatchStart(Session& session, Connection& conn);
+    void AddSpectator(std::vector<Connection*>& list, Connection& conn);
+    void RemoveSpectator(Connection& conn);
+    void EndSession(Session& session, Connection* leaving);
+    static PlayerState& StateOf(Connection& conn) { return *static_cast<PlayerState*>(conn.userData); }
+};
@@ -0,0 +1,330 @@
+// SessionStore.cpp
+#include "SessionStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char STORE_MAGIC[4] = { 'B', 'S', 'S', 0 };
+    const uint32_t STORE_VERSION = 2; // 2: 64-bit resume tokens
+    const size_t HEADER_BYTES = 4096; // A page, so slots never share one with the header
+    const size_t SLOT_BYTES = 1024;
+
+    const uint32_t SLOT_FREE = 0;
+    const uint32_t SLOT_LIVE = 1;
+
+    const uint32_t OP_NONE = 0;
+    const uint32_t OP_ALLOCATE = 1;
+    const uint32_t OP_RELEASE = 2;
+
+    // FNV-1a, 32 bits: catches a copy cut short, not tampering.
+    uint32_t Checksum(uint32_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 16777619u;
+        return hash;
+    }
+
+    std::string SystemError(const std::string& what, const std::string& path) {
+        return what + " " + path + ": " + std::strerror(errno);
+    }
+}
+
+// The header fields Allocate and Release change, saved in 'pending' before they change them.
+struct SessionStore::Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t slotBytes;
+    uint32_t slotCount;
+    uint32_t freeHead;  // First slot of the free list, or NO_SLOT
+    uint32_t usedSlots; // Slots from here on have never been allocated and are free too
+    uint32_t liveCount;
+    uint32_t reserved;
+    uint64_t nextSessionId;
+    struct {
+        uint32_t op; // OP_NONE, or the operation in progress on 'slot'
+        uint32_t slot;
+        uint32_t freeHead;
+        uint32_t usedSlots;
+        uint32_t liveCount;
+        uint32_t reserved;
+        uint64_t nextSessionId;
+    } pending;
+};
+
+struct SessionStore::Copy {
+    uint32_t writeCount; // Larger is newer
+    uint32_t seq;
+    uint16_t size;
+    uint16_t reserved;
+    uint32_t checksum;   // Of the slot's generation, the fields above and bytes[0, size)
+    int64_t updatedAt;
+    uint8_t bytes[GameSnapshot::MAX_BYTES];
+};
+
+struct SessionStore::Slot {
+    uint32_t state;
+    uint32_t generation; // Counts allocations, so a resume token never outlives its session
+    uint64_t sessionId;
+    uint32_t nextFree;   // Free list link while free
+    uint32_t flags;
+    uint64_t tokens[2];
+    char names[2][MAX_NAME_BYTES + 1];
+    Copy copies[2];
+};
+
+SessionStore::~SessionStore() {
+    Close();
+}
+
+bool SessionStore::Open(const std::string& path, uint32_t slotCount, std::string& error) {
+    static_assert(sizeof(Header) <= HEADER_BYTES && sizeof(Slot) <= SLOT_BYTES, "store layout");
+    Close();
+    if (slotCount == 0) { error = "a session store needs at least one slot"; return false; }
+    fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0 && errno == ENOENT) {
+        // Built under another name and renamed, so a crash never leaves a half-made store.
+        std::string temporary = path + ".tmp";
+        int newFd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (newFd < 0) { error = SystemError("cannot create session store", temporary); return false; }
+        Header initial;
+        std::memset(&initial, 0, sizeof(initial));
+        std::memcpy(initial.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+        initial.version = STORE_VERSION;
+        initial.slotBytes = SLOT_BYTES;
+        initial.slotCount = slotCount;
+        initial.freeHead = NO_SLOT;
+        initial.nextSessionId = 1;
+        bool made = ::ftruncate(newFd, static_cast<off_t>(HEADER_BYTES + static_cast<size_t>(slotCount) * SLOT_BYTES)) == 0
+            && ::pwrite(newFd, &initial, sizeof(initial), 0) == static_cast<ssize_t>(sizeof(initial)) && ::fsync(newFd) == 0;
+        ::close(newFd);
+        if (!made || std::rename(temporary.c_str(), path.c_str()) != 0) { error = SystemError("cannot create session store", path); return false; }
+        fd = ::open(path.c_str(), O_RDWR);
+    }
+    if (fd < 0) { error = SystemError("cannot open session store", path); return false; }
+
+    Header existing;
+    if (::pread(fd, &existing, sizeof(existing), 0) != static_cast<ssize_t>(sizeof(existing))
+        || std::memcmp(existing.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 || existing.version != STORE_VERSION
+        || existing.slotBytes != SLOT_BYTES || existing.slotCount == 0) {
+        error = path + " is not a session store of this version";
+        Close();
+        return false;
+    }
+    uint32_t count = std::max(existing.slotCount, slotCount);
+    size_t bytes = HEADER_BYTES + static_cast<size_t>(count) * SLOT_BYTES;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < bytes && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0)) {
+        error = SystemError("cannot size session store", path);
+        Close();
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        error = SystemError("cannot map session store", path);
+        Close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapped);
+    mappedBytes = bytes;
+    header = reinterpret_cast<Header*>(base);
+    recovered = header->pending.op != OP_NONE;
+    if (recovered) UndoPendingOperation();
+    header->slotCount = count; // Grown: the new slots lie past usedSlots, so they are free already
+    return true;
+}
+
+void SessionStore::Close() {
+    if (base) {
+        ::msync(base, mappedBytes, MS_SYNC);
+        ::munmap(base, mappedBytes);
+    }
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    base = nullptr;
+    mappedBytes = 0;
+    header = nullptr;
+}
+
+SessionStore::Slot& SessionStore::SlotAt(uint32_t slot) const {
+    return *reinterpret_cast<Slot*>(base + HEADER_BYTES + static_cast<size_t>(slot) * SLOT_BYTES);
+}
+
+// Keeps the compiler from moving stores to the mapping across this point; the CPU already makes
+// them visible in program order to anything that reads the file after this process is gone.
+void SessionStore::Step() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (stepHook) stepHook();
+}
+
+void SessionStore::BeginOperation(uint32_t op, uint32_t slot) {
+    header->pending.slot = slot;
+    header->pending.freeHead = header->freeHead;
+    header->pending.usedSlots = header->usedSlots;
+    header->pending.liveCount = header->liveCount;
+    header->pending.nextSessionId = header->nextSessionId;
+    Step();
+    header->pending.op = op;
+    Step();
+}
+
+void SessionStore::EndOperation() {
+    Step();
+    header->pending.op = OP_NONE;
+    Step();
+}
+
+// Puts back the header fields and the slot's state; nothing else of the slot matters to the undo:
+// an allocated slot's other fields are rewritten by the next Allocate, and a released one's
+// nextFree is only read while it is free.
+void SessionStore::UndoPendingOperation() {
+    uint32_t slot = header->pending.slot;
+    header->freeHead = header->pending.freeHead;
+    header->usedSlots = header->pending.usedSlots;
+    header->liveCount = header->pending.liveCount;
+    header->nextSessionId = header->pending.nextSessionId;
+    if (slot < header->slotCount) SlotAt(slot).state = header->pending.op == OP_ALLOCATE ? SLOT_FREE : SLOT_LIVE;
+    Step();
+    header->pending.op = OP_NONE;
+    Step();
+}
+
+uint32_t SessionStore::Allocate(uint64_t sessionId, const std::string names[2], const uint64_t tokens[2], uint32_t flags) {
+    uint32_t index = header->freeHead;
+    if (index == NO_SLOT) {
+        if (header->usedSlots >= header->slotCount) return NO_SLOT;
+        index = header->usedSlots;
+    }
+    Slot& slot = SlotAt(index);
+    BeginOperation(OP_ALLOCATE, index);
+    if (index == header->freeHead) header->freeHead = slot.nextFree;
+    else header->usedSlots = index + 1;
+    Step();
+    slot.generation++;
+    slot.sessionId = sessionId;
+    slot.flags = flags;
+    for (int seat = 0; seat < 2; ++seat) {
+        slot.tokens[seat] = tokens[seat];
+        size_t length = std::min(names[seat].size(), MAX_NAME_BYTES);
+        std::memcpy(slot.names[seat], names[seat].data(), length);
+        slot.names[seat][length] = '\0';
+    }
+    for (Copy& copy : slot.copies) copy.writeCount = 0; // The last session's copies no longer check out anyway: the generation moved on
+    slot.state = SLOT_LIVE;
+    header->liveCount++;
+    header->nextSessionId = std::max(header->nextSessionId, sessionId + 1);
+    EndOperation();
+    return index;
+}
+
+int SessionStore::NewestValidCopy(const Slot& slot) const {
+    int newest = -1;
+    for (int i = 0; i < 2; ++i) {
+        const Copy& copy = slot.copies[i];
+        if (copy.writeCount == 0 || copy.size > GameSnapshot::MAX_BYTES) continue;
+        uint32_t hash = Checksum(2166136261u, &slot.generation, sizeof(slot.generation));
+        hash = Checksum(hash, &copy, offsetof(Copy, checksum));
+        hash = Checksum(hash, &copy.updatedAt, sizeof(copy.updatedAt));
+        if (Checksum(hash, copy.bytes, copy.size) != copy.checksum) continue;
+        if (newest < 0 || copy.writeCount > slot.copies[newest].writeCount) newest = i;
+    }
+    return newest;
+}
+
+bool SessionStore::Write(uint32_t index, const GameSnapshot& snapshot, unsigned int seq) {
+    if (!IsLive(index) || snapshot.size > GameSnapshot::MAX_BYTES) return false;
+    Slot& slot = SlotAt(index);
+    int newest = NewestValidCopy(slot);
+    Copy& copy = slot.copies[newest == 0 ? 1 : 0];
+    copy.checksum = ~copy.checksum; // Invalid from the first byte written on
+    Step();
+    std::memcpy(copy.bytes, snapshot.bytes, snapshot.size);
+    copy.size = static_cast<uint16_t>(snapshot.size);
+    copy.seq = seq;
+    copy.updatedAt = static_cast<int64_t>(std::time(nullptr));
+    copy.writeCount = newest < 0 ? 1 : slot.copies[newest].writeCount + 1;
+    uint32_t hash = Checksum(2166136261u, &slot.generation, sizeof(slot.generation));
+    hash = Checksum(hash, &copy, offsetof(Copy, checksum));
+    hash = Checksum(hash, &copy.updatedAt, sizeof(copy.updatedAt));
+    Step();
+    copy.checksum = Checksum(hash, copy.bytes, copy.size);
+    Step();
+    return true;
+}
+
+void SessionStore::Release(uint32_t index) {
+    if (!IsLive(index)) return;
+    Slot& slot = SlotAt(index);
+    BeginOperation(OP_RELEASE, index);
+    slot.state = SLOT_FREE;
+    slot.nextFree = header->freeHead;
+    Step();
+    header->freeHead = index;
+    header->liveCount--;
+    EndOperation();
+}
+
+bool SessionStore::Load(uint32_t index, StoredSession& out) const {
+    if (!IsLive(index)) return false;
+    const Slot& slot = SlotAt(index);
+    int newest = NewestValidCopy(slot);
+    if (newest < 0) return false;
+    const Copy& copy = slot.copies[newest];
+    out.sessionId = slot.sessionId;
+    out.generation = slot.generation;
+    out.flags = slot.flags;
+    for (int seat = 0; seat < 2; ++seat) {
+        out.tokens[seat] = slot.tokens[seat];
+        out.names[seat].assign(slot.names[seat], strnlen(slot.names[seat], MAX_NAME_BYTES));
+    }
+    out.seq = copy.seq;
+    out.updatedAt = copy.updatedAt;
+    return out.snapshot.assign(copy.bytes, copy.size);
+}
+
+bool SessionStore::IsLive(uint32_t index) const {
+    return header && index < header->usedSlots && SlotAt(index).state == SLOT_LIVE;
+}
+
+uint32_t SessionStore::GetGeneration(uint32_t index) const {
+    return index < header->usedSlots ? SlotAt(index).generation : 0;
+}
+
+int64_t SessionStore::GetUpdatedAt(uint32_t index) const {
+    if (!IsLive(index)) return 0;
+    const Slot& slot = SlotAt(index);
+    int newest = NewestValidCopy(slot);
+    return newest < 0 ? 0 : slot.copies[newest].updatedAt;
+}
+
+bool SessionStore::Sync() {
+    return !base || ::msync(base, mappedBytes, MS_SYNC) == 0;
+}
+
+uint32_t SessionStore::GetSlotCount() const { return header->slotCount; }
+uint32_t SessionStore::GetUsedSlotCount() const { return header->usedSlots; }
+uint32_t SessionStore::GetLiveCount() const { return header->liveCount; }
+uint64_t SessionStore::GetNextSessionId() const { return header->nextSessionId; }
+
+bool SessionStore::CheckFreeList(std::string& error) const {
+    uint32_t used = header->usedSlots;
+    if (used > header->slotCount) { error = "more slots used than there are"; return false; }
+    uint32_t free = 0;
+    for (uint32_t index = header->freeHead; index != NO_SLOT; index = SlotAt(index).nextFree) {
+        if (index >= used) { error = "free list leaves the used slots"; return false; }
+        if (SlotAt(index).state != SLOT_FREE) { error = "live slot " + std::to_string(index) + " on the free list"; return false; }
+        if (++free > used) { error = "free list has a cycle"; return false; }
+    }
+    uint32_t live = 0;
+    for (uint32_t index = 0; index < used; ++index) if (SlotAt(index).state == SLOT_LIVE) live++;
+    if (live + free != used) { error = "a free slot is missing from the free list"; return false; }
+    if (live != header->liveCount) { error = "live count is " + std::to_string(header->liveCount) + ", found " + std::to_string(live); return false; }
+    return true;
+}
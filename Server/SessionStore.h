@@ -0,0 +1,99 @@
+// SessionStore.h
+#pragma once
+#include "GameSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Sessions in progress, kept in a memory-mapped file so that a host that dies (crash, kill, power
+// cut after the last Sync) can pick its games up again when it restarts. The file is a header and
+// a fixed number of fixed-size slots, one per session: its id, players' names and resume tokens,
+// and the game as a GameSnapshot (both fleets, hit masks, turn and seed). Nothing is parsed or
+// scanned when the file is opened: the header says where the free list starts and how many slots
+// were ever used, so opening costs the same with ten live sessions as with a million, and a
+// session is only read when a player comes back for it.
+//
+// Every change to the mapped bytes is ordered so that a process killed between any two stores
+// leaves the file recoverable in O(1) at the next Open:
+//   - Allocate and Release first copy the header fields they change into a pending-operation
+//     record; Open undoes an operation that was still pending, so the slot is exactly as it was.
+//   - Each slot holds two copies of its game, each with a write count and a checksum that covers
+//     the slot's generation. Write overwrites the older copy and finishes with the checksum, so a
+//     torn write leaves the previous copy as the newest valid one.
+// The mapping is shared, so the page cache keeps what a killed process wrote; Sync (msync) bounds
+// what a machine crash can lose. Integers are in host byte order; the file stays on its machine.
+//
+// One thread uses a store; a server gives each reactor thread its own file.
+class SessionStore {
+public:
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+    static constexpr size_t MAX_NAME_BYTES = 63; // Longer names are cut short
+    static constexpr uint32_t VS_COMPUTER = 1;   // StoredSession::flags
+
+    // A live slot, as Load reads it.
+    struct StoredSession {
+        uint64_t sessionId = 0;
+        uint32_t generation = 0;
+        uint32_t flags = 0;
+        uint64_t tokens[2] = { 0, 0 }; // What each seat's player must present to resume
+        std::string names[2];
+        unsigned int seq = 0;          // As passed to the Write that stored 'snapshot'
+        int64_t updatedAt = 0;         // Unix time of that Write
+        GameSnapshot snapshot;
+    };
+
+    SessionStore() = default;
+    ~SessionStore();
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // Maps 'path', creating it with 'slotCount' slots if it does not exist, or growing it to that
+    // many (an existing file never shrinks). Undoes an operation a previous process left pending.
+    bool Open(const std::string& path, uint32_t slotCount, std::string& error);
+    void Close();
+    bool IsOpen() const { return header != nullptr; }
+
+    // A free slot for a new session, now live; NO_SLOT when every slot is taken. The slot holds
+    // no game until the first Write.
+    uint32_t Allocate(uint64_t sessionId, const std::string names[2], const uint64_t tokens[2], uint32_t flags);
+    bool Write(uint32_t slot, const GameSnapshot& snapshot, unsigned int seq);
+    void Release(uint32_t slot);
+    // False if 'slot' is not live or holds no valid game yet.
+    bool Load(uint32_t slot, StoredSession& out) const;
+    bool IsLive(uint32_t slot) const;
+    uint32_t GetGeneration(uint32_t slot) const;
+    int64_t GetUpdatedAt(uint32_t slot) const;
+
+    bool Sync(); // Writes the dirty pages to disk (msync)
+
+    uint32_t GetSlotCount() const;
+    uint32_t GetUsedSlotCount() const; // Slots ever allocated; the rest have never been written
+    uint32_t GetLiveCount() const;
+    uint64_t GetNextSessionId() const; // Above every session id ever allocated in this file
+    bool WasRecovered() const { return recovered; } // Open undid a pending operation
+
+    // For crash-injection checks: called at every point where the file is consistent up to the
+    // next step, so a test can kill the process there.
+    void SetStepHook(void (*hook)()) { stepHook = hook; }
+    // For checks: whether the free list and the live slots together are exactly the used slots.
+    bool CheckFreeList(std::string& error) const;
+
+private:
+    struct Header;
+    struct Slot;
+    struct Copy;
+
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    Header* header = nullptr;
+    bool recovered = false;
+    void (*stepHook)() = nullptr;
+
+    Slot& SlotAt(uint32_t slot) const;
+    int NewestValidCopy(const Slot& slot) const; // -1 if neither
+    void Step();
+    void BeginOperation(uint32_t op, uint32_t slot);
+    void EndOperation();
+    void UndoPendingOperation();
+};
@@ -0,0 +1,46 @@
+// SharedBuffer.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+
+// Immutable bytes encoded once and queued on many connections (a session's spectators), freed when
+// the last connection holding them has written them. Every copy lives on one reactor thread, so
+// the reference count is a plain integer rather than shared_ptr's locked one, and the count and
+// the bytes share one allocation.
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+    SharedBuffer(const SharedBuffer& other) : block(other.block) { if (block) ++block->refs; }
+    SharedBuffer(SharedBuffer&& other) noexcept : block(other.block) { other.block = nullptr; }
+    SharedBuffer& operator=(SharedBuffer other) noexcept { std::swap(block, other.block); return *this; }
+    ~SharedBuffer() { if (block && --block->refs == 0) std::free(block); }
+
+    // 'line' and a '\n', as Reactor::Send frames it.
+    static SharedBuffer MakeLine(std::string_view line) {
+        SharedBuffer buffer;
+        buffer.block = static_cast<Block*>(std::malloc(sizeof(Block) + line.size() + 1));
+        if (!buffer.block) throw std::bad_alloc();
+        buffer.block->refs = 1;
+        buffer.block->size = line.size() + 1;
+        std::memcpy(buffer.block->Bytes(), line.data(), line.size());
+        buffer.block->Bytes()[line.size()] = '\n';
+        return buffer;
+    }
+
+    const char* GetData() const { return block ? block->Bytes() : nullptr; }
+    size_t GetSize() const { return block ? block->size : 0; }
+    bool IsEmpty() const { return !block; }
+
+private:
+    struct Block {
+        uint32_t refs;
+        size_t size;
+        char* Bytes() { return reinterpret_cast<char*>(this + 1); }
+    };
+    Block* block = nullptr;
+};
@@ -0,0 +1,243 @@
+// main.cpp (battleship-server)
+// Headless multi-session host. Runs one Reactor + SessionHost per thread (CoroutineHost with
+// --coroutines); existing WinForms clients connect with "Join Game" exactly as they would to a
+// Form1 host.
+#include "CoroutineHost.h"
+#include "Metrics.h"
+#include "Reactor.h"
+#include "SessionHost.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::atomic<bool> stopRequested{ false };
+
+    void OnSignal(int) { stopRequested.store(true); }
+
+    struct ServerOptions {
+        std::string address = "0.0.0.0";
+        int port = 12345;
+        int threads = 0; // 0 = one per core
+        int boardSize = BOARD_SIZE_CONST;
+        int statsIntervalSeconds = 5;
+        uint64_t seed = 0;
+        bool fixedSeed = false; // --seed given: thread i hosts games from mixSeed(seed, i)
+        bool logGames = false;
+        std::string journalPrefix; // --journal: thread i appends to <prefix>-<i>.bsj
+        int journalSyncMs = 200;
+        std::string storePrefix; // --session-store: thread i keeps its games in <prefix>-<i>.bss
+        int storeSlots = 16384;  // Per thread; 1 KiB each, allocated by the file system as they are used
+        int storeSyncMs = 200;
+        int metricsPort = 0;      // --metrics-port: Prometheus text at http://127.0.0.1:<port>/metrics
+        std::string metricsFile;  // --metrics-file: the same text, rewritten every metricsIntervalSeconds
+        int metricsIntervalSeconds = 10;
+        MatchmakerOptions matchmaking;
+        bool coroutines = false; // CoroutineHost instead of SessionHost
+        int turnTimeoutMs = 0;   // --coroutines only
+    };
+
+    void PrintUsage() {
+        std::printf("Usage: battleship-server [--address A] [--port P] [--threads N] [--board-size S] [--stats-interval SEC] [--seed S] [--log-games] [--journal PREFIX] [--journal-sync-ms MS] [--session-store PREFIX] [--session-store-slots N] [--session-store-sync-ms MS] [--metrics-port P] [--metrics-file PATH] [--metrics-interval SEC] [--rating-bucket WIDTH] [--widen-ms MS] [--computer-after-ms MS] [--coroutines [--turn-timeout-ms MS]]\n");
+    }
+
+    bool ParseOptions(int argc, char* argv[], ServerOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--address" && hasValue) options.address = argv[++i];
+            else if (arg == "--port" && hasValue) options.port = std::atoi(argv[++i]);
+            else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+            else if (arg == "--board-size" && hasValue) options.boardSize = std::atoi(argv[++i]);
+            else if (arg == "--stats-interval" && hasValue) options.statsIntervalSeconds = std::atoi(argv[++i]);
+            else if (arg == "--seed" && hasValue) { options.seed = std::strtoull(argv[++i], nullptr, 10); options.fixedSeed = true; }
+            else if (arg == "--log-games") options.logGames = true;
+            else if (arg == "--journal" && hasValue) options.journalPrefix = argv[++i];
+            else if (arg == "--journal-sync-ms" && hasValue) options.journalSyncMs = std::atoi(argv[++i]);
+            else if (arg == "--session-store" && hasValue) options.storePrefix = argv[++i];
+            else if (arg == "--session-store-slots" && hasValue) options.storeSlots = std::atoi(argv[++i]);
+            else if (arg == "--session-store-sync-ms" && hasValue) options.storeSyncMs = std::atoi(argv[++i]);
+            else if (arg == "--metrics-port" && hasValue) options.metricsPort = std::atoi(argv[++i]);
+            else if (arg == "--metrics-file" && hasValue) options.metricsFile = argv[++i];
+            else if (arg == "--metrics-interval" && hasValue) options.metricsIntervalSeconds = std::atoi(argv[++i]);
+            else if (arg == "--rating-bucket" && hasValue) options.matchmaking.bucketWidth = std::atoi(argv[++i]);
+            else if (arg == "--widen-ms" && hasValue) options.matchmaking.widenEvery = std::chrono::milliseconds(std::atoi(argv[++i]));
+            else if (arg == "--computer-after-ms" && hasValue) options.matchmaking.computerAfter = std::chrono::milliseconds(std::atoi(argv[++i]));
+            else if (arg == "--coroutines") options.coroutines = true;
+            else if (arg == "--turn-timeout-ms" && hasValue) options.turnTimeoutMs = std::atoi(argv[++i]);
+            else return false;
+        }
+        if (options.threads <= 0) options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        return options.port > 0 && options.port < 65536 && GameSession::IsSupportedBoardSize(options.boardSize) && options.journalSyncMs >= 0
+            && options.storeSlots > 0 && options.storeSyncMs >= 0
+            && options.metricsPort >= 0 && options.metricsPort < 65536 && options.metricsIntervalSeconds > 0
+            && options.matchmaking.bucketWidth >= 0 && options.matchmaking.widenEvery.count() >= 0 && options.matchmaking.computerAfter.count() >= 0
+            && options.turnTimeoutMs >= 0 && (options.coroutines || options.turnTimeoutMs == 0)
+            && (!options.coroutines || (options.journalPrefix.empty() && options.storePrefix.empty() && options.matchmaking.bucketWidth == 0 && options.matchmaking.computerAfter.count() == 0));
+    }
+
+    struct Worker {
+        std::unique_ptr<GameJournalWriter> journal; // Declared first so the host is gone before these close
+        std::unique_ptr<SessionStore> store;
+        std::unique_ptr<Reactor> reactor;
+        std::unique_ptr<SessionHost> host;          // One of these two
+        std::unique_ptr<CoroutineHost> coroutineHost;
+        std::thread thread;
+
+        const SessionHostStats& GetStats() const { return host ? host->GetStats() : coroutineHost->GetStats(); }
+    };
+
+    // Over the last completed stats interval, for the moves/s and games/s gauges.
+    struct ServerRates {
+        double movesPerSecond = 0.0;
+        double gamesPerSecond = 0.0;
+    };
+
+    // Every worker's counters as one Prometheus exposition, labelled by thread.
+    std::string BuildMetricsText(const std::vector<Worker>& workers, const ServerRates& rates) {
+        PrometheusText out;
+        std::vector<std::string> labels;
+        for (size_t i = 0; i < workers.size(); ++i) labels.push_back("thread=\"" + std::to_string(i) + "\"");
+        auto perThreadFamily = [&](const char* name, const char* type, const char* help, auto value) {
+            out.BeginFamily(name, type, help);
+            for (size_t i = 0; i < workers.size(); ++i) out.Sample(name, labels[i], static_cast<double>(value(workers[i])));
+        };
+        auto histogramFamily = [&](const char* name, const char* help, auto histogram) {
+            out.BeginFamily(name, "histogram", help);
+            for (size_t i = 0; i < workers.size(); ++i) out.Histogram(name, labels[i], histogram(workers[i]));
+        };
+        const auto relaxed = std::memory_order_relaxed;
+        perThreadFamily("battleship_moves_total", "counter", "Accepted moves.", [&](const Worker& w) { return w.GetStats().movesPlayed.load(relaxed); });
+        perThreadFamily("battleship_games_started_total", "counter", "Games started.", [&](const Worker& w) { return w.GetStats().gamesStarted.load(relaxed); });
+        perThreadFamily("battleship_games_finished_total", "counter", "Games ended, won or abandoned.", [&](const Worker& w) { return w.GetStats().gamesFinished.load(relaxed); });
+        perThreadFamily("battleship_connections_accepted_total", "counter", "Client connections accepted.", [&](const Worker& w) { return w.GetStats().connectionsAccepted.load(relaxed); });
+        perThreadFamily("battleship_lines_received_total", "counter", "Protocol lines received.", [&](const Worker& w) { return w.reactor->GetStats().linesReceived.load(relaxed); });
+        perThreadFamily("battleship_sent_bytes_total", "counter", "Bytes handed to the kernel.", [&](const Worker& w) { return w.reactor->GetStats().bytesSent.load(relaxed); });
+        perThreadFamily("battleship_computer_matches_total", "counter", "Players given a computer opponent after waiting too long.", [&](const Worker& w) { return w.GetStats().computerMatches.load(relaxed); });
+        perThreadFamily("battleship_spectator_messages_skipped_total", "counter", "Updates not sent to spectators that were behind.", [&](const Worker& w) { return w.GetStats().spectatorMessagesSkipped.load(relaxed); });
+        perThreadFamily("battleship_spectator_catch_ups_total", "counter", "Snapshots sent to spectators in place of the updates they skipped.", [&](const Worker& w) { return w.GetStats().spectatorCatchUps.load(relaxed); });
+        perThreadFamily("battleship_spectators_dropped_total", "counter", "Spectators closed for staying behind too long.", [&](const Worker& w) { return w.GetStats().spectatorsDropped.load(relaxed); });
+        perThreadFamily("battleship_sessions_restored_total", "counter", "Sessions brought back from the session store.", [&](const Worker& w) { return w.GetStats().sessionsRestored.load(relaxed); });
+        perThreadFamily("battleship_players_resumed_total", "counter", "Players put back in their seats by RESUME.", [&](const Worker& w) { return w.GetStats().playersResumed.load(relaxed); });
+        perThreadFamily("battleship_stored_sessions_expired_total", "counter", "Stored sessions of an earlier run released unresumed.", [&](const Worker& w) { return w.GetStats().storedSessionsExpired.load(relaxed); });
+        perThreadFamily("battleship_active_sessions", "gauge", "Sessions with two seated players.", [&](const Worker& w) { return w.GetStats().activeSessions.load(relaxed); });
+        perThreadFamily("battleship_waiting_players", "gauge", "Players waiting for an opponent.", [&](const Worker& w) { return w.GetStats().waitingPlayers.load(relaxed); });
+        perThreadFamily("battleship_spectators", "gauge", "Connections watching a session.", [&](const Worker& w) { return w.GetStats().spectators.load(relaxed); });
+        perThreadFamily("battleship_connections", "gauge", "Open client connections.", [&](const Worker& w) { return w.reactor->GetStats().connections.load(relaxed); });
+        perThreadFamily("battleship_send_queue_bytes", "gauge", "Output queued for clients and not yet sent.", [&](const Worker& w) { return w.reactor->GetStats().queuedBytes.load(relaxed); });
+        histogramFamily("battleship_attack_seconds", "MakeAttack latency, one in 32 calls sampled.", [&](const Worker& w) -> const LatencyHistogram& { return w.GetStats().attackLatency; });
+        histogramFamily("battleship_dispatch_seconds", "Parsing and handling one received line, its sends included; one in 32 sampled.", [&](const Worker& w) -> const LatencyHistogram& { return w.reactor->GetStats().dispatchLatency; });
+        histogramFamily("battleship_pairing_seconds", "CONNECT_REQUEST to WELCOME, every pairing.", [&](const Worker& w) -> const LatencyHistogram& { return w.GetStats().pairingLatency; });
+        histogramFamily("battleship_send_seconds", "Writing a connection's queued output to its socket; one in 32 sampled.", [&](const Worker& w) -> const LatencyHistogram& { return w.reactor->GetStats().sendLatency; });
+        out.BeginFamily("battleship_moves_per_second", "gauge", "Accepted moves per second over the last stats interval.");
+        out.Sample("battleship_moves_per_second", std::string(), rates.movesPerSecond);
+        out.BeginFamily("battleship_games_per_second", "gauge", "Finished games per second over the last stats interval.");
+        out.Sample("battleship_games_per_second", std::string(), rates.gamesPerSecond);
+        return out.GetText();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    if (!ParseOptions(argc, argv, options)) { PrintUsage(); return 2; }
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<Worker> workers(options.threads);
+    for (int i = 0; i < options.threads; ++i) {
+        workers[i].reactor = std::make_unique<Reactor>();
+        uint64_t seedBase = options.fixedSeed ? mixSeed(options.seed, static_cast<uint64_t>(i)) : makeGameSeed();
+        if (options.coroutines) {
+            workers[i].coroutineHost = std::make_unique<CoroutineHost>(*workers[i].reactor, options.boardSize, seedBase, options.logGames);
+            workers[i].coroutineHost->SetTurnTimeout(std::chrono::milliseconds(options.turnTimeoutMs));
+        }
+        else {
+            workers[i].host = std::make_unique<SessionHost>(*workers[i].reactor, options.boardSize, seedBase, options.logGames);
+            workers[i].host->SetMatchmaking(options.matchmaking);
+        }
+        std::string error;
+        if (!options.journalPrefix.empty()) {
+            workers[i].journal = std::make_unique<GameJournalWriter>();
+            if (!workers[i].journal->Open(options.journalPrefix + "-" + std::to_string(i) + ".bsj", error)) {
+                std::fprintf(stderr, "battleship-server: %s\n", error.c_str());
+                return 1;
+            }
+            workers[i].host->SetJournal(workers[i].journal.get(), options.journalSyncMs);
+        }
+        if (!options.storePrefix.empty()) {
+            workers[i].store = std::make_unique<SessionStore>();
+            if (!workers[i].store->Open(options.storePrefix + "-" + std::to_string(i) + ".bss", static_cast<uint32_t>(options.storeSlots), error)) {
+                std::fprintf(stderr, "battleship-server: %s\n", error.c_str());
+                return 1;
+            }
+            workers[i].host->SetSessionStore(workers[i].store.get(), options.storeSyncMs);
+        }
+        if (!workers[i].reactor->Listen(options.address, options.port, error)) {
+            std::fprintf(stderr, "battleship-server: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    for (auto& worker : workers) {
+        Reactor* reactor = worker.reactor.get();
+        worker.thread = std::thread([reactor]() { reactor->Run(); });
+    }
+    MetricsEndpoint endpoint;
+    if (options.metricsPort > 0) {
+        std::string error;
+        if (!endpoint.Listen(options.metricsPort, error)) {
+            std::fprintf(stderr, "battleship-server: %s\n", error.c_str());
+            for (auto& worker : workers) worker.reactor->Stop();
+            for (auto& worker : workers) worker.thread.join();
+            return 1;
+        }
+    }
+    if (endpoint.IsListening() || !options.metricsFile.empty()) MetricsTicksPerSecond(); // Calibrate now, not on the first scrape
+    std::printf("battleship-server: listening on %s:%d with %d thread(s), %dx%d boards\n",
+        options.address.c_str(), options.port, options.threads, options.boardSize, options.boardSize);
+    std::fflush(stdout);
+
+    auto lastReport = std::chrono::steady_clock::now();
+    auto lastMetricsDump = lastReport;
+    uint64_t lastMoves = 0, lastGames = 0;
+    ServerRates rates;
+    while (!stopRequested.load()) {
+        if (endpoint.IsListening()) endpoint.Serve(200, [&]() { return BuildMetricsText(workers, rates); });
+        else std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto now = std::chrono::steady_clock::now();
+        if (!options.metricsFile.empty() && now - lastMetricsDump >= std::chrono::seconds(options.metricsIntervalSeconds)) {
+            if (!WriteMetricsFile(options.metricsFile, BuildMetricsText(workers, rates)))
+                std::fprintf(stderr, "battleship-server: cannot write %s\n", options.metricsFile.c_str());
+            lastMetricsDump = now;
+        }
+        double elapsed = std::chrono::duration<double>(now - lastReport).count();
+        if (options.statsIntervalSeconds <= 0 || elapsed < options.statsIntervalSeconds) continue;
+        uint64_t moves = 0, games = 0; int64_t active = 0, waiting = 0;
+        std::vector<const LatencyHistogram*> pairing;
+        for (auto& worker : workers) {
+            const SessionHostStats& stats = worker.GetStats();
+            moves += stats.movesPlayed.load(std::memory_order_relaxed);
+            games += stats.gamesFinished.load(std::memory_order_relaxed);
+            active += stats.activeSessions.load(std::memory_order_relaxed);
+            waiting += stats.waitingPlayers.load(std::memory_order_relaxed);
+            pairing.push_back(&stats.pairingLatency);
+        }
+        rates.movesPerSecond = (moves - lastMoves) / elapsed;
+        rates.gamesPerSecond = (games - lastGames) / elapsed;
+        std::printf("sessions=%lld waiting=%lld moves/s=%.0f games/s=%.1f (moves/s per thread=%.0f) pairing p50<%.3gs p99<%.3gs\n",
+            static_cast<long long>(active), static_cast<long long>(waiting), rates.movesPerSecond, rates.gamesPerSecond, rates.movesPerSecond / options.threads,
+            LatencyQuantileSeconds(pairing, 0.5), LatencyQuantileSeconds(pairing, 0.99));
+        std::fflush(stdout);
+        lastMoves = moves; lastGames = games; lastReport = now;
+    }
+    for (auto& worker : workers) worker.reactor->Stop();
+    for (auto& worker : workers) worker.thread.join();
+    return 0;
+}
@@ -0,0 +1,104 @@
+// SelfPlay.cpp
+#include "SelfPlay.h"
+#include "WorkStealingPool.h"
+#include "BattleShipGame.h"
+
+void SelfPlayStats::Reset(int size) {
+    boardSize = size;
+    games = failedGames = player1Wins = totalShots = 0;
+    shotsToWin.assign(static_cast<size_t>(size) * size + 1, 0);
+    cellHits.assign(static_cast<size_t>(size) * size, 0);
+    cellShots.assign(static_cast<size_t>(size) * size, 0);
+}
+
+void SelfPlayStats::Merge(const SelfPlayStats& other) {
+    games += other.games;
+    failedGames += other.failedGames;
+    player1Wins += other.player1Wins;
+    totalShots += other.totalShots;
+    for (size_t i = 0; i < shotsToWin.size() && i < other.shotsToWin.size(); ++i) shotsToWin[i] += other.shotsToWin[i];
+    for (size_t i = 0; i < cellHits.size() && i < other.cellHits.size(); ++i) cellHits[i] += other.cellHits[i];
+    for (size_t i = 0; i < cellShots.size() && i < other.cellShots.size(); ++i) cellShots[i] += other.cellShots[i];
+}
+
+double HistogramMean(const std::vector<uint64_t>& histogram) {
+    uint64_t count = 0, sum = 0;
+    for (size_t value = 0; value < histogram.size(); ++value) { count += histogram[value]; sum += histogram[value] * value; }
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+}
+
+int HistogramPercentile(const std::vector<uint64_t>& histogram, double fraction) {
+    uint64_t count = 0;
+    for (uint64_t entries : histogram) count += entries;
+    if (count == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(count - 1));
+    uint64_t seen = 0;
+    for (size_t value = 0; value < histogram.size(); ++value) {
+        seen += histogram[value];
+        if (seen > target) return static_cast<int>(value);
+    }
+    return static_cast<int>(histogram.size()) - 1;
+}
+
+double SelfPlayStats::MeanShotsToWin() const {
+    return HistogramMean(shotsToWin);
+}
+
+int SelfPlayStats::ShotsToWinPercentile(double fraction) const {
+    return HistogramPercentile(shotsToWin, fraction);
+}
+
+namespace {
+    template <int N>
+    void AddBoard(const BasicPlayer<N>& player, SelfPlayStats& stats) {
+        typename BasicPlayer<N>::Board shots = player.getOwnShotMask();
+        const typename BasicPlayer<N>::Board& hits = player.getOwnHitMask();
+        for (int w = 0; w < BasicPlayer<N>::Board::WORDS; ++w) {
+            for (uint64_t bits = shots.words[w]; bits; bits &= bits - 1) stats.cellShots[w * 64 + countTrailingZeros64(bits)]++;
+            for (uint64_t bits = hits.words[w]; bits; bits &= bits - 1) stats.cellHits[w * 64 + countTrailingZeros64(bits)]++;
+        }
+    }
+
+    template <int N>
+    void PlayGames(const SelfPlayOptions& options, WorkStealingPool& pool, SelfPlayStats& result) {
+        std::vector<SelfPlayStats> perWorker(pool.GetThreadCount());
+        for (auto& stats : perWorker) stats.Reset(N);
+        std::vector<std::unique_ptr<BasicBattleshipGameLogic<N>>> games(pool.GetThreadCount());
+        for (auto& game : games) game = std::make_unique<BasicBattleshipGameLogic<N>>();
+
+        pool.ParallelFor(options.games, options.grain, [&](uint64_t begin, uint64_t end, int worker) {
+            SelfPlayStats& stats = perWorker[worker];
+            BasicBattleshipGameLogic<N>& logic = *games[worker];
+            for (uint64_t index = begin; index < end; ++index) {
+                logic.StartNewGame("Computer 1", "Computer 2", GameMode::COMPUTER_VS_COMPUTER, mixSeed(options.seed, index));
+                while (!logic.IsGameOver()) {
+                    if (!logic.MakeComputerMove().isAccepted()) break;
+                }
+                stats.games++;
+                if (!logic.IsGameOver()) { stats.failedGames++; continue; }
+                bool player1Won = logic.GetCurrentTurnState() == GameTurn::GAME_OVER_P1_WINS;
+                if (player1Won) stats.player1Wins++;
+                const BasicPlayer<N>& loser = player1Won ? *logic.GetPlayer2() : *logic.GetPlayer1();
+                const BasicPlayer<N>& winner = player1Won ? *logic.GetPlayer1() : *logic.GetPlayer2();
+                int winnerShots = loser.getOwnShotMask().count();
+                stats.shotsToWin[winnerShots]++;
+                stats.totalShots += static_cast<uint64_t>(winnerShots + winner.getOwnShotMask().count());
+                AddBoard(loser, stats);
+                AddBoard(winner, stats);
+            }
+        });
+
+        result.Reset(N);
+        for (const auto& stats : perWorker) result.Merge(stats);
+    }
+}
+
+bool RunSelfPlay(const SelfPlayOptions& options, WorkStealingPool& pool, SelfPlayStats& result, std::string& error) {
+    switch (options.boardSize) {
+    case 10: PlayGames<10>(options, pool, result); return true;
+    case 15: PlayGames<15>(options, pool, result); return true;
+    case 20: PlayGames<20>(options, pool, result); return true;
+    case 32: PlayGames<32>(options, pool, result); return true;
+    default: error = "Unsupported board size: " + std::to_string(options.boardSize); return false;
+    }
+}
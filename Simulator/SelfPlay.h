@@ -0,0 +1,39 @@
+// SelfPlay.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkStealingPool;
+
+struct SelfPlayOptions {
+    uint64_t games = 1000000;
+    uint64_t seed = 1;     // Game i is seeded with mixSeed(seed, i), so results do not depend on the thread count
+    int boardSize = 10;    // 10, 15, 20 or 32
+    uint64_t grain = 512;  // Games per scheduled chunk
+};
+
+// Mean and percentiles of a histogram indexed by value ([shots] -> games); 0 when it is empty.
+double HistogramMean(const std::vector<uint64_t>& histogram);
+int HistogramPercentile(const std::vector<uint64_t>& histogram, double fraction); // fraction in [0, 1]
+
+// Totals over all games; every field is a sum, so per-worker results merge in any order.
+struct SelfPlayStats {
+    int boardSize = 0;
+    uint64_t games = 0;
+    uint64_t failedGames = 0;           // A computer player could not move (should stay 0)
+    uint64_t player1Wins = 0;
+    uint64_t totalShots = 0;            // Both players
+    std::vector<uint64_t> shotsToWin;   // [shots fired by the winner] -> games
+    std::vector<uint64_t> cellHits;     // [r * N + c] -> ship hits landed on that cell, both boards
+    std::vector<uint64_t> cellShots;    // [r * N + c] -> shots fired at that cell, both boards
+
+    void Reset(int size);
+    void Merge(const SelfPlayStats& other);
+    double MeanShotsToWin() const;
+    int ShotsToWinPercentile(double fraction) const;
+};
+
+// Plays options.games computer-vs-computer BattleshipGameLogic games on the pool.
+// False (with 'error' set) for an unsupported board size.
+bool RunSelfPlay(const SelfPlayOptions& options, WorkStealingPool& pool, SelfPlayStats& result, std::string& error);
@@ -0,0 +1,160 @@
+// Tournament.cpp
+#include "Tournament.h"
+#include "SelfPlay.h"
+#include "WorkStealingPool.h"
+#include "BattleShipGame.h"
+#include <cmath>
+
+const TournamentEntrant* FindTournamentEntrant(const std::string& name) {
+    for (const auto& entrant : TOURNAMENT_ENTRANTS) {
+        if (name == entrant.name) return &entrant;
+    }
+    return nullptr;
+}
+
+void PairingStats::Reset(int boardSize) {
+    games = failedGames = firstMoverWins = 0;
+    for (int side = 0; side < 2; ++side) {
+        wins[side] = 0;
+        shotsToWin[side].assign(static_cast<size_t>(boardSize) * boardSize + 1, 0);
+    }
+}
+
+void PairingStats::Merge(const PairingStats& other) {
+    games += other.games;
+    failedGames += other.failedGames;
+    firstMoverWins += other.firstMoverWins;
+    for (int side = 0; side < 2; ++side) {
+        wins[side] += other.wins[side];
+        for (size_t i = 0; i < shotsToWin[side].size() && i < other.shotsToWin[side].size(); ++i) shotsToWin[side][i] += other.shotsToWin[side][i];
+    }
+}
+
+namespace {
+    const double ELO_MEAN = 1500.0;
+    const int RATING_ITERATIONS = 10000;
+
+    // Bradley-Terry strengths by the MM iteration, from the finished games of every pairing. Each
+    // pairing also counts one virtual drawn game (half a win each way), which keeps the fit finite
+    // when one side never wins. Converted to Elo points: 400 * log10(strength), shifted to ELO_MEAN.
+    void FitRatings(TournamentResult& result) {
+        size_t count = result.standings.size();
+        std::vector<double> strength(count, 1.0), next(count);
+        for (int iteration = 0; iteration < RATING_ITERATIONS; ++iteration) {
+            for (size_t i = 0; i < count; ++i) {
+                double wins = 0.0, weight = 0.0;
+                for (const PairingStats& pairing : result.pairings) {
+                    int side = pairing.entrants[0] == static_cast<int>(i) ? 0 : pairing.entrants[1] == static_cast<int>(i) ? 1 : -1;
+                    if (side < 0) continue;
+                    int opponent = pairing.entrants[1 - side];
+                    double played = static_cast<double>(pairing.wins[0] + pairing.wins[1]) + 1.0;
+                    wins += static_cast<double>(pairing.wins[side]) + 0.5;
+                    weight += played / (strength[i] + strength[opponent]);
+                }
+                next[i] = weight > 0.0 ? wins / weight : 1.0;
+            }
+            double logMean = 0.0, change = 0.0;
+            for (size_t i = 0; i < count; ++i) logMean += std::log(next[i]) / static_cast<double>(count);
+            for (size_t i = 0; i < count; ++i) {
+                double normalized = next[i] / std::exp(logMean);
+                change = std::fmax(change, std::fabs(std::log(normalized / strength[i])));
+                strength[i] = normalized;
+            }
+            if (change < 1e-12) break;
+        }
+        for (size_t i = 0; i < count; ++i) result.standings[i].elo = ELO_MEAN + 400.0 * std::log10(strength[i]);
+    }
+
+    template <int N>
+    void PlayPairings(const TournamentOptions& options, const std::vector<const TournamentEntrant*>& entrants, WorkStealingPool& pool, TournamentResult& result) {
+        std::vector<std::vector<PairingStats>> perWorker(pool.GetThreadCount(), result.pairings);
+        std::vector<std::unique_ptr<BasicBattleshipGameLogic<N>>> games(pool.GetThreadCount());
+        for (auto& game : games) game = std::make_unique<BasicBattleshipGameLogic<N>>();
+        std::vector<uint64_t> shots(pool.GetThreadCount(), 0);
+        uint64_t perPairing = options.gamesPerPairing;
+
+        pool.ParallelFor(perPairing * result.pairings.size(), options.grain, [&](uint64_t begin, uint64_t end, int worker) {
+            BasicBattleshipGameLogic<N>& logic = *games[worker];
+            for (uint64_t index = begin; index < end; ++index) {
+                uint64_t pairingIndex = index / perPairing, game = index % perPairing;
+                PairingStats& stats = perWorker[worker][pairingIndex];
+                int firstSide = static_cast<int>(game & 1); // Side in seat 1 (moves first)
+                const TournamentEntrant& first = *entrants[stats.entrants[firstSide]];
+                const TournamentEntrant& second = *entrants[stats.entrants[1 - firstSide]];
+                logic.SetComputerStrategy(1, first.strategy);
+                logic.SetComputerStrategy(2, second.strategy);
+                logic.StartNewGame(first.name, second.name, GameMode::COMPUTER_VS_COMPUTER, mixSeed(mixSeed(options.seed, pairingIndex), game / 2));
+                while (!logic.IsGameOver()) {
+                    if (!logic.MakeComputerMove().isAccepted()) break;
+                }
+                stats.games++;
+                if (!logic.IsGameOver()) { stats.failedGames++; continue; }
+                bool player1Won = logic.GetCurrentTurnState() == GameTurn::GAME_OVER_P1_WINS;
+                int winnerSide = player1Won ? firstSide : 1 - firstSide;
+                const BasicPlayer<N>& loser = player1Won ? *logic.GetPlayer2() : *logic.GetPlayer1();
+                const BasicPlayer<N>& winner = player1Won ? *logic.GetPlayer1() : *logic.GetPlayer2();
+                int winnerShots = loser.getOwnShotMask().count();
+                stats.wins[winnerSide]++;
+                if (player1Won) stats.firstMoverWins++;
+                stats.shotsToWin[winnerSide][winnerShots]++;
+                shots[worker] += static_cast<uint64_t>(winnerShots + winner.getOwnShotMask().count());
+            }
+        });
+
+        for (size_t p = 0; p < result.pairings.size(); ++p) {
+            for (const auto& worker : perWorker) result.pairings[p].Merge(worker[p]);
+        }
+        for (uint64_t workerShots : shots) result.totalShots += workerShots;
+    }
+}
+
+bool RunTournament(const TournamentOptions& options, WorkStealingPool& pool, TournamentResult& result, std::string& error) {
+    std::vector<const TournamentEntrant*> entrants;
+    for (const std::string& name : options.entrants) {
+        const TournamentEntrant* entrant = FindTournamentEntrant(name);
+        if (!entrant) { error = "Unknown strategy: " + name; return false; }
+        for (const TournamentEntrant* other : entrants) {
+            if (other == entrant) { error = "Strategy entered twice: " + name; return false; }
+        }
+        entrants.push_back(entrant);
+    }
+    if (entrants.size() < 2) { error = "A tournament needs at least two strategies"; return false; }
+    int n = options.boardSize;
+    if (n != 10 && n != 15 && n != 20 && n != 32) { error = "Unsupported board size: " + std::to_string(n); return false; }
+
+    result = TournamentResult();
+    result.boardSize = n;
+    for (size_t a = 0; a < entrants.size(); ++a) {
+        for (size_t b = a + 1; b < entrants.size(); ++b) {
+            PairingStats pairing;
+            pairing.entrants[0] = static_cast<int>(a);
+            pairing.entrants[1] = static_cast<int>(b);
+            pairing.Reset(n);
+            result.pairings.push_back(pairing);
+        }
+    }
+    switch (n) {
+    case 10: PlayPairings<10>(options, entrants, pool, result); break;
+    case 15: PlayPairings<15>(options, entrants, pool, result); break;
+    case 20: PlayPairings<20>(options, entrants, pool, result); break;
+    default: PlayPairings<32>(options, entrants, pool, result); break;
+    }
+
+    result.standings.resize(entrants.size());
+    for (size_t i = 0; i < entrants.size(); ++i) {
+        result.standings[i].name = entrants[i]->name;
+        result.standings[i].shotsToWin.assign(static_cast<size_t>(n) * n + 1, 0);
+    }
+    for (const PairingStats& pairing : result.pairings) {
+        result.games += pairing.games;
+        result.failedGames += pairing.failedGames;
+        for (int side = 0; side < 2; ++side) {
+            EntrantStanding& standing = result.standings[pairing.entrants[side]];
+            standing.games += pairing.games - pairing.failedGames;
+            standing.wins += pairing.wins[side];
+            for (size_t shots = 0; shots < standing.shotsToWin.size(); ++shots) standing.shotsToWin[shots] += pairing.shotsToWin[side][shots];
+        }
+    }
+    FitRatings(result);
+    return true;
+}
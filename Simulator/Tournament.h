@@ -0,0 +1,70 @@
+// Tournament.h
+#pragma once
+#include "ComputerPlayer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkStealingPool;
+
+// A computer strategy that can be entered in a tournament, under its command-line name.
+struct TournamentEntrant {
+    const char* name;
+    ComputerStrategy strategy;
+    const char* description;
+};
+
+// Every strategy the runner knows; a new ComputerStrategy only has to be listed here to play.
+const TournamentEntrant TOURNAMENT_ENTRANTS[] = {
+    {"density", ComputerStrategy::PROBABILITY_DENSITY, "fires where the most remaining ship placements overlap"},
+    {"random", ComputerStrategy::RANDOM, "fires at a uniformly chosen untried cell"},
+    {"endgame", ComputerStrategy::ENDGAME_SOLVER, "density, then an exact expected-shots search once two ships remain"}
+};
+const int TOURNAMENT_ENTRANT_COUNT = sizeof(TOURNAMENT_ENTRANTS) / sizeof(TOURNAMENT_ENTRANTS[0]);
+const TournamentEntrant* FindTournamentEntrant(const std::string& name); // nullptr if unknown
+
+struct TournamentOptions {
+    std::vector<std::string> entrants; // Names from TOURNAMENT_ENTRANTS, each at most once; at least two
+    uint64_t gamesPerPairing = 10000;
+    uint64_t seed = 1;
+    int boardSize = 10; // 10, 15, 20 or 32
+    uint64_t grain = 512;
+};
+
+// One pairing of the round robin. Games 2k and 2k + 1 share the seed mixSeed(mixSeed(seed, pairing
+// index), k) with the seats swapped, so each side plays the same fleets from both seats and the
+// first-move advantage cancels out. Sums only, so per-worker results merge in any order.
+struct PairingStats {
+    int entrants[2] = { 0, 0 };  // Indices into TournamentOptions::entrants
+    uint64_t games = 0;
+    uint64_t failedGames = 0;     // A computer player could not move (should stay 0)
+    uint64_t wins[2] = { 0, 0 };
+    uint64_t firstMoverWins = 0;
+    std::vector<uint64_t> shotsToWin[2]; // Per side: [shots it fired in a game it won] -> games
+
+    void Reset(int boardSize);
+    void Merge(const PairingStats& other);
+};
+
+// One entrant's results over all of its pairings.
+struct EntrantStanding {
+    std::string name;
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    std::vector<uint64_t> shotsToWin;
+    double elo = 0.0; // Bradley-Terry fit of all pairings, scaled to Elo points with a mean of 1500
+};
+
+struct TournamentResult {
+    int boardSize = 0;
+    std::vector<PairingStats> pairings;     // (0, 1), (0, 2), ..., (1, 2), ...
+    std::vector<EntrantStanding> standings; // In TournamentOptions::entrants order
+    uint64_t games = 0;
+    uint64_t failedGames = 0;
+    uint64_t totalShots = 0; // Both players
+};
+
+// Plays every pairing of options.entrants on the pool. Results depend only on the options, not on
+// the thread count. False (with 'error' set) for an unknown or repeated entrant, fewer than two
+// entrants or an unsupported board size.
+bool RunTournament(const TournamentOptions& options, WorkStealingPool& pool, TournamentResult& result, std::string& error);
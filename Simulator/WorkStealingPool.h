@@ -0,0 +1,86 @@
+// WorkStealingPool.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs an index range on a fixed number of worker threads. The range is cut into chunks and
+// every worker starts with a contiguous share of them in its own deque; it takes work from the
+// back of its deque and, once that is empty, steals from the front of another worker's deque.
+// Uneven chunks (long games, slow cores) are rebalanced without a shared queue on the hot path.
+class WorkStealingPool {
+public:
+    // body(begin, end, worker) processes indices [begin, end); 'worker' is in [0, GetThreadCount()).
+    typedef std::function<void(uint64_t begin, uint64_t end, int worker)> RangeBody;
+
+    explicit WorkStealingPool(int threads) : threadCount(std::max(1, threads)) {}
+
+    int GetThreadCount() const { return threadCount; }
+
+    // Blocks until every index in [0, count) has been processed. The calling thread is worker 0.
+    void ParallelFor(uint64_t count, uint64_t grain, const RangeBody& body) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        for (int w = 0; w < threadCount; ++w) queues.push_back(std::make_unique<WorkerQueue>());
+        uint64_t chunks = (count + grain - 1) / grain;
+        for (uint64_t chunk = 0; chunk < chunks; ++chunk) {
+            int owner = static_cast<int>(chunk * static_cast<uint64_t>(threadCount) / chunks);
+            uint64_t begin = chunk * grain;
+            queues[owner]->ranges.push_back({ begin, std::min(count, begin + grain) });
+        }
+        std::atomic<uint64_t> remaining{ chunks };
+
+        auto work = [&](int self) {
+            Range range;
+            while (remaining.load(std::memory_order_acquire) > 0) {
+                if (!PopOwn(*queues[self], range) && !Steal(queues, self, range)) {
+                    std::this_thread::yield(); // Everything left is already running elsewhere
+                    continue;
+                }
+                body(range.begin, range.end, self);
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        };
+        std::vector<std::thread> helpers;
+        for (int w = 1; w < threadCount; ++w) helpers.emplace_back(work, w);
+        work(0);
+        for (auto& helper : helpers) helper.join();
+    }
+
+private:
+    struct Range { uint64_t begin; uint64_t end; };
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<Range> ranges;
+    };
+
+    int threadCount;
+
+    static bool PopOwn(WorkerQueue& queue, Range& out) {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.ranges.empty()) return false;
+        out = queue.ranges.back();
+        queue.ranges.pop_back();
+        return true;
+    }
+
+    static bool Steal(std::vector<std::unique_ptr<WorkerQueue>>& queues, int self, Range& out) {
+        int n = static_cast<int>(queues.size());
+        for (int i = 1; i < n; ++i) {
+            WorkerQueue& victim = *queues[(self + i) % n];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.ranges.empty()) continue;
+            out = victim.ranges.front(); // Oldest chunk: farthest from what the victim is working on
+            victim.ranges.pop_front();
+            return true;
+        }
+        return false;
+    }
+};
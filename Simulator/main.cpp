@@ -0,0 +1,235 @@
+// main.cpp (battleship-sim)
+// Headless computer-vs-computer self-play: plays many BattleshipGameLogic games across all cores
+// and reports shots-to-win, per-cell hit frequencies and throughput. With --tournament it plays a
+// round robin between computer strategies instead and reports win rates, shots-to-win and Elo
+// ratings. Results depend only on --seed, --games and --board-size, not on the thread count.
+#include "SelfPlay.h"
+#include "Tournament.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+    struct SimOptions {
+        SelfPlayOptions selfPlay;
+        TournamentOptions tournament;
+        bool runTournament = false;
+        bool gamesGiven = false;
+        int threads = 0; // 0: one per hardware thread
+        std::string jsonPath;
+        std::string csvPath; // Tournament only
+        bool showHistogram = false;
+    };
+
+    std::vector<std::string> SplitList(const std::string& list) {
+        std::vector<std::string> items;
+        size_t begin = 0;
+        while (begin <= list.size()) {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos) end = list.size();
+            if (end > begin) items.push_back(list.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        return items;
+    }
+
+    bool ParseOptions(int argc, char* argv[], SimOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--games" && hasValue) { options.selfPlay.games = std::strtoull(argv[++i], nullptr, 10); options.gamesGiven = true; }
+            else if (arg == "--seed" && hasValue) options.selfPlay.seed = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--board-size" && hasValue) options.selfPlay.boardSize = std::atoi(argv[++i]);
+            else if (arg == "--grain" && hasValue) options.selfPlay.grain = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+            else if (arg == "--json" && hasValue) options.jsonPath = argv[++i];
+            else if (arg == "--histogram") options.showHistogram = true;
+            else if (arg == "--tournament" && hasValue) { options.tournament.entrants = SplitList(argv[++i]); options.runTournament = true; }
+            else if (arg == "--csv" && hasValue) options.csvPath = argv[++i];
+            else return false;
+        }
+        // In a tournament --games counts the games of each pairing.
+        options.tournament.seed = options.selfPlay.seed;
+        options.tournament.boardSize = options.selfPlay.boardSize;
+        options.tournament.grain = options.selfPlay.grain;
+        if (options.gamesGiven) options.tournament.gamesPerPairing = options.selfPlay.games;
+        return options.selfPlay.games > 0 && options.threads >= 0 && (options.runTournament || options.csvPath.empty());
+    }
+
+    void PrintReport(const SelfPlayStats& stats, double seconds, int threads, const SimOptions& options) {
+        int n = stats.boardSize;
+        std::printf("games=%llu board=%dx%d threads=%d seed=%llu\n", static_cast<unsigned long long>(stats.games), n, n, threads,
+            static_cast<unsigned long long>(options.selfPlay.seed));
+        std::printf("elapsed=%.2fs games/s=%.0f shots/s=%.0f failed=%llu\n", seconds, stats.games / seconds, stats.totalShots / seconds,
+            static_cast<unsigned long long>(stats.failedGames));
+        std::printf("player 1 wins: %.2f%%\n", stats.games ? 100.0 * stats.player1Wins / stats.games : 0.0);
+        std::printf("shots to win: mean=%.2f min=%d p10=%d p50=%d p90=%d p99=%d max=%d\n", stats.MeanShotsToWin(),
+            stats.ShotsToWinPercentile(0.0), stats.ShotsToWinPercentile(0.10), stats.ShotsToWinPercentile(0.50),
+            stats.ShotsToWinPercentile(0.90), stats.ShotsToWinPercentile(0.99), stats.ShotsToWinPercentile(1.0));
+        if (options.showHistogram) {
+            for (size_t shots = 0; shots < stats.shotsToWin.size(); ++shots) {
+                if (stats.shotsToWin[shots]) std::printf("  %4zu %12llu\n", shots, static_cast<unsigned long long>(stats.shotsToWin[shots]));
+            }
+        }
+        if (n > 20 || stats.games == 0) return;
+        std::printf("hit frequency per cell (%% of boards on which the cell was a hit ship cell):\n");
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < n; ++c) std::printf("%5.1f", 100.0 * stats.cellHits[r * n + c] / (2.0 * stats.games));
+            std::printf("\n");
+        }
+    }
+
+    void WriteArray(std::FILE* out, const std::vector<uint64_t>& values) {
+        std::fputc('[', out);
+        for (size_t i = 0; i < values.size(); ++i) std::fprintf(out, "%s%llu", i ? "," : "", static_cast<unsigned long long>(values[i]));
+        std::fputc(']', out);
+    }
+
+    bool WriteJson(const std::string& path, const SelfPlayStats& stats, double seconds, int threads, const SimOptions& options) {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) return false;
+        std::fprintf(out, "{\"games\":%llu,\"boardSize\":%d,\"seed\":%llu,\"threads\":%d,\"seconds\":%.3f,\"gamesPerSecond\":%.1f,",
+            static_cast<unsigned long long>(stats.games), stats.boardSize, static_cast<unsigned long long>(options.selfPlay.seed),
+            threads, seconds, stats.games / seconds);
+        std::fprintf(out, "\"failedGames\":%llu,\"player1Wins\":%llu,\"totalShots\":%llu,\"meanShotsToWin\":%.4f,\"shotsToWin\":",
+            static_cast<unsigned long long>(stats.failedGames), static_cast<unsigned long long>(stats.player1Wins),
+            static_cast<unsigned long long>(stats.totalShots), stats.MeanShotsToWin());
+        WriteArray(out, stats.shotsToWin);
+        std::fputs(",\"cellHits\":", out);
+        WriteArray(out, stats.cellHits);
+        std::fputs(",\"cellShots\":", out);
+        WriteArray(out, stats.cellShots);
+        std::fputs("}\n", out);
+        return std::fclose(out) == 0;
+    }
+
+    double WinRate(uint64_t wins, uint64_t games) {
+        return games ? static_cast<double>(wins) / static_cast<double>(games) : 0.0;
+    }
+
+    void PrintTournament(const TournamentResult& result, double seconds, int threads, const SimOptions& options) {
+        int n = result.boardSize;
+        std::printf("tournament: %zu strategies, %zu pairings x %llu games, board=%dx%d threads=%d seed=%llu\n",
+            result.standings.size(), result.pairings.size(), static_cast<unsigned long long>(options.tournament.gamesPerPairing),
+            n, n, threads, static_cast<unsigned long long>(options.tournament.seed));
+        std::printf("elapsed=%.2fs games/s=%.0f shots/s=%.0f failed=%llu\n", seconds, result.games / seconds, result.totalShots / seconds,
+            static_cast<unsigned long long>(result.failedGames));
+        std::printf("%-10s %8s %10s %9s %9s %5s %5s %5s %5s\n", "strategy", "elo", "games", "win rate", "mean win", "p10", "p50", "p90", "p99");
+        for (const EntrantStanding& standing : result.standings) {
+            std::printf("%-10s %8.1f %10llu %8.2f%% %9.2f %5d %5d %5d %5d\n", standing.name.c_str(), standing.elo,
+                static_cast<unsigned long long>(standing.games), 100.0 * WinRate(standing.wins, standing.games), HistogramMean(standing.shotsToWin),
+                HistogramPercentile(standing.shotsToWin, 0.10), HistogramPercentile(standing.shotsToWin, 0.50),
+                HistogramPercentile(standing.shotsToWin, 0.90), HistogramPercentile(standing.shotsToWin, 0.99));
+        }
+        for (const PairingStats& pairing : result.pairings) {
+            uint64_t finished = pairing.games - pairing.failedGames;
+            std::printf("  %s vs %s: %.2f%% - %.2f%% (first mover wins %.2f%%)\n", result.standings[pairing.entrants[0]].name.c_str(),
+                result.standings[pairing.entrants[1]].name.c_str(), 100.0 * WinRate(pairing.wins[0], finished),
+                100.0 * WinRate(pairing.wins[1], finished), 100.0 * WinRate(pairing.firstMoverWins, finished));
+        }
+    }
+
+    // One row per strategy and opponent, plus an "all" row per strategy with its overall results.
+    bool WriteTournamentCsv(const std::string& path, const TournamentResult& result) {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) return false;
+        std::fputs("strategy,opponent,games,wins,win_rate,mean_shots_to_win,p10,p50,p90,p99,elo\n", out);
+        auto writeRow = [&](const EntrantStanding& standing, const char* opponent, uint64_t games, uint64_t wins, const std::vector<uint64_t>& shotsToWin) {
+            std::fprintf(out, "%s,%s,%llu,%llu,%.6f,%.4f,%d,%d,%d,%d,%.2f\n", standing.name.c_str(), opponent,
+                static_cast<unsigned long long>(games), static_cast<unsigned long long>(wins), WinRate(wins, games), HistogramMean(shotsToWin),
+                HistogramPercentile(shotsToWin, 0.10), HistogramPercentile(shotsToWin, 0.50), HistogramPercentile(shotsToWin, 0.90),
+                HistogramPercentile(shotsToWin, 0.99), standing.elo);
+        };
+        for (size_t i = 0; i < result.standings.size(); ++i) {
+            const EntrantStanding& standing = result.standings[i];
+            for (const PairingStats& pairing : result.pairings) {
+                for (int side = 0; side < 2; ++side) {
+                    if (pairing.entrants[side] != static_cast<int>(i)) continue;
+                    writeRow(standing, result.standings[pairing.entrants[1 - side]].name.c_str(), pairing.games - pairing.failedGames,
+                        pairing.wins[side], pairing.shotsToWin[side]);
+                }
+            }
+            writeRow(standing, "all", standing.games, standing.wins, standing.shotsToWin);
+        }
+        return std::fclose(out) == 0;
+    }
+
+    bool WriteTournamentJson(const std::string& path, const TournamentResult& result, double seconds, int threads, const SimOptions& options) {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) return false;
+        std::fprintf(out, "{\"boardSize\":%d,\"seed\":%llu,\"gamesPerPairing\":%llu,\"threads\":%d,\"seconds\":%.3f,\"gamesPerSecond\":%.1f,",
+            result.boardSize, static_cast<unsigned long long>(options.tournament.seed),
+            static_cast<unsigned long long>(options.tournament.gamesPerPairing), threads, seconds, result.games / seconds);
+        std::fprintf(out, "\"games\":%llu,\"failedGames\":%llu,\"totalShots\":%llu,\"strategies\":[",
+            static_cast<unsigned long long>(result.games), static_cast<unsigned long long>(result.failedGames),
+            static_cast<unsigned long long>(result.totalShots));
+        for (size_t i = 0; i < result.standings.size(); ++i) {
+            const EntrantStanding& standing = result.standings[i];
+            std::fprintf(out, "%s{\"name\":\"%s\",\"elo\":%.2f,\"games\":%llu,\"wins\":%llu,\"winRate\":%.6f,\"meanShotsToWin\":%.4f,",
+                i ? "," : "", standing.name.c_str(), standing.elo, static_cast<unsigned long long>(standing.games),
+                static_cast<unsigned long long>(standing.wins), WinRate(standing.wins, standing.games), HistogramMean(standing.shotsToWin));
+            std::fprintf(out, "\"p10\":%d,\"p50\":%d,\"p90\":%d,\"p99\":%d,\"shotsToWin\":", HistogramPercentile(standing.shotsToWin, 0.10),
+                HistogramPercentile(standing.shotsToWin, 0.50), HistogramPercentile(standing.shotsToWin, 0.90), HistogramPercentile(standing.shotsToWin, 0.99));
+            WriteArray(out, standing.shotsToWin);
+            std::fputc('}', out);
+        }
+        std::fputs("],\"pairings\":[", out);
+        for (size_t p = 0; p < result.pairings.size(); ++p) {
+            const PairingStats& pairing = result.pairings[p];
+            std::fprintf(out, "%s{\"strategies\":[\"%s\",\"%s\"],\"games\":%llu,\"failedGames\":%llu,\"wins\":[%llu,%llu],\"firstMoverWins\":%llu,",
+                p ? "," : "", result.standings[pairing.entrants[0]].name.c_str(), result.standings[pairing.entrants[1]].name.c_str(),
+                static_cast<unsigned long long>(pairing.games), static_cast<unsigned long long>(pairing.failedGames),
+                static_cast<unsigned long long>(pairing.wins[0]), static_cast<unsigned long long>(pairing.wins[1]),
+                static_cast<unsigned long long>(pairing.firstMoverWins));
+            std::fprintf(out, "\"meanShotsToWin\":[%.4f,%.4f]}", HistogramMean(pairing.shotsToWin[0]), HistogramMean(pairing.shotsToWin[1]));
+        }
+        std::fputs("]}\n", out);
+        return std::fclose(out) == 0;
+    }
+
+    int RunTournamentMode(const SimOptions& options, WorkStealingPool& pool) {
+        TournamentResult result;
+        std::string error;
+        auto begin = std::chrono::steady_clock::now();
+        if (!RunTournament(options.tournament, pool, result, error)) { std::fprintf(stderr, "battleship-sim: %s\n", error.c_str()); return 2; }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        PrintTournament(result, seconds, pool.GetThreadCount(), options);
+        if (!options.jsonPath.empty() && !WriteTournamentJson(options.jsonPath, result, seconds, pool.GetThreadCount(), options)) {
+            std::fprintf(stderr, "battleship-sim: cannot write %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        if (!options.csvPath.empty() && !WriteTournamentCsv(options.csvPath, result)) {
+            std::fprintf(stderr, "battleship-sim: cannot write %s\n", options.csvPath.c_str());
+            return 1;
+        }
+        return result.failedGames == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SimOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::printf("Usage: battleship-sim [--games N] [--seed S] [--board-size 10|15|20|32] [--threads T] [--grain G] [--json FILE] [--histogram]\n");
+        std::printf("       battleship-sim --tournament STRATEGY,STRATEGY[,...] [--games PER_PAIRING] [--seed S] [--board-size N] [--threads T] [--json FILE] [--csv FILE]\n");
+        std::printf("Strategies:\n");
+        for (const auto& entrant : TOURNAMENT_ENTRANTS) std::printf("  %-10s %s\n", entrant.name, entrant.description);
+        return 2;
+    }
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    WorkStealingPool pool(threads);
+    if (options.runTournament) return RunTournamentMode(options, pool);
+    SelfPlayStats stats;
+    std::string error;
+    auto begin = std::chrono::steady_clock::now();
+    if (!RunSelfPlay(options.selfPlay, pool, stats, error)) { std::fprintf(stderr, "battleship-sim: %s\n", error.c_str()); return 2; }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    PrintReport(stats, seconds, pool.GetThreadCount(), options);
+    if (!options.jsonPath.empty() && !WriteJson(options.jsonPath, stats, seconds, pool.GetThreadCount(), options)) {
+        std::fprintf(stderr, "battleship-sim: cannot write %s\n", options.jsonPath.c_str());
+        return 1;
+    }
+    return stats.failedGames == 0 ? 0 : 1;
+}